@@ -9,6 +9,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMimeDatabase>
 
 #include <archive.h>
 #include <archive_entry.h>
@@ -572,6 +573,115 @@ ArchiveContents readArchive(const QString& archivePath)
     return result;
 }
 
+bool scanArchive(const QString& archivePath,
+                 const std::function<bool(const ArchiveEntry& entry, const ArchiveDataReader& read)>& visit)
+{
+    struct archive* a = archive_read_new();
+    archive_read_support_filter_all(a);
+    archive_read_support_format_all(a);
+
+    const QByteArray pathBytes = QFile::encodeName(archivePath);
+    if (archive_read_open_filename(a, pathBytes.constData(), 64 * 1024) != ARCHIVE_OK) {
+        archive_read_free(a);
+        return false;
+    }
+
+    const ArchiveDataReader read = [a](char* buffer, qint64 maxSize) -> qint64 {
+        const la_ssize_t n = archive_read_data(a, buffer, static_cast<size_t>(maxSize));
+        return n < 0 ? -1 : static_cast<qint64>(n);
+    };
+
+    bool ok = true;
+    struct archive_entry* entry;
+    for (;;) {
+        const int status = archive_read_next_header(a, &entry);
+        if (status == ARCHIVE_EOF)
+            break;
+        if (status != ARCHIVE_OK && status != ARCHIVE_WARN) {
+            ok = false;
+            break;
+        }
+
+        ArchiveEntry e;
+        e.path = QString::fromUtf8(archive_entry_pathname(entry));
+        while (e.path.endsWith('/'))
+            e.path.chop(1);
+        e.name = e.path.mid(e.path.lastIndexOf('/') + 1);
+        e.isDirectory = (archive_entry_filetype(entry) == AE_IFDIR);
+        e.size = archive_entry_size(entry);
+        e.modTime = QDateTime::fromSecsSinceEpoch(archive_entry_mtime(entry));
+
+        if (!e.path.isEmpty() && !visit(e, read))
+            break;
+        archive_read_data_skip(a);
+    }
+
+    archive_read_free(a);
+    return ok;
+}
+
+namespace {
+
+// Compressors of one stream, as named by classifyArchive() - unlike zip,
+// rar or 7z, which also hold members
+bool isSingleStream(const QVarLengthArray<QString, 2>& components)
+{
+    static const QStringList singleStream = {
+        "gz", "gzip", "bz2", "bzip2", "bz3", "bzip3", "xz", "zstd", "lz4", "lzma", "lz", "lzip", "zlib"
+    };
+    return components.size() == 1 && singleStream.contains(components[0]);
+}
+
+} // anonymous namespace
+
+bool isSearchableArchive(const QString& fileName)
+{
+    static const QMimeDatabase mimeDb;
+    const QMimeType mt = mimeDb.mimeTypeForFile(fileName, QMimeDatabase::MatchExtension);
+    const auto [components, type] = classifyArchive(mt, fileName);
+    if (type == DetailedArchiveType::Compressed)
+        return !isSingleStream(components);
+    return type == DetailedArchiveType::Archive || type == DetailedArchiveType::CompressedArchive ||
+           type == DetailedArchiveType::ArchiveOther;
+}
+
+bool isCompressedFile(const QString& fileName)
+{
+    static const QMimeDatabase mimeDb;
+    const QMimeType mt = mimeDb.mimeTypeForFile(fileName, QMimeDatabase::MatchExtension);
+    const auto [components, type] = classifyArchive(mt, fileName);
+    return type == DetailedArchiveType::Compressed && isSingleStream(components);
+}
+
+bool readCompressedFile(const QString& filePath, const std::function<void(const ArchiveDataReader& read)>& consume)
+{
+    // The raw format: the decompressed stream is the one and only "member"
+    struct archive* a = archive_read_new();
+    archive_read_support_filter_all(a);
+    archive_read_support_format_raw(a);
+
+    const QByteArray pathBytes = QFile::encodeName(filePath);
+    if (archive_read_open_filename(a, pathBytes.constData(), 64 * 1024) != ARCHIVE_OK) {
+        archive_read_free(a);
+        return false;
+    }
+
+    struct archive_entry* entry;
+    const int status = archive_read_next_header(a, &entry);
+    if (status != ARCHIVE_OK && status != ARCHIVE_WARN) {
+        archive_read_free(a);
+        return false;
+    }
+
+    consume([a](char* buffer, qint64 maxSize) -> qint64 {
+        const la_ssize_t n = archive_read_data(a, buffer, static_cast<size_t>(maxSize));
+        return n < 0 ? -1 : static_cast<qint64>(n);
+    });
+
+    archive_read_free(a);
+    return true;
+}
+
 bool archiveHasSingleRoot(const ArchiveContents& contents)
 {
     if (contents.allEntries.isEmpty())
@@ -9,6 +9,8 @@
 #include <QMimeType>
 #include <QPair>
 
+#include <functional>
+
 enum class ArchiveType {
     Empty,              // Not an archive/compression
     Compressed,         // Compression only (gz, xz, bz2)
@@ -73,6 +75,34 @@ struct ArchiveContents {
 // Read archive contents using libarchive, fallback to unar
 ArchiveContents readArchive(const QString& archivePath);
 
+// Reads the data of the member being visited by scanArchive(), sequentially
+// and decompressed on the fly. Returns the number of bytes read, 0 at the
+// end of the member, -1 on error.
+using ArchiveDataReader = std::function<qint64(char* buffer, qint64 maxSize)>;
+
+// Read an archive once, front to back, with libarchive: `visit` is called
+// for every member in storage order and may read its data through the
+// reader - nothing is extracted to disk. Data not read is skipped. The
+// visitor returns false to stop early. Returns false if the archive cannot
+// be opened or is damaged before its end.
+bool scanArchive(const QString& archivePath,
+                 const std::function<bool(const ArchiveEntry& entry, const ArchiveDataReader& read)>& visit);
+
+// True for the kinds of file the panel enters as archives (zip, tar.gz, 7z,
+// iso, ...), judged by the name alone so no file needs to be opened.
+// Compressed single files are not among them, see isCompressedFile().
+bool isSearchableArchive(const QString& fileName);
+
+// True for a single compressed stream without members (.gz, .bz2, .xz,
+// .zst, .lz4, ...), judged by the name alone.
+bool isCompressedFile(const QString& fileName);
+
+// Decompress a single compressed file on the fly with libarchive and hand
+// `consume` a reader for its data - nothing is written to disk, and data not
+// read is never decompressed. Returns false if the file cannot be opened or
+// is not in a format libarchive can decompress.
+bool readCompressedFile(const QString& filePath, const std::function<void(const ArchiveDataReader& read)>& consume);
+
 // Pack files into 7z archive
 // Returns empty string on success, error message on failure
 QString pack7z(const QString& archivePath, const QStringList& files,
@@ -0,0 +1,153 @@
+#include "ChunkPipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+
+ChunkPipeline::ChunkPipeline(const Options& options)
+    : m_options(options)
+{
+    m_options.chunks = std::max<std::size_t>(2, m_options.chunks);
+    m_options.alignment = std::max<std::size_t>(alignof(std::max_align_t), m_options.alignment);
+    // aligned_alloc() wants a multiple of the alignment
+    m_options.chunkSize = (std::max<std::size_t>(1, m_options.chunkSize) + m_options.alignment - 1) /
+                          m_options.alignment * m_options.alignment;
+
+    for (std::size_t i = 0; i < m_options.chunks; ++i) {
+        char* buffer = static_cast<char*>(std::aligned_alloc(m_options.alignment, m_options.chunkSize));
+        if (!buffer) {
+            for (char* b : m_buffers)
+                std::free(b);
+            throw std::bad_alloc();
+        }
+        m_buffers.push_back(buffer);
+    }
+}
+
+ChunkPipeline::~ChunkPipeline()
+{
+    for (char* buffer : m_buffers)
+        std::free(buffer);
+}
+
+// Chunk i lives in buffer i % chunks. Each stage counts the chunks it has
+// finished; a stage may take chunk i once the stage before it finished it,
+// and the reader may refill a buffer once the writer is done with it.
+ChunkPipeline::Result ChunkPipeline::run(const Reader& reader, const Hasher& hasher, const Writer& writer,
+                                         const Poll& poll)
+{
+    const std::size_t ring = m_buffers.size();
+    std::vector<std::size_t> lengths(ring, 0);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::uint64_t read = 0;       // chunks finished by each stage
+    std::uint64_t hashed = 0;
+    std::uint64_t written = 0;
+    bool endOfInput = false;      // `read` is the final chunk count
+    bool stop = false;            // error or cancel: every stage leaves
+    Result result = Result::Done;
+    std::atomic<std::uint64_t> bytesWritten{0};
+
+    auto fail = [&](Result why) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result == Result::Done)
+            result = why;
+        stop = true;
+        changed.notify_all();
+    };
+
+    std::thread readThread([&]() {
+        for (std::uint64_t i = 0;; ++i) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return stop || i - written < ring; });
+                if (stop)
+                    return;
+            }
+            const std::size_t slot = i % ring;
+            const std::int64_t n = reader(m_buffers[slot], m_options.chunkSize);
+            if (n < 0) {
+                fail(Result::ReadFailed);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (n == 0) {
+                endOfInput = true;
+            } else {
+                lengths[slot] = static_cast<std::size_t>(n);
+                ++read;
+            }
+            changed.notify_all();
+            if (n == 0)
+                return;
+        }
+    });
+
+    std::thread hashThread;
+    if (hasher) {
+        hashThread = std::thread([&]() {
+            for (std::uint64_t i = 0;; ++i) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() { return stop || i < read || endOfInput; });
+                    if (stop || i >= read)
+                        return;
+                }
+                const std::size_t slot = i % ring;
+                hasher(m_buffers[slot], lengths[slot]);
+                std::lock_guard<std::mutex> lock(mutex);
+                ++hashed;
+                changed.notify_all();
+            }
+        });
+    }
+
+    std::thread writeThread([&]() {
+        for (std::uint64_t i = 0;; ++i) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                const std::uint64_t& ready = hasher ? hashed : read;
+                changed.wait(lock, [&]() { return stop || i < ready || (endOfInput && i >= read); });
+                if (stop || i >= ready)
+                    return;
+            }
+            const std::size_t slot = i % ring;
+            if (!writer(m_buffers[slot], lengths[slot])) {
+                fail(Result::WriteFailed);
+                return;
+            }
+            bytesWritten.fetch_add(lengths[slot], std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex);
+            ++written;
+            changed.notify_all();
+        }
+    });
+
+    // The caller's thread: progress and cancellation
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        const bool done = changed.wait_for(lock, std::chrono::milliseconds(m_options.pollMs), [&]() {
+            return stop || (endOfInput && written == read);
+        });
+        lock.unlock();
+        if (done)
+            break;
+        if (poll && !poll(bytesWritten.load(std::memory_order_relaxed)))
+            fail(Result::Cancelled);
+    }
+
+    readThread.join();
+    if (hashThread.joinable())
+        hashThread.join();
+    writeThread.join();
+
+    if (poll && result == Result::Done)
+        poll(bytesWritten.load(std::memory_order_relaxed));
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Streams data from a reader to a writer through a ring of preallocated,
+// aligned buffers, with each stage on its own thread: while the writer
+// stores chunk n, the reader already fills chunk n+1 (and an optional
+// hasher digests the chunks in between), so copying between two devices
+// runs at the speed of the slower one instead of the sum of both.
+//
+// The stages are callbacks, so the pipeline knows nothing about files; the
+// thread calling run() only waits and polls for progress and cancellation.
+class ChunkPipeline {
+public:
+    // Bytes read into `buffer` (at most `capacity`), 0 at the end, < 0 on error.
+    using Reader = std::function<std::int64_t(char* buffer, std::size_t capacity)>;
+    using Hasher = std::function<void(const char* data, std::size_t length)>;
+    // False on error.
+    using Writer = std::function<bool(const char* data, std::size_t length)>;
+    // Called on the run() thread with the bytes written so far; false cancels.
+    using Poll = std::function<bool(std::uint64_t written)>;
+
+    struct Options {
+        std::size_t chunkSize = 1024 * 1024;
+        std::size_t chunks = 4;          // buffers in the ring, at least 2
+        std::size_t alignment = 4096;    // of every buffer, a power of two (O_DIRECT wants the block size)
+        int pollMs = 50;                 // how often Poll is called
+    };
+
+    enum class Result { Done, ReadFailed, WriteFailed, Cancelled };
+
+    // The buffers are allocated here, once, and reused by every run().
+    explicit ChunkPipeline(const Options& options);
+    ~ChunkPipeline();
+
+    ChunkPipeline(const ChunkPipeline&) = delete;
+    ChunkPipeline& operator=(const ChunkPipeline&) = delete;
+
+    // `hasher` may be empty. Poll is also called once at the end.
+    Result run(const Reader& reader, const Hasher& hasher, const Writer& writer, const Poll& poll);
+
+    std::size_t chunkSize() const { return m_options.chunkSize; }
+
+private:
+    Options m_options;
+    std::vector<char*> m_buffers;
+};
@@ -119,6 +119,9 @@ bool Config::load(const QString& path)
     m_rightTabIndex = 0;
     m_compareTools.clear();
     m_compareToolIndex = 0;
+    m_indexRoots.clear();
+    m_indexDirectory.clear();
+    m_indexContents = false;
 
     QFile f(path);
     if (!f.exists()) {
@@ -162,6 +165,7 @@ bool Config::load(const QString& path)
                 else if (mode == "chunked") m_copyMode = CopyMode::Chunked;
                 else if (mode == "chunked_sha") m_copyMode = CopyMode::ChunkedSha;
                 else if (mode == "chunked_sync") m_copyMode = CopyMode::ChunkedSync;
+                else if (mode == "direct") m_copyMode = CopyMode::Direct;
             }
             if (auto threshold = general["large_file_threshold"].value<int64_t>())
                 m_largeFileThreshold = *threshold;
@@ -310,6 +314,21 @@ bool Config::load(const QString& path)
                 m_viewerY = static_cast<int>(*y);
         }
 
+        // [index] section - filename index
+        if (tbl.contains("index")) {
+            auto& index = *tbl["index"].as_table();
+            if (index.contains("roots") && index["roots"].is_array()) {
+                for (const auto& node : *index["roots"].as_array()) {
+                    if (auto s = node.value<std::string>())
+                        m_indexRoots.append(QString::fromStdString(*s));
+                }
+            }
+            if (auto dir = index["directory"].value<std::string>())
+                m_indexDirectory = QString::fromStdString(*dir);
+            if (auto contents = index["contents"].value<bool>())
+                m_indexContents = *contents;
+        }
+
         // [panels] section - sorting settings and columns
         if (tbl.contains("panels")) {
             auto& panels = *tbl["panels"].as_table();
@@ -475,6 +494,7 @@ bool Config::save() const
         case CopyMode::Chunked: copyModeStr = "chunked"; break;
         case CopyMode::ChunkedSha: copyModeStr = "chunked_sha"; break;
         case CopyMode::ChunkedSync: copyModeStr = "chunked_sync"; break;
+        case CopyMode::Direct: copyModeStr = "direct"; break;
     }
     generalTbl.insert("copy_mode", copyModeStr);
     generalTbl.insert("large_file_threshold", static_cast<int64_t>(m_largeFileThreshold));
@@ -549,6 +569,16 @@ bool Config::save() const
     viewerTbl.insert("y", static_cast<int64_t>(m_viewerY));
     tbl.insert("viewer", viewerTbl);
 
+    // [index] section - filename index
+    toml::table indexTbl;
+    toml::array indexRootsArr;
+    for (const QString& r : m_indexRoots)
+        indexRootsArr.push_back(r.toStdString());
+    indexTbl.insert("roots", indexRootsArr);
+    indexTbl.insert("directory", m_indexDirectory.toStdString());
+    indexTbl.insert("contents", m_indexContents);
+    tbl.insert("index", indexTbl);
+
     // [panels] section - sorting settings and columns
     toml::table panelsTbl;
     panelsTbl.insert("left_sort_column", m_leftSortColumn.toStdString());
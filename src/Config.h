@@ -18,7 +18,8 @@ enum class CopyMode {
     System,         // QFile::copy(), no progress
     Chunked,        // Chunked with progress, no SHA, no sync per chunk
     ChunkedSha,     // Chunked with SHA at end (fast if RAM > file size)
-    ChunkedSync     // Chunked with sync per chunk (honest progress, slower)
+    ChunkedSync,    // Chunked with sync per chunk (honest progress, slower)
+    Direct          // Chunked around the page cache (O_DIRECT), for huge files; Linux only
 };
 
 // Toolbar dock area
@@ -213,6 +214,16 @@ public:
   int syncBatchIntervalMs() const { return m_syncBatchIntervalMs; }
   void setSyncBatchIntervalMs(int ms) { m_syncBatchIntervalMs = ms; }
 
+  // Filename index: directory trees indexed for instant name search, and
+  // where the index files live (empty = the user's cache directory)
+  QStringList indexRoots() const { return m_indexRoots; }
+  void setIndexRoots(const QStringList& roots) { m_indexRoots = roots; }
+  QString indexDirectory() const { return m_indexDirectory; }
+  void setIndexDirectory(const QString& dir) { m_indexDirectory = dir; }
+  // Also keep a trigram index of file contents for "containing text" searches
+  bool indexContents() const { return m_indexContents; }
+  void setIndexContents(bool enabled) { m_indexContents = enabled; }
+
 private:
   Config()
       : m_leftColumns(defaultColumns())
@@ -294,6 +305,11 @@ private:
   // Editor MRU
   int m_editorMruMaxCount = 15;
   QStringList m_editorMruPaths;
+
+  // Filename index
+  QStringList m_indexRoots;
+  QString m_indexDirectory;
+  bool m_indexContents = false;
 };
 
 #endif
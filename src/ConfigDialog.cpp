@@ -1,5 +1,6 @@
 #include "ConfigDialog.h"
 #include "Config.h"
+#include "NameIndexService.h"
 #include "SizeFormat.h"
 #include "StringListEditorDialog.h"
 
@@ -652,6 +653,9 @@ void ConfigDialog::createGeneralPage()
     m_copyMode->addItem(tr("Chunked with progress"), static_cast<int>(CopyMode::Chunked));
     m_copyMode->addItem(tr("Chunked + SHA-256 verification"), static_cast<int>(CopyMode::ChunkedSha));
     m_copyMode->addItem(tr("Chunked + sync per chunk (slow but no progress freeze)"), static_cast<int>(CopyMode::ChunkedSync));
+#ifdef __linux__
+    m_copyMode->addItem(tr("Direct I/O, bypassing the page cache (huge files)"), static_cast<int>(CopyMode::Direct));
+#endif
     copyLayout->addRow(tr("Copy mode:"), m_copyMode);
 
     m_largeFileThreshold = new QSpinBox(copyGroup);
@@ -699,6 +703,51 @@ void ConfigDialog::createGeneralPage()
 
     layout->addWidget(syncGroup);
 
+    // Filename index used by the search dialog
+    auto* indexGroup = new QGroupBox(tr("Filename Index (Search)"), page);
+    auto* indexLayout = new QFormLayout(indexGroup);
+
+    auto* rootsRow = new QHBoxLayout();
+    m_indexRootsLabel = new QLabel(indexGroup);
+    m_indexRootsLabel->setWordWrap(true);
+    m_editIndexRootsBtn = new QPushButton(tr("Edit list\u2026"), indexGroup);
+    rootsRow->addWidget(m_indexRootsLabel, 1);
+    rootsRow->addWidget(m_editIndexRootsBtn);
+    indexLayout->addRow(tr("Indexed directories:"), rootsRow);
+
+    m_indexDirectory = new QLineEdit(indexGroup);
+    m_indexDirectory->setPlaceholderText(NameIndexService::defaultIndexDirectory());
+    indexLayout->addRow(tr("Index files:"), m_indexDirectory);
+
+    m_indexContents = new QCheckBox(tr("Also index file contents for \"containing text\" searches"), indexGroup);
+    m_indexContents->setToolTip(
+        tr("Keeps a trigram index of every file in the indexed directories, so repeated text "
+           "searches only read the files that can contain the text. Building it reads the whole "
+           "tree once; the index takes roughly a sixth of the size of the text it covers."));
+    indexLayout->addRow(m_indexContents);
+
+    auto* indexInfo = new QLabel(
+        tr("Name searches inside an indexed directory are answered from the index instead of "
+           "walking the disk. Indexes are built in the background and kept up to date while "
+           "the application runs. Each index stays on the filesystem of its directory."),
+        indexGroup);
+    indexInfo->setWordWrap(true);
+    indexInfo->setStyleSheet("QLabel { color: gray; }");
+    indexLayout->addRow(indexInfo);
+
+    connect(m_editIndexRootsBtn, &QPushButton::clicked, this, [this]() {
+        StringListEditorDialog::Options opts;
+        opts.title = tr("Edit Indexed Directories");
+
+        StringListEditorDialog dlg(m_indexRoots, 0, opts, this);
+        if (dlg.exec() != QDialog::Accepted)
+            return;
+        m_indexRoots = dlg.items();
+        updateIndexRootsLabel();
+    });
+
+    layout->addWidget(indexGroup);
+
     // Toolbar reset
     auto* toolbarGroup = new QGroupBox(tr("Toolbars"), page);
     auto* toolbarLayout = new QVBoxLayout(toolbarGroup);
@@ -878,6 +927,17 @@ void ConfigDialog::loadSettings()
     m_copyChunkSize->setValue(static_cast<int>(cfg.copyChunkSize() / (1024 * 1024)));
     m_syncBatchThreshold->setValue(cfg.syncBatchThresholdMB());
     m_syncBatchInterval->setValue(cfg.syncBatchIntervalMs());
+
+    // Filename index
+    m_indexRoots = cfg.indexRoots();
+    updateIndexRootsLabel();
+    m_indexDirectory->setText(cfg.indexDirectory());
+    m_indexContents->setChecked(cfg.indexContents());
+}
+
+void ConfigDialog::updateIndexRootsLabel()
+{
+    m_indexRootsLabel->setText(m_indexRoots.isEmpty() ? tr("(none)") : m_indexRoots.join(", "));
 }
 
 void ConfigDialog::saveSettings()
@@ -967,6 +1027,11 @@ void ConfigDialog::saveSettings()
     cfg.setSyncBatchThresholdMB(m_syncBatchThreshold->value());
     cfg.setSyncBatchIntervalMs(m_syncBatchInterval->value());
 
+    // Filename index
+    cfg.setIndexRoots(m_indexRoots);
+    cfg.setIndexDirectory(m_indexDirectory->text().trimmed());
+    cfg.setIndexContents(m_indexContents->isChecked());
+
     // Save to file
     cfg.save();
 }
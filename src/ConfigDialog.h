@@ -69,6 +69,7 @@ private:
     void saveSettings();
     void showRestartWarningIfNeeded();
     void validateKteThreshold();
+    void updateIndexRootsLabel();
     double getSystemRamMB() const;
 
     bool isWayland() const;
@@ -138,6 +139,13 @@ private:
     QDoubleSpinBox* m_syncBatchThreshold;
     QSpinBox* m_syncBatchInterval;
 
+    // Filename index
+    QLabel* m_indexRootsLabel;
+    QPushButton* m_editIndexRootsBtn;
+    QLineEdit* m_indexDirectory;
+    QCheckBox* m_indexContents;
+    QStringList m_indexRoots;
+
     // Comparer page
     QCheckBox* m_compareIgnoreTime;
     QCheckBox* m_compareIgnoreSize;
@@ -0,0 +1,262 @@
+#include "DiskReportDialog.h"
+#include "SearchDialog.h"
+#include "Config.h"
+
+#include <QCheckBox>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTabWidget>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include "keys/ObjectRegistry.h"
+#include "quitls.h"
+
+namespace {
+
+// Items carry what feeding them to the panel needs
+constexpr int PathRole = Qt::UserRole;
+constexpr int SizeRole = Qt::UserRole + 1;
+constexpr int MtimeRole = Qt::UserRole + 2;
+constexpr int IsDirRole = Qt::UserRole + 3;
+
+enum Column { NameColumn, SizeColumn, ModifiedColumn, DirColumn };
+
+QTreeWidget* createList(QWidget* parent)
+{
+    auto* list = new QTreeWidget(parent);
+    list->setColumnCount(4);
+    list->setHeaderLabels({QObject::tr("Name"), QObject::tr("Size"), QObject::tr("Modified"),
+                           QObject::tr("Directory")});
+    list->setRootIsDecorated(false);
+    list->setUniformRowHeights(true);
+    list->header()->resizeSection(NameColumn, 280);
+    return list;
+}
+
+} // anonymous namespace
+
+DiskReportDialog::DiskReportDialog(QWidget* parent)
+    : QDialog(parent)
+    , m_progressTimer(new QTimer(this))
+    , m_watcher(new QFutureWatcher<search::TopKReport>(this))
+{
+    ObjectRegistry::add(this, "DiskReportDialog");
+    setWindowTitle(tr("Disk Usage Report"));
+    resize(900, 550);
+
+    auto* layout = new QVBoxLayout(this);
+
+    auto* form = new QFormLayout;
+    m_rootEdit = new QLineEdit(this);
+    form->addRow(tr("Scan:"), m_rootEdit);
+    auto* optionsRow = new QHBoxLayout;
+    m_countSpin = new QSpinBox(this);
+    m_countSpin->setRange(1, 10000);
+    m_countSpin->setValue(100);
+    optionsRow->addWidget(m_countSpin);
+    m_oneFsCheck = new QCheckBox(tr("Stay on one filesystem"), this);
+    m_oneFsCheck->setChecked(true);
+    optionsRow->addWidget(m_oneFsCheck);
+    optionsRow->addStretch();
+    form->addRow(tr("Entries per list:"), optionsRow);
+    layout->addLayout(form);
+
+    m_tabs = new QTabWidget(this);
+    m_largestFiles = createList(this);
+    m_oldestFiles = createList(this);
+    m_largestDirs = createList(this);
+    m_largestDirs->setToolTip(tr("Directories by the size of the files directly in them"));
+    m_tabs->addTab(m_largestFiles, tr("Largest files"));
+    m_tabs->addTab(m_oldestFiles, tr("Oldest files"));
+    m_tabs->addTab(m_largestDirs, tr("Largest directories"));
+    layout->addWidget(m_tabs, 1);
+
+    m_statusLabel = new QLabel(this);
+    layout->addWidget(m_statusLabel);
+
+    auto* buttons = new QHBoxLayout;
+    m_startButton = new QPushButton(tr("Start"), this);
+    m_feedButton = new QPushButton(tr("Feed to listbox"), this);
+    buttons->addWidget(m_startButton);
+    buttons->addStretch();
+    buttons->addWidget(m_feedButton);
+    layout->addLayout(buttons);
+
+    connect(m_startButton, &QPushButton::clicked, this, [this]() {
+        if (m_watcher->isRunning())
+            stopScan();
+        else
+            startScan();
+    });
+    connect(m_feedButton, &QPushButton::clicked, this, &DiskReportDialog::feedCurrentList);
+    for (QTreeWidget* list : {m_largestFiles, m_oldestFiles, m_largestDirs})
+        connect(list, &QTreeWidget::itemDoubleClicked, this, &DiskReportDialog::goToItem);
+    connect(m_watcher, &QFutureWatcher<search::TopKReport>::finished, this, &DiskReportDialog::onScanFinished);
+    connect(m_progressTimer, &QTimer::timeout, this, &DiskReportDialog::updateProgress);
+
+    setRunning(false);
+}
+
+DiskReportDialog::~DiskReportDialog()
+{
+    stopScan();
+}
+
+void DiskReportDialog::setRoot(const QString& root)
+{
+    if (!m_watcher->isRunning())
+        m_rootEdit->setText(root);
+    m_rootEdit->setFocus();
+}
+
+void DiskReportDialog::setRunning(bool running)
+{
+    m_startButton->setText(running ? tr("Stop") : tr("Start"));
+    m_rootEdit->setEnabled(!running);
+    m_countSpin->setEnabled(!running);
+    m_oneFsCheck->setEnabled(!running);
+    m_feedButton->setEnabled(!running && m_largestFiles->topLevelItemCount() > 0);
+}
+
+void DiskReportDialog::startScan()
+{
+    m_root = QFileInfo(m_rootEdit->text().trimmed()).absoluteFilePath();
+    if (!QFileInfo(m_root).isDir()) {
+        m_statusLabel->setText(tr("%1 is not a directory").arg(m_root));
+        return;
+    }
+
+    for (QTreeWidget* list : {m_largestFiles, m_oldestFiles, m_largestDirs})
+        list->clear();
+    m_cancel = std::make_shared<std::atomic<bool>>(false);
+    m_scanned = std::make_shared<std::atomic<std::uint64_t>>(0);
+
+    search::TopKOptions options;
+    options.count = static_cast<std::size_t>(m_countSpin->value());
+    options.oneFileSystem = m_oneFsCheck->isChecked();
+    options.cancel = m_cancel.get();
+    options.scanned = m_scanned.get();
+    m_watcher->setFuture(QtConcurrent::run(
+        [root = QFile::encodeName(m_root).toStdString(), options, cancel = m_cancel, scanned = m_scanned]() {
+            return search::findTopK(root, options);
+        }));
+    setRunning(true);
+    updateProgress();
+    m_progressTimer->start(200);
+}
+
+void DiskReportDialog::stopScan()
+{
+    if (!m_watcher->isRunning())
+        return;
+    *m_cancel = true;
+    m_watcher->waitForFinished();
+}
+
+void DiskReportDialog::updateProgress()
+{
+    if (m_scanned)
+        m_statusLabel->setText(tr("Scanning: %1 files").arg(QLocale().toString(
+            static_cast<qulonglong>(m_scanned->load(std::memory_order_relaxed)))));
+}
+
+// A stopped scan still shows what it had found
+void DiskReportDialog::onScanFinished()
+{
+    m_progressTimer->stop();
+    const search::TopKReport report = m_watcher->result();
+    fillList(m_largestFiles, report.largestFiles, false);
+    fillList(m_oldestFiles, report.oldestFiles, false);
+    fillList(m_largestDirs, report.largestDirs, true);
+
+    QString status = tr("%1 files, %2")
+                         .arg(QLocale().toString(static_cast<qulonglong>(report.files)),
+                              qFormatSize(static_cast<std::size_t>(report.bytes), Config::instance().sizeFormat()));
+    if (*m_cancel)
+        status += tr(" - stopped");
+    m_statusLabel->setText(status);
+    setRunning(false);
+}
+
+void DiskReportDialog::fillList(QTreeWidget* list, const std::vector<search::ReportEntry>& entries, bool dirs)
+{
+    const QLocale locale;
+    QList<QTreeWidgetItem*> items;
+    items.reserve(static_cast<int>(entries.size()));
+    for (const search::ReportEntry& entry : entries) {
+        const QString path = QFile::decodeName(QByteArray::fromStdString(entry.path));
+        const QFileInfo info(path);
+        auto* item = new QTreeWidgetItem;
+        item->setText(NameColumn, info.fileName());
+        item->setText(SizeColumn, qFormatSize(static_cast<std::size_t>(entry.size), Config::instance().sizeFormat()));
+        item->setTextAlignment(SizeColumn, Qt::AlignRight | Qt::AlignVCenter);
+        if (!dirs) {
+            item->setText(ModifiedColumn, locale.toString(
+                QDateTime::fromMSecsSinceEpoch(entry.mtimeNs / 1000000), QLocale::ShortFormat));
+        }
+        item->setText(DirColumn, info.absolutePath());
+        item->setData(NameColumn, PathRole, path);
+        item->setData(NameColumn, SizeRole, static_cast<qulonglong>(entry.size));
+        item->setData(NameColumn, MtimeRole, static_cast<qlonglong>(entry.mtimeNs / 1000000));
+        item->setData(NameColumn, IsDirRole, dirs);
+        items.append(item);
+    }
+    list->addTopLevelItems(items);
+}
+
+void DiskReportDialog::feedCurrentList()
+{
+    auto* list = qobject_cast<QTreeWidget*>(m_tabs->currentWidget());
+    if (!list || list->topLevelItemCount() == 0)
+        return;
+
+    QVector<SearchResult> results;
+    results.reserve(list->topLevelItemCount());
+    for (int i = 0; i < list->topLevelItemCount(); ++i) {
+        const QTreeWidgetItem* item = list->topLevelItem(i);
+        const QFileInfo info(item->data(NameColumn, PathRole).toString());
+        SearchResult r;
+        r.dir = info.absolutePath();
+        r.name = info.fileName();
+        r.size = static_cast<qint64>(item->data(NameColumn, SizeRole).toULongLong());
+        r.modifiedTimestamp = item->data(NameColumn, MtimeRole).toLongLong();
+        r.isDir = item->data(NameColumn, IsDirRole).toBool();
+        results.append(r);
+    }
+    hide();
+    emit requestFeedToListbox(results, m_root);
+}
+
+void DiskReportDialog::goToItem(QTreeWidgetItem* item)
+{
+    if (!item)
+        return;
+    const QFileInfo info(item->data(NameColumn, PathRole).toString());
+    hide();
+    emit requestGoToFile(info.absolutePath(), info.fileName());
+}
+
+// Return starts a scan from the options and goes to the entry in a list
+bool DiskReportDialog::doActivate(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    auto* list = qobject_cast<QTreeWidget*>(m_tabs->currentWidget());
+    if (list && list->hasFocus())
+        goToItem(list->currentItem());
+    else if (!m_watcher->isRunning())
+        startScan();
+    return true;
+}
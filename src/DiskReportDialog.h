@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "search/TopKReport.h"
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QSpinBox;
+class QTabWidget;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QKeyEvent;
+struct SearchResult;
+
+// "What is eating the disk": the K largest files, K oldest files and K
+// largest directories below a directory, from one streaming scan
+// (search::findTopK) whose memory does not grow with the tree. Each list
+// can be fed to the panel like search results.
+class DiskReportDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit DiskReportDialog(QWidget* parent = nullptr);
+    ~DiskReportDialog();
+
+    void setRoot(const QString& root);
+
+    Q_INVOKABLE bool doActivate(QObject* obj, QKeyEvent* keyEvent);
+
+signals:
+    void requestGoToFile(const QString& dir, const QString& name);
+    void requestFeedToListbox(const QVector<SearchResult>& results, const QString& searchPath);
+
+private:
+    void startScan();
+    void stopScan();
+    void onScanFinished();
+    void updateProgress();
+    void fillList(QTreeWidget* list, const std::vector<search::ReportEntry>& entries, bool dirs);
+    void feedCurrentList();
+    void goToItem(QTreeWidgetItem* item);
+    void setRunning(bool running);
+
+    QLineEdit* m_rootEdit;
+    QSpinBox* m_countSpin;
+    QCheckBox* m_oneFsCheck;
+    QPushButton* m_startButton;
+    QPushButton* m_feedButton;
+    QTabWidget* m_tabs;
+    QTreeWidget* m_largestFiles;
+    QTreeWidget* m_oldestFiles;
+    QTreeWidget* m_largestDirs;
+    QLabel* m_statusLabel;
+    QTimer* m_progressTimer;
+
+    QString m_root;                 // of the last scan
+    QFutureWatcher<search::TopKReport>* m_watcher;
+    std::shared_ptr<std::atomic<bool>> m_cancel;            // of the running scan
+    std::shared_ptr<std::atomic<std::uint64_t>> m_scanned;
+};
@@ -0,0 +1,375 @@
+#include "DuplicatesDialog.h"
+#include "SearchDialog.h"
+#include "Config.h"
+
+#include <QCheckBox>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#include "keys/ObjectRegistry.h"
+#include "quitls.h"
+
+namespace {
+
+// Child items carry the group and the file within it
+constexpr int GroupRole = Qt::UserRole;
+constexpr int FileRole = Qt::UserRole + 1;
+
+enum Column { NameColumn, ModifiedColumn, DirColumn };
+
+QString formatSize(std::uint64_t size)
+{
+    return qFormatSize(static_cast<std::size_t>(size), Config::instance().sizeFormat());
+}
+
+} // anonymous namespace
+
+DuplicatesDialog::DuplicatesDialog(QWidget* parent)
+    : QDialog(parent)
+    , m_progressTimer(new QTimer(this))
+    , m_watcher(new QFutureWatcher<Groups>(this))
+{
+    ObjectRegistry::add(this, "DuplicatesDialog");
+    setWindowTitle(tr("Find Duplicates"));
+    resize(900, 550);
+
+    auto* layout = new QVBoxLayout(this);
+
+    auto* form = new QFormLayout;
+    m_rootEdit = new QLineEdit(this);
+    form->addRow(tr("Search in:"), m_rootEdit);
+    auto* optionsRow = new QHBoxLayout;
+    m_minSizeSpin = new QSpinBox(this);
+    m_minSizeSpin->setRange(0, 1024 * 1024);
+    m_minSizeSpin->setSuffix(tr(" KiB"));
+    m_minSizeSpin->setValue(1);
+    m_minSizeSpin->setToolTip(tr("Smaller files are ignored; 0 takes every non-empty file"));
+    optionsRow->addWidget(m_minSizeSpin);
+    m_oneFsCheck = new QCheckBox(tr("Stay on one filesystem"), this);
+    m_oneFsCheck->setChecked(true);
+    optionsRow->addWidget(m_oneFsCheck);
+    optionsRow->addStretch();
+    form->addRow(tr("Minimum size:"), optionsRow);
+    layout->addLayout(form);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setColumnCount(3);
+    m_tree->setHeaderLabels({tr("Name"), tr("Modified"), tr("Directory")});
+    m_tree->setUniformRowHeights(true);
+    m_tree->header()->setSectionResizeMode(NameColumn, QHeaderView::Interactive);
+    m_tree->header()->resizeSection(NameColumn, 320);
+    layout->addWidget(m_tree, 1);
+
+    m_statusLabel = new QLabel(this);
+    layout->addWidget(m_statusLabel);
+
+    auto* buttons = new QHBoxLayout;
+    m_startButton = new QPushButton(tr("Start"), this);
+    m_pauseButton = new QPushButton(tr("Pause"), this);
+    m_newestButton = new QPushButton(tr("Mark all but newest"), this);
+    m_oldestButton = new QPushButton(tr("Mark all but oldest"), this);
+    m_clearButton = new QPushButton(tr("Clear marks"), this);
+    m_feedButton = new QPushButton(tr("Feed marked to listbox"), this);
+    buttons->addWidget(m_startButton);
+    buttons->addWidget(m_pauseButton);
+    buttons->addStretch();
+    buttons->addWidget(m_newestButton);
+    buttons->addWidget(m_oldestButton);
+    buttons->addWidget(m_clearButton);
+    buttons->addWidget(m_feedButton);
+    layout->addLayout(buttons);
+
+    connect(m_startButton, &QPushButton::clicked, this, [this]() {
+        if (m_watcher->isRunning())
+            stopSearch();
+        else
+            startSearch();
+    });
+    connect(m_pauseButton, &QPushButton::clicked, this, &DuplicatesDialog::togglePause);
+    connect(m_newestButton, &QPushButton::clicked, this, [this]() { markAllBut(true); });
+    connect(m_oldestButton, &QPushButton::clicked, this, [this]() { markAllBut(false); });
+    connect(m_clearButton, &QPushButton::clicked, this, &DuplicatesDialog::clearMarks);
+    connect(m_feedButton, &QPushButton::clicked, this, &DuplicatesDialog::feedMarked);
+    connect(m_tree, &QTreeWidget::itemDoubleClicked, this, &DuplicatesDialog::goToItem);
+    connect(m_watcher, &QFutureWatcher<Groups>::finished, this, &DuplicatesDialog::onSearchFinished);
+    connect(m_progressTimer, &QTimer::timeout, this, &DuplicatesDialog::updateProgress);
+
+    // Links to one inode share a fate
+    connect(m_tree, &QTreeWidget::itemChanged, this, [this](QTreeWidgetItem* item, int column) {
+        if (column != NameColumn || !item->parent())
+            return;
+        const auto& group = m_groups[item->data(NameColumn, GroupRole).toULongLong()];
+        const auto& file = group.files[item->data(NameColumn, FileRole).toULongLong()];
+        QSignalBlocker blocker(m_tree);
+        QTreeWidgetItem* parent = item->parent();
+        for (int i = 0; i < parent->childCount(); ++i) {
+            QTreeWidgetItem* sibling = parent->child(i);
+            const auto& other = group.files[sibling->data(NameColumn, FileRole).toULongLong()];
+            if (other.device == file.device && other.inode == file.inode)
+                sibling->setCheckState(NameColumn, item->checkState(NameColumn));
+        }
+    });
+
+    setRunning(false);
+}
+
+DuplicatesDialog::~DuplicatesDialog()
+{
+    stopSearch();
+}
+
+void DuplicatesDialog::setRoot(const QString& root)
+{
+    if (!m_watcher->isRunning())
+        m_rootEdit->setText(root);
+    m_rootEdit->setFocus();
+}
+
+void DuplicatesDialog::setRunning(bool running)
+{
+    m_startButton->setText(running ? tr("Stop") : tr("Start"));
+    m_pauseButton->setEnabled(running);
+    m_pauseButton->setText(tr("Pause"));
+    m_paused = false;
+    m_rootEdit->setEnabled(!running);
+    m_minSizeSpin->setEnabled(!running);
+    m_oneFsCheck->setEnabled(!running);
+    const bool haveGroups = !running && !m_groups.empty();
+    m_newestButton->setEnabled(haveGroups);
+    m_oldestButton->setEnabled(haveGroups);
+    m_clearButton->setEnabled(haveGroups);
+    m_feedButton->setEnabled(haveGroups);
+}
+
+void DuplicatesDialog::startSearch()
+{
+    m_root = QFileInfo(m_rootEdit->text().trimmed()).absoluteFilePath();
+    if (!QFileInfo(m_root).isDir()) {
+        m_statusLabel->setText(tr("%1 is not a directory").arg(m_root));
+        return;
+    }
+
+    m_tree->clear();
+    m_groups.clear();
+    m_cancel = std::make_shared<std::atomic<bool>>(false);
+    m_pause = std::make_shared<search::PauseGate>();
+    m_progress = std::make_shared<search::DuplicateProgress>();
+
+    search::DuplicateOptions options;
+    options.minSize = static_cast<std::uint64_t>(m_minSizeSpin->value()) * 1024;
+    options.oneFileSystem = m_oneFsCheck->isChecked();
+    options.cancel = m_cancel.get();
+    options.pause = m_pause.get();
+    options.progress = m_progress.get();
+
+    // The shared pointers keep the state alive for the worker even if the
+    // dialog starts another search meanwhile
+    m_watcher->setFuture(QtConcurrent::run(
+        [root = QFile::encodeName(m_root).toStdString(), options, cancel = m_cancel, pause = m_pause,
+         progress = m_progress]() { return search::findDuplicates(root, options); }));
+    setRunning(true);
+    updateProgress();
+    m_progressTimer->start(200);
+}
+
+void DuplicatesDialog::stopSearch()
+{
+    if (!m_watcher->isRunning())
+        return;
+    *m_cancel = true;
+    m_pause->resume();
+    m_watcher->waitForFinished();
+}
+
+void DuplicatesDialog::togglePause()
+{
+    if (!m_watcher->isRunning())
+        return;
+    m_paused = !m_paused;
+    if (m_paused)
+        m_pause->pause();
+    else
+        m_pause->resume();
+    m_pauseButton->setText(m_paused ? tr("Resume") : tr("Pause"));
+    updateProgress();
+}
+
+void DuplicatesDialog::updateProgress()
+{
+    if (!m_progress)
+        return;
+    const QLocale locale;
+    const auto done = static_cast<qulonglong>(m_progress->done.load(std::memory_order_relaxed));
+    const auto total = static_cast<qulonglong>(m_progress->total.load(std::memory_order_relaxed));
+    QString text;
+    switch (m_progress->stage.load()) {
+    case search::DuplicateStage::Collecting:
+        text = tr("Collecting files: %1").arg(locale.toString(done));
+        break;
+    case search::DuplicateStage::Sampling:
+        text = tr("Comparing file ends: %1 of %2 files").arg(locale.toString(done), locale.toString(total));
+        break;
+    case search::DuplicateStage::Hashing:
+        text = tr("Hashing candidates: %1 of %2").arg(formatSize(done), formatSize(total));
+        break;
+    case search::DuplicateStage::Done:
+        return;
+    }
+    if (m_paused)
+        text += tr(" - paused");
+    m_statusLabel->setText(text);
+}
+
+void DuplicatesDialog::onSearchFinished()
+{
+    m_progressTimer->stop();
+    if (*m_cancel) {
+        m_statusLabel->setText(tr("Stopped"));
+        setRunning(false);
+        return;
+    }
+    m_groups = m_watcher->result();
+    showGroups();
+    setRunning(false);
+}
+
+void DuplicatesDialog::showGroups()
+{
+    QSignalBlocker blocker(m_tree);
+    m_tree->clear();
+    const QLocale locale;
+    std::uint64_t wasted = 0;
+    QList<QTreeWidgetItem*> items;
+    for (std::size_t g = 0; g < m_groups.size(); ++g) {
+        const search::DuplicateGroup& group = m_groups[g];
+        wasted += group.wastedBytes();
+        auto* groupItem = new QTreeWidgetItem;
+        groupItem->setText(NameColumn, tr("%1 copies x %2, %3 wasted")
+                                           .arg(group.copies)
+                                           .arg(formatSize(group.size), formatSize(group.wastedBytes())));
+        groupItem->setFirstColumnSpanned(true);
+        for (std::size_t f = 0; f < group.files.size(); ++f) {
+            const search::DuplicateFile& file = group.files[f];
+            const QFileInfo info(QFile::decodeName(QByteArray::fromStdString(file.path)));
+            bool hardLink = false;
+            for (const search::DuplicateFile& other : group.files)
+                hardLink |= &other != &file && other.device == file.device && other.inode == file.inode;
+
+            auto* item = new QTreeWidgetItem(groupItem);
+            item->setText(NameColumn, hardLink ? tr("%1 (hard link)").arg(info.fileName()) : info.fileName());
+            item->setText(ModifiedColumn, locale.toString(
+                QDateTime::fromMSecsSinceEpoch(file.mtimeNs / 1000000), QLocale::ShortFormat));
+            item->setText(DirColumn, info.absolutePath());
+            item->setData(NameColumn, GroupRole, static_cast<qulonglong>(g));
+            item->setData(NameColumn, FileRole, static_cast<qulonglong>(f));
+            item->setCheckState(NameColumn, Qt::Unchecked);
+        }
+        items.append(groupItem);
+    }
+    m_tree->addTopLevelItems(items);
+    m_tree->expandAll();
+
+    m_statusLabel->setText(m_groups.empty() ? tr("No duplicates found")
+                                            : tr("%1 groups of duplicates, %2 wasted")
+                                                  .arg(locale.toString(static_cast<qulonglong>(m_groups.size())),
+                                                       formatSize(wasted)));
+}
+
+// In every group, keeps the newest (or oldest) file with all its links and
+// marks the rest
+void DuplicatesDialog::markAllBut(bool keepNewest)
+{
+    QSignalBlocker blocker(m_tree);
+    for (int g = 0; g < m_tree->topLevelItemCount(); ++g) {
+        QTreeWidgetItem* groupItem = m_tree->topLevelItem(g);
+        if (groupItem->childCount() == 0)
+            continue;
+        const auto& group = m_groups[groupItem->child(0)->data(NameColumn, GroupRole).toULongLong()];
+        const auto kept = std::max_element(group.files.begin(), group.files.end(),
+                                           [keepNewest](const auto& a, const auto& b) {
+                                               return keepNewest ? a.mtimeNs < b.mtimeNs : a.mtimeNs > b.mtimeNs;
+                                           });
+        for (int i = 0; i < groupItem->childCount(); ++i) {
+            QTreeWidgetItem* item = groupItem->child(i);
+            const auto& file = group.files[item->data(NameColumn, FileRole).toULongLong()];
+            const bool keep = file.device == kept->device && file.inode == kept->inode;
+            item->setCheckState(NameColumn, keep ? Qt::Unchecked : Qt::Checked);
+        }
+    }
+}
+
+void DuplicatesDialog::clearMarks()
+{
+    QSignalBlocker blocker(m_tree);
+    for (int g = 0; g < m_tree->topLevelItemCount(); ++g) {
+        QTreeWidgetItem* groupItem = m_tree->topLevelItem(g);
+        for (int i = 0; i < groupItem->childCount(); ++i)
+            groupItem->child(i)->setCheckState(NameColumn, Qt::Unchecked);
+    }
+}
+
+void DuplicatesDialog::feedMarked()
+{
+    QVector<SearchResult> results;
+    for (int g = 0; g < m_tree->topLevelItemCount(); ++g) {
+        QTreeWidgetItem* groupItem = m_tree->topLevelItem(g);
+        for (int i = 0; i < groupItem->childCount(); ++i) {
+            QTreeWidgetItem* item = groupItem->child(i);
+            if (item->checkState(NameColumn) != Qt::Checked)
+                continue;
+            const auto& group = m_groups[item->data(NameColumn, GroupRole).toULongLong()];
+            const auto& file = group.files[item->data(NameColumn, FileRole).toULongLong()];
+            const QFileInfo info(QFile::decodeName(QByteArray::fromStdString(file.path)));
+            SearchResult r;
+            r.dir = info.absolutePath();
+            r.name = info.fileName();
+            r.size = static_cast<qint64>(group.size);
+            r.modifiedTimestamp = file.mtimeNs / 1000000;
+            results.append(r);
+        }
+    }
+    if (results.isEmpty()) {
+        m_statusLabel->setText(tr("Nothing is marked"));
+        return;
+    }
+    hide();
+    emit requestFeedToListbox(results, m_root);
+}
+
+void DuplicatesDialog::goToItem(QTreeWidgetItem* item)
+{
+    if (!item || !item->parent())
+        return;
+    const auto& group = m_groups[item->data(NameColumn, GroupRole).toULongLong()];
+    const auto& file = group.files[item->data(NameColumn, FileRole).toULongLong()];
+    const QFileInfo info(QFile::decodeName(QByteArray::fromStdString(file.path)));
+    hide();
+    emit requestGoToFile(info.absolutePath(), info.fileName());
+}
+
+// Return starts a search from the options and goes to the file in the list
+bool DuplicatesDialog::doActivate(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    if (m_tree->hasFocus())
+        goToItem(m_tree->currentItem());
+    else if (!m_watcher->isRunning())
+        startSearch();
+    return true;
+}
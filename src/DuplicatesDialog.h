@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "search/DuplicateFinder.h"
+#include "search/ThreadControl.h"
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QKeyEvent;
+struct SearchResult;
+
+// Finds files with identical content below a directory (search::findDuplicates)
+// and lists them one group per identical content, largest waste first.
+//
+// Files can be marked by hand or with "all but newest/oldest" in every
+// group, and the marked ones fed to the panel, where the usual file
+// operations apply to them. Links to one inode are marked or kept together:
+// deleting a hard link frees nothing while another one remains.
+class DuplicatesDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit DuplicatesDialog(QWidget* parent = nullptr);
+    ~DuplicatesDialog();
+
+    void setRoot(const QString& root);
+
+    Q_INVOKABLE bool doActivate(QObject* obj, QKeyEvent* keyEvent);
+
+signals:
+    void requestGoToFile(const QString& dir, const QString& name);
+    void requestFeedToListbox(const QVector<SearchResult>& results, const QString& searchPath);
+
+private:
+    using Groups = std::vector<search::DuplicateGroup>;
+
+    void startSearch();
+    void stopSearch();
+    void togglePause();
+    void onSearchFinished();
+    void updateProgress();
+    void showGroups();
+    void markAllBut(bool keepNewest);
+    void clearMarks();
+    void feedMarked();
+    void goToItem(QTreeWidgetItem* item);
+    void setRunning(bool running);
+
+    QLineEdit* m_rootEdit;
+    QSpinBox* m_minSizeSpin;        // KiB
+    QCheckBox* m_oneFsCheck;
+    QPushButton* m_startButton;
+    QPushButton* m_pauseButton;
+    QPushButton* m_newestButton;
+    QPushButton* m_oldestButton;
+    QPushButton* m_clearButton;
+    QPushButton* m_feedButton;
+    QTreeWidget* m_tree;
+    QLabel* m_statusLabel;
+    QTimer* m_progressTimer;
+
+    QString m_root;                 // of the last search
+    Groups m_groups;
+    QFutureWatcher<Groups>* m_watcher;
+    std::shared_ptr<std::atomic<bool>> m_cancel;          // of the running search
+    std::shared_ptr<search::PauseGate> m_pause;
+    std::shared_ptr<search::DuplicateProgress> m_progress;
+    bool m_paused = false;
+};
@@ -169,6 +169,14 @@ void FileOperationProgressDialog::endFile()
     refreshBars(false);
 }
 
+void FileOperationProgressDialog::addFinishedFiles(quint64 files, quint64 bytes, quint64 transferred)
+{
+    m_fileIndex += files;
+    m_bytesDone += bytes;
+    m_transferredBytes += transferred;
+    refreshBars(false);
+}
+
 void FileOperationProgressDialog::refreshBars(bool force)
 {
     // Top bar: progress within the current file.
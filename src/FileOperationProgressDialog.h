@@ -37,6 +37,11 @@ public:
     void addFileBytes(qint64 bytesSoFar);
     void endFile();
 
+    // Files finished outside of beginFile()/endFile(), by parallel copiers:
+    // counted as done at once. `transferred` is the part of `bytes` actually
+    // written (failed and skipped files advance the bar, not the speed).
+    void addFinishedFiles(quint64 files, quint64 bytes, quint64 transferred);
+
     // Report bytes actually written to disk. Drives speed/ETA so that skipped
     // files (which advance the progress bar but transfer nothing) do not inflate
     // the measured speed.
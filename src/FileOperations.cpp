@@ -1,5 +1,5 @@
-// _GNU_SOURCE must be defined before any system header so that syncfs() is
-// declared by <unistd.h> on Linux.
+// _GNU_SOURCE must be defined before any system header so that syncfs(),
+// copy_file_range(), sync_file_range() and O_DIRECT are declared on Linux.
 #ifndef _WIN32
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
@@ -7,6 +7,7 @@
 #endif
 
 #include "FileOperations.h"
+#include "ChunkPipeline.h"
 #include "Config.h"
 #include "FileOperationProgressDialog.h"
 #include "SortedDirIterator.h"
@@ -19,7 +20,11 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QMutex>
 #include <QProgressDialog>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 
 #ifdef _WIN32
 #include <io.h>
@@ -30,7 +35,16 @@
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <cerrno>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <deque>
 #include <limits>
+#include <memory>
+#include <vector>
 
 namespace FileOperations {
 
@@ -44,7 +58,8 @@ namespace FileOperations {
 // files are batched and synced once enough bytes have accumulated, plus once more
 // at the end of the operation (or when the user interrupts it). On slow removable
 // media this is dramatically faster than fsync-after-every-small-file while still
-// guaranteeing everything is on disk before we report completion.
+// guaranteeing everything is on disk before we report completion. The copiers
+// of CopyPipeline report to it from their own threads, hence the mutex.
 class DestSync {
 public:
     explicit DestSync(const QString& destPath) {
@@ -68,6 +83,7 @@ public:
 
     // Called after each regular file is copied.
     void afterFileCopied(const QString& dstPath, qint64 fileSize, bool largeFile) {
+        QMutexLocker locker(&m_mutex);
 #ifdef _WIN32
         // No whole-volume flush without admin rights; flush each file as before.
         flushFileWindows(dstPath);
@@ -88,6 +104,7 @@ public:
 
     // Force a sync of everything still pending (end of operation / on abort).
     void flush() {
+        QMutexLocker locker(&m_mutex);
 #ifndef _WIN32
         if (m_pending > 0)
             doSync();
@@ -119,12 +136,201 @@ private:
     }
     int m_fd = -1;
 #endif
+    QMutex m_mutex;
     quint64 m_pending = 0;
     quint64 m_batchThreshold = 10ULL * 1024 * 1024;
     int m_maxIntervalMs = 1000;
     QElapsedTimer m_timer;
 };
 
+// Copies the small files of a directory tree on worker threads while the
+// tree is walked on the GUI thread.
+//
+// With many small files the time goes into the open/create/close of each
+// one rather than into the bytes, and that latency overlaps well. Only
+// files whose destination does not exist yet come here - anything that
+// needs an overwrite prompt, and every large file (chunked, with per-chunk
+// progress), is still copied in line by the walk. At most MaxInFlight files
+// are queued or being copied; submit() waits, pumping events, for a free
+// slot. Progress is summed in atomics and handed to the dialog by the GUI
+// thread as it goes.
+//
+// A directory's metadata is applied once everything in it is done: each
+// directory counts its pending files and subdirectories plus one for the
+// walk still listing it, and whoever drops the count to zero - the walk or
+// the copier of its last file - finalizes it and releases its parent.
+// Failures are collected and reported once, by reportFailures().
+class CopyPipeline {
+public:
+    CopyPipeline(bool move, FileOperationProgressDialog& progress, DestSync& sync)
+        : m_move(move)
+        , m_progress(progress)
+        , m_sync(sync)
+        , m_slots(MaxInFlight)
+    {
+        m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
+    }
+
+    ~CopyPipeline() {
+        drain();
+    }
+
+    // The walk enters and leaves directories; files submitted in between
+    // belong to the innermost one.
+    void enterDir(const QString& srcPath, const QString& dstPath) {
+        auto dir = std::make_unique<Dir>();
+        dir->srcPath = srcPath;
+        dir->dstPath = dstPath;
+        dir->parent = m_stack.empty() ? nullptr : m_stack.back();
+        if (dir->parent)
+            dir->parent->pending.fetch_add(1);
+        m_stack.push_back(dir.get());
+        m_dirs.push_back(std::move(dir));
+    }
+
+    void leaveDir() {
+        Dir* dir = m_stack.back();
+        m_stack.pop_back();
+        release(dir);
+    }
+
+    // True if `size` bytes that do not exist at the destination yet go here.
+    bool accepts(qint64 size) const {
+        return !m_stack.empty() && size <= Config::instance().largeFileThreshold();
+    }
+
+    void submit(const QString& srcPath, const QString& dstPath, qint64 size) {
+        while (!m_slots.tryAcquire(1, PollMs))
+            pumpProgress();
+        Dir* dir = m_stack.back();
+        dir->pending.fetch_add(1);
+        m_pool.start([this, srcPath, dstPath, size, dir]() {
+            copyOne(srcPath, dstPath, size);
+            release(dir);
+            m_slots.release();
+        });
+        pumpProgress();
+    }
+
+    // Wait for every submitted file.
+    void drain() {
+        while (!m_slots.tryAcquire(MaxInFlight, PollMs))
+            pumpProgress();
+        m_slots.release(MaxInFlight);
+        pumpProgress();
+    }
+
+    // Queued files are skipped, those being copied finish.
+    void cancel() { m_cancel = true; }
+
+    bool hadFailures() const { return m_failed.load(); }
+
+    void reportFailures(QWidget* parent) {
+        QMutexLocker locker(&m_failuresMutex);
+        if (m_failures.isEmpty())
+            return;
+        QStringList shown = m_failures.mid(0, MaxReported);
+        if (m_failures.size() > MaxReported)
+            shown.append(QObject::tr("... and %1 more").arg(m_failures.size() - MaxReported));
+        QMessageBox::warning(parent, QObject::tr("Error"),
+                             QObject::tr("Failed to copy:\n%1").arg(shown.join('\n')));
+        m_failures.clear();
+    }
+
+private:
+    struct Dir {
+        QString srcPath;
+        QString dstPath;
+        Dir* parent = nullptr;
+        std::atomic<int> pending{1};  // the walk listing it
+    };
+
+    // A failed or skipped file still counts as done, like endFile() counts
+    // it in the walk, so the bars reach the totals
+    void copyOne(const QString& srcPath, const QString& dstPath, qint64 size) {
+        if (!m_cancel) {
+            if (QFile::copy(srcPath, dstPath)) {
+                finalizeCopiedFile(srcPath, dstPath);
+                m_sync.afterFileCopied(dstPath, size, false);
+                if (m_move)
+                    QFile::remove(srcPath);
+                m_copiedBytes.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+            } else {
+                m_failed = true;
+                QMutexLocker locker(&m_failuresMutex);
+                m_failures.append(srcPath);
+            }
+        }
+        m_doneBytes.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+        m_doneFiles.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // A cancelled copy leaves directories as they are, like the walk does
+    void release(Dir* dir) {
+        while (dir && dir->pending.fetch_sub(1) == 1) {
+            if (!m_cancel)
+                finalizeCopiedFile(dir->srcPath, dir->dstPath);
+            dir = dir->parent;
+        }
+    }
+
+    // GUI thread only
+    void pumpProgress() {
+        const quint64 files = m_doneFiles.load(std::memory_order_relaxed);
+        const quint64 bytes = m_doneBytes.load(std::memory_order_relaxed);
+        const quint64 copied = m_copiedBytes.load(std::memory_order_relaxed);
+        if (files != m_reportedFiles) {
+            m_progress.addFinishedFiles(files - m_reportedFiles, bytes - m_reportedBytes, copied - m_reportedCopied);
+            m_reportedFiles = files;
+            m_reportedBytes = bytes;
+            m_reportedCopied = copied;
+        }
+        m_progress.processEvents();
+        if (m_progress.wasCanceled())
+            cancel();
+    }
+
+    static constexpr int MaxInFlight = 64;
+    static constexpr int PollMs = 20;
+    static constexpr int MaxReported = 20;
+
+    const bool m_move;
+    FileOperationProgressDialog& m_progress;
+    DestSync& m_sync;
+    QThreadPool m_pool;
+    QSemaphore m_slots;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_failed{false};
+    std::atomic<quint64> m_doneFiles{0};
+    std::atomic<quint64> m_doneBytes{0};     // of files done, copied or not
+    std::atomic<quint64> m_copiedBytes{0};   // of files copied
+    quint64 m_reportedFiles = 0;
+    quint64 m_reportedBytes = 0;
+    quint64 m_reportedCopied = 0;
+    std::vector<Dir*> m_stack;                 // directories the walk is in
+    std::deque<std::unique_ptr<Dir>> m_dirs;   // all of them, until the end
+    QMutex m_failuresMutex;
+    QStringList m_failures;
+};
+
+// Keeps CopyPipeline's directory stack in step with the recursive walk,
+// whichever way it returns
+class PipelineDirScope {
+public:
+    PipelineDirScope(CopyPipeline* pipeline, const QString& srcPath, const QString& dstPath)
+        : m_pipeline(pipeline) {
+        if (m_pipeline)
+            m_pipeline->enterDir(srcPath, dstPath);
+    }
+    ~PipelineDirScope() {
+        if (m_pipeline)
+            m_pipeline->leaveDir();
+    }
+
+private:
+    CopyPipeline* m_pipeline;
+};
+
 // Helper: round up size to cluster boundary
 static quint64 roundUpToCluster(quint64 size, quint64 clusterSize) {
     if (clusterSize == 0) return size;
@@ -377,6 +583,193 @@ QMessageBox::StandardButton askOverwriteSingle(QWidget *parent, const QString &n
     return reply;
 }
 
+#ifdef __linux__
+enum class OffloadResult {
+    Done,
+    Unsupported,  // nothing was written, copy through user memory instead
+    Failed,
+    Cancelled
+};
+
+// Copy srcFd to dstFd without the data passing through user memory.
+//
+// A reflink (FICLONE) comes first: on btrfs, XFS, bcachefs and the like the
+// copy shares the source's extents and is done at once whatever the size.
+// Otherwise copy_file_range() copies in the kernel - server-side on NFS 4.2
+// and SMB3, a splice elsewhere - one chunk per call so progress can be
+// reported and the copy cancelled between them. Both write through the
+// descriptors' offsets, so the .part protocol around them is unchanged.
+// With cloneOnly, only the reflink is tried (copy_file_range() goes through
+// the page cache).
+static OffloadResult copyFileOffloaded(int srcFd, int dstFd, qint64 size, qint64 chunkSize, bool useSync,
+                                       bool cloneOnly, FileOperationProgressDialog* progress) {
+    if (::ioctl(dstFd, FICLONE, srcFd) == 0) {
+        if (useSync)
+            fsync(dstFd);
+        if (progress) {
+            progress->addTransferred(size);
+            progress->addFileBytes(size);
+        }
+        return OffloadResult::Done;
+    }
+    if (cloneOnly)
+        return OffloadResult::Unsupported;
+
+    qint64 written = 0;
+    while (written < size) {
+        const ssize_t n = ::copy_file_range(srcFd, nullptr, dstFd, nullptr,
+                                            static_cast<size_t>(qMin(chunkSize, size - written)), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            // Not for this kernel, filesystem pair or file type
+            if (written == 0 && (errno == ENOSYS || errno == EXDEV || errno == EOPNOTSUPP ||
+                                 errno == EINVAL || errno == EBADF || errno == EPERM))
+                return OffloadResult::Unsupported;
+            return OffloadResult::Failed;
+        }
+        if (n == 0) {
+            // Some pseudo filesystems report no data at all; a file that
+            // shrank since its size was taken just ends early
+            if (written == 0)
+                return OffloadResult::Unsupported;
+            break;
+        }
+
+        if (useSync)
+            fsync(dstFd);
+
+        written += n;
+        if (progress) {
+            progress->addTransferred(n);
+            progress->addFileBytes(written);
+            if (progress->wasCanceled())
+                return OffloadResult::Cancelled;
+        } else {
+            QCoreApplication::processEvents();
+        }
+    }
+    return OffloadResult::Done;
+}
+
+// Reader and writer for CopyMode::Direct. The data does not stay in the
+// page cache, where copying a disk image would push out everything else,
+// and durable() counts what has reached the disk, not what sits in dirty
+// pages.
+//
+// O_DIRECT is used where the filesystem takes it, with the pipeline's
+// aligned buffers; the unaligned tail of a file, and filesystems without
+// it, go through the cache but leave it chunk by chunk: writeback of a
+// chunk starts as soon as it is written (sync_file_range) and is waited
+// for one chunk later, then the pages are dropped (posix_fadvise).
+class UncachedCopy {
+public:
+    static constexpr std::size_t Alignment = 4096;  // covers every logical block size in use
+
+    UncachedCopy(int srcFd, int dstFd)
+        : m_srcFd(srcFd)
+        , m_dstFd(dstFd)
+        , m_srcDirect(setDirect(srcFd, true))
+        , m_dstDirect(setDirect(dstFd, true)) {
+        if (!m_srcDirect)
+            ::posix_fadvise(srcFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    // On the pipeline's reader thread
+    std::int64_t read(char* data, std::size_t capacity) {
+        std::size_t filled = 0;
+        while (filled < capacity) {
+            const ssize_t n = ::pread(m_srcFd, data + filled, capacity - filled, m_readOffset + filled);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && errno == EINVAL && m_srcDirect) {
+                // An unaligned offset after a short read; finish through the cache
+                m_srcDirect = false;
+                setDirect(m_srcFd, false);
+                continue;
+            }
+            if (n < 0)
+                return -1;
+            if (n == 0)
+                break;
+            filled += static_cast<std::size_t>(n);
+        }
+        if (!m_srcDirect && filled > 0)
+            ::posix_fadvise(m_srcFd, m_readOffset, static_cast<off_t>(filled), POSIX_FADV_DONTNEED);
+        m_readOffset += static_cast<qint64>(filled);
+        return static_cast<std::int64_t>(filled);
+    }
+
+    // On the pipeline's writer thread
+    bool write(const char* data, std::size_t length) {
+        if (m_dstDirect && length % Alignment != 0) {
+            m_dstDirect = false;    // the tail of the file
+            setDirect(m_dstFd, false);
+        }
+        std::size_t done = 0;
+        while (done < length) {
+            const ssize_t n = ::pwrite(m_dstFd, data + done, length - done, m_writeOffset + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && errno == EINVAL && m_dstDirect) {
+                m_dstDirect = false;
+                setDirect(m_dstFd, false);
+                continue;
+            }
+            if (n < 0)
+                return false;
+            done += static_cast<std::size_t>(n);
+        }
+
+        const qint64 end = m_writeOffset + static_cast<qint64>(length);
+        if (m_dstDirect) {
+            m_writeOffset = end;
+            m_durable.store(end, std::memory_order_relaxed);
+            return true;
+        }
+        ::sync_file_range(m_dstFd, m_writeOffset, static_cast<off_t>(length), SYNC_FILE_RANGE_WRITE);
+        const qint64 from = m_durable.load(std::memory_order_relaxed);
+        if (m_writeOffset > from) {
+            if (::sync_file_range(m_dstFd, from, m_writeOffset - from,
+                                  SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                                  SYNC_FILE_RANGE_WAIT_AFTER) != 0)
+                return false;
+            ::posix_fadvise(m_dstFd, from, m_writeOffset - from, POSIX_FADV_DONTNEED);
+            m_durable.store(m_writeOffset, std::memory_order_relaxed);
+        }
+        m_writeOffset = end;
+        return true;
+    }
+
+    // After the pipeline: the last chunk to disk, the rest out of the cache
+    bool finish() {
+        if (::fdatasync(m_dstFd) != 0)
+            return false;
+        ::posix_fadvise(m_dstFd, 0, 0, POSIX_FADV_DONTNEED);
+        ::posix_fadvise(m_srcFd, 0, 0, POSIX_FADV_DONTNEED);
+        m_durable.store(m_writeOffset, std::memory_order_relaxed);
+        return true;
+    }
+
+    qint64 durable() const { return m_durable.load(std::memory_order_relaxed); }
+
+private:
+    // False if the filesystem does not do direct I/O
+    static bool setDirect(int fd, bool on) {
+        const int flags = ::fcntl(fd, F_GETFL);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, on ? flags | O_DIRECT : flags & ~O_DIRECT) == 0;
+    }
+
+    int m_srcFd;
+    int m_dstFd;
+    bool m_srcDirect;                   // reader thread only
+    bool m_dstDirect;                   // writer thread only
+    qint64 m_readOffset = 0;
+    qint64 m_writeOffset = 0;
+    std::atomic<qint64> m_durable{0};   // read by the polling thread
+};
+#endif
+
 // Copy file in chunks with optional SHA-256 verification and sync per chunk
 // Uses temp file + atomic rename for safety.
 // Reports per-chunk progress to the dialog (top bar) when provided.
@@ -411,60 +804,121 @@ bool copyFileChunked(const QString& srcPath, const QString& dstPath, CopyMode mo
     }
 
     const qint64 chunkSize = Config::instance().copyChunkSize();
-    QByteArray buffer;
     QCryptographicHash srcHash(QCryptographicHash::Sha256);
     bool useSha = (mode == CopyMode::ChunkedSha);
     bool useSync = (mode == CopyMode::ChunkedSync);
+    bool useDirect = (mode == CopyMode::Direct);
     qint64 written = 0;
-
-    while (!srcFile.atEnd()) {
-        buffer = srcFile.read(chunkSize);
-        if (buffer.isEmpty() && !srcFile.atEnd()) {
+    bool copied = false;
+
+#ifdef __linux__
+    // The kernel copies without reading the data into here; verification
+    // needs to read it anyway
+    if (!useSha) {
+        const OffloadResult offload = copyFileOffloaded(srcFile.handle(), tempFile.handle(), srcFile.size(),
+                                                        chunkSize, useSync, useDirect, progress);
+        if (offload == OffloadResult::Failed) {
             QMessageBox::warning(nullptr, QObject::tr("Error"),
-                                 QObject::tr("Failed to read from source file:\n%1").arg(srcPath));
+                                 QObject::tr("Failed to copy to temp file:\n%1").arg(tempPath));
+        }
+        if (offload == OffloadResult::Failed || offload == OffloadResult::Cancelled) {
             tempFile.close();
             tempFile.remove();
             dstFile.close();
             dstFile.remove();
             return false;
         }
+        copied = offload == OffloadResult::Done;
+    }
+#endif
 
+    if (!copied) {
+        // Reading the next chunk overlaps writing (and hashing) the previous ones
+        ChunkPipeline::Options options;
+        options.chunkSize = static_cast<std::size_t>(chunkSize);
+#ifdef __linux__
+        options.alignment = UncachedCopy::Alignment;
+#endif
+        ChunkPipeline pipeline(options);
+
+        ChunkPipeline::Reader reader = [&](char* data, std::size_t capacity) -> std::int64_t {
+            return srcFile.read(data, static_cast<qint64>(capacity));
+        };
+        ChunkPipeline::Hasher hasher;
         if (useSha)
-            srcHash.addData(buffer);
+            hasher = [&](const char* data, std::size_t length) {
+                srcHash.addData(QByteArrayView(data, static_cast<qsizetype>(length)));
+            };
+        ChunkPipeline::Writer writer = [&](const char* data, std::size_t length) {
+            if (tempFile.write(data, static_cast<qint64>(length)) != static_cast<qint64>(length))
+                return false;
+            if (useSync) {
+                tempFile.flush();
+#ifdef _WIN32
+                FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(tempFile.handle())));
+#else
+                fsync(tempFile.handle());
+#endif
+            }
+            return true;
+        };
+
+#ifdef __linux__
+        std::unique_ptr<UncachedCopy> uncached;
+        if (useDirect) {
+            uncached = std::make_unique<UncachedCopy>(srcFile.handle(), tempFile.handle());
+            reader = [&](char* data, std::size_t capacity) { return uncached->read(data, capacity); };
+            writer = [&](const char* data, std::size_t length) { return uncached->write(data, length); };
+        }
+        auto onDisk = [&](std::uint64_t total) {
+            return uncached ? uncached->durable() : static_cast<qint64>(total);
+        };
+#else
+        // Elsewhere the mode copies like Chunked
+        Q_UNUSED(useDirect);
+        auto onDisk = [](std::uint64_t total) { return static_cast<qint64>(total); };
+#endif
 
-        if (tempFile.write(buffer) != buffer.size()) {
+        // Progress shows what is on the disk when the copy knows it
+        auto report = [&](qint64 total) {
+            if (!progress) {
+                QCoreApplication::processEvents();
+                return true;
+            }
+            if (total > written) {
+                progress->addTransferred(total - written);
+                written = total;
+                progress->addFileBytes(written);
+            }
+            // Also while a write stalls, so Cancel stays clickable
+            progress->processEvents();
+            return !progress->wasCanceled();
+        };
+        auto poll = [&](std::uint64_t total) { return report(onDisk(total)); };
+
+        ChunkPipeline::Result result = pipeline.run(reader, hasher, writer, poll);
+#ifdef __linux__
+        if (result == ChunkPipeline::Result::Done && uncached) {
+            if (uncached->finish())
+                report(uncached->durable());
+            else
+                result = ChunkPipeline::Result::WriteFailed;
+        }
+#endif
+        if (result == ChunkPipeline::Result::ReadFailed) {
+            QMessageBox::warning(nullptr, QObject::tr("Error"),
+                                 QObject::tr("Failed to read from source file:\n%1").arg(srcPath));
+        } else if (result == ChunkPipeline::Result::WriteFailed) {
             QMessageBox::warning(nullptr, QObject::tr("Error"),
                                  QObject::tr("Failed to write to temp file:\n%1").arg(tempPath));
+        }
+        if (result != ChunkPipeline::Result::Done) {
             tempFile.close();
             tempFile.remove();
             dstFile.close();
             dstFile.remove();
             return false;
         }
-
-        if (useSync) {
-            tempFile.flush();
-#ifdef _WIN32
-            FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(tempFile.handle())));
-#else
-            fsync(tempFile.handle());
-#endif
-        }
-
-        written += buffer.size();
-        if (progress) {
-            progress->addTransferred(buffer.size());
-            progress->addFileBytes(written);
-            if (progress->wasCanceled()) {
-                tempFile.close();
-                tempFile.remove();
-                dstFile.close();
-                dstFile.remove();
-                return false;
-            }
-        } else {
-            QCoreApplication::processEvents();
-        }
     }
 
     srcFile.close();
@@ -493,9 +947,10 @@ bool copyFileChunked(const QString& srcPath, const QString& dstPath, CopyMode mo
         }
 
         QCryptographicHash dstHash(QCryptographicHash::Sha256);
-        while (!dstCheck.atEnd()) {
-            buffer = dstCheck.read(chunkSize);
-            dstHash.addData(buffer);
+        QByteArray buffer(chunkSize, Qt::Uninitialized);
+        qint64 n;
+        while ((n = dstCheck.read(buffer.data(), chunkSize)) > 0) {
+            dstHash.addData(QByteArrayView(buffer.constData(), n));
             QCoreApplication::processEvents();
         }
         dstCheck.close();
@@ -664,7 +1119,8 @@ void collectCopyStats(const QString &srcPath, CopyStats &stats, bool &ok, bool *
 
 QMessageBox::Button copyOrMoveDirectoryRecursive(const QString &srcRoot, const QString &dstRoot, bool move,
                                                  bool sameFs, QMessageBox::Button askPolice, CopyStats &stats,
-                                                 FileOperationProgressDialog &progress, DestSync &sync) {
+                                                 FileOperationProgressDialog &progress, DestSync &sync,
+                                                 CopyPipeline *pipeline) {
     if (askPolice == QMessageBox::Abort)
         return QMessageBox::Abort;
 
@@ -679,6 +1135,15 @@ QMessageBox::Button copyOrMoveDirectoryRecursive(const QString &srcRoot, const Q
         return askPolice;
     }
 
+    // With a pipeline, this directory is finalized by it once all the
+    // files handed to it are done
+    PipelineDirScope pipelineDir(pipeline, srcRoot, dstRoot);
+    auto abort = [pipeline]() {
+        if (pipeline)
+            pipeline->cancel();  // before the scope releases the directory unfinished
+        return QMessageBox::Abort;
+    };
+
     QDir dir(srcRoot);
 
     // Get all entries including symlinks (System flag includes symlinks on Unix)
@@ -688,7 +1153,7 @@ QMessageBox::Button copyOrMoveDirectoryRecursive(const QString &srcRoot, const Q
 
     for (const QFileInfo &fi: entries) {
         if (progress.wasCanceled())
-            return QMessageBox::Abort;
+            return abort();
 
         const QString srcPath = fi.absoluteFilePath();
         const QString dstPath = QDir(dstRoot).filePath(fi.fileName());
@@ -708,23 +1173,27 @@ QMessageBox::Button copyOrMoveDirectoryRecursive(const QString &srcRoot, const Q
             continue;
         }
 
-        // Handle regular files
-        if (fi.isFile()) {
+        // Handle regular files: small new ones in parallel, the rest here
+        if (fi.isFile() && pipeline && pipeline->accepts(fi.size()) && !QFileInfo::exists(dstPath)) {
+            pipeline->submit(srcPath, dstPath, fi.size());
+        } else if (fi.isFile()) {
             progress.beginFile(fi.fileName(), fi.size());
             askPolice = copyOrMoveFileAskOverwrite(srcPath, dstPath, move, true, askPolice, &progress, &progress, &sync);
             progress.endFile();
 
             if (askPolice == QMessageBox::Abort)
-                return QMessageBox::Abort;
+                return abort();
         }
         // Handle directories (recursive)
         else if (fi.isDir()) {
-            askPolice = copyOrMoveDirectoryRecursive(srcPath, dstPath, move, sameFs, askPolice, stats, progress, sync);
+            askPolice = copyOrMoveDirectoryRecursive(srcPath, dstPath, move, sameFs, askPolice, stats, progress, sync,
+                                                     pipeline);
 
             if (askPolice == QMessageBox::Abort)
-                return QMessageBox::Abort;
+                return abort();
             // Carry source directory metadata (times, permissions) to the copy.
-            finalizeCopiedFile(srcPath, dstPath);
+            if (!pipeline)
+                finalizeCopiedFile(srcPath, dstPath);
         }
     }
     return askPolice;
@@ -863,6 +1332,10 @@ QString executeCopyOrMove(const QString &currentPath, const QStringList &names,
     // Linux). Its destructor performs the final flush even on early return.
     DestSync destSync(dstPath);
 
+    // Small files in directories are copied on worker threads; declared
+    // after destSync so it is drained before the final flush
+    CopyPipeline pipeline(move, progressDlg, destSync);
+
     QMessageBox::Button askPolice = QMessageBox::Yes;
     for (const QString &name: names) {
         QString srcPath = srcDir.absoluteFilePath(name);
@@ -956,12 +1429,17 @@ QString executeCopyOrMove(const QString &currentPath, const QStringList &names,
         }
         else if (srcInfo.isDir()) {
             askPolice = copyOrMoveDirectoryRecursive(srcPath, dstFilePath, move,
-                                             sameFs, askPolice, stats, progressDlg, destSync);
-            if (askPolice != QMessageBox::Abort) {
+                                             sameFs, askPolice, stats, progressDlg, destSync, &pipeline);
+            if (askPolice == QMessageBox::Abort)
+                pipeline.cancel();
+            // The source must stay until the copiers are done with it
+            pipeline.drain();
+            if (askPolice != QMessageBox::Abort && !progressDlg.wasCanceled()) {
                 // Carry source directory metadata (times, permissions) to the copy
                 // while the source still exists, then drop the source if moving.
                 finalizeCopiedFile(srcPath, dstFilePath);
-                if (move && (askPolice == QMessageBox::Yes || askPolice == QMessageBox::YesToAll))
+                if (move && !pipeline.hadFailures() &&
+                    (askPolice == QMessageBox::Yes || askPolice == QMessageBox::YesToAll))
                     QDir(srcPath).removeRecursively();
             }
         }
@@ -969,6 +1447,9 @@ QString executeCopyOrMove(const QString &currentPath, const QStringList &names,
             break;
     }
 
+    pipeline.drain();
+    pipeline.reportFailures(parent);
+
     // Show info message if symlinks were skipped
     if (stats.symlinks > 0) {
         QMessageBox::information(parent, QObject::tr("Symbolic Links Skipped"),
@@ -12,7 +12,8 @@ class FileOperationProgressDialog;
 
 namespace FileOperations {
 
-class DestSync;  // defined in FileOperations.cpp
+class DestSync;      // defined in FileOperations.cpp
+class CopyPipeline;  // defined in FileOperations.cpp
 
 struct Params {
     bool valid = false;
@@ -66,10 +67,13 @@ void countCopyWork(const QString& basePath, const QStringList& names,
 
 // Copy directory recursively with byte-proportional progress tracking.
 // stats.symlinks is updated if symlinks are skipped (cross-FS).
+// With a pipeline, small files are copied by its workers and directories
+// finalized by it; the caller drains it before relying on the copy.
 QMessageBox::Button copyOrMoveDirectoryRecursive(const QString& srcRoot, const QString& dstRoot,
                             bool move, bool sameFs,
                             QMessageBox::Button askPolice, CopyStats& stats,
-                            FileOperationProgressDialog& progress, DestSync& sync);
+                            FileOperationProgressDialog& progress, DestSync& sync,
+                            CopyPipeline* pipeline = nullptr);
 
 // Check if target is invalid (same path or subdirectory of source)
 bool isInvalidCopyMoveTarget(const QString& srcPath, const QString& dstPath);
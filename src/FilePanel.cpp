@@ -37,6 +37,7 @@
 #include <QDateTime>
 #include <QMimeDatabase>
 #include "FileOperations.h"
+#include "NameMask.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -428,6 +429,14 @@ void FilePanelModel::refreshRow(int row) {
     emit dataChanged(index(row, 0), index(row, columnCount() - 1));
 }
 
+void FilePanelModel::refreshRows(int first, int last) {
+    first = std::max(first, 0);
+    last = std::min(last, rowCount() - 1);
+    if (first > last)
+        return;
+    emit dataChanged(index(first, 0), index(last, columnCount() - 1));
+}
+
 void FilePanel::sortEntries() {
     // --------------------------
     // Sorting (TC-like)
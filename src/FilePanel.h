@@ -86,6 +86,9 @@ public:
     // Call after marking/unmarking single row
     void refreshRow(int row);
 
+    // Call after marking/unmarking many rows: one dataChanged for the range
+    void refreshRows(int first, int last);
+
     // Helper: convert model row to entry index (-1 if [..] row)
     int rowToEntryIndex(int row) const;
 
@@ -0,0 +1,239 @@
+#include "FuzzyFinderDialog.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLocale>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <mutex>
+
+#include "keys/ObjectRegistry.h"
+#include "search/ParallelWalker.h"
+
+FuzzyFinderDialog::FuzzyFinderDialog(QWidget* parent)
+    : QDialog(parent)
+    , m_scanWatcher(new QFutureWatcher<CandidateList>(this))
+{
+    ObjectRegistry::add(this, "FuzzyFinder");
+    setWindowTitle(tr("Go to File"));
+    resize(700, 450);
+
+    auto* layout = new QVBoxLayout(this);
+
+    m_queryEdit = new QLineEdit(this);
+    m_queryEdit->setPlaceholderText(tr("Type parts of the path, e.g. fpwcpp for FilePaneWidget.cpp"));
+    m_queryEdit->setClearButtonEnabled(true);
+    layout->addWidget(m_queryEdit);
+
+    m_list = new QListWidget(this);
+    m_list->setUniformItemSizes(true);   // no per-item size hints with hundreds of rows
+    m_list->setFocusPolicy(Qt::NoFocus);
+    layout->addWidget(m_list, 1);
+
+    m_statusLabel = new QLabel(this);
+    layout->addWidget(m_statusLabel);
+
+    connect(m_queryEdit, &QLineEdit::textChanged, this, &FuzzyFinderDialog::updateResults);
+    connect(m_queryEdit, &QLineEdit::returnPressed, this, &FuzzyFinderDialog::activateCurrent);
+    connect(m_list, &QListWidget::itemActivated, this, &FuzzyFinderDialog::activateCurrent);
+    connect(m_scanWatcher, &QFutureWatcher<CandidateList>::finished, this, &FuzzyFinderDialog::onScanFinished);
+}
+
+FuzzyFinderDialog::~FuzzyFinderDialog()
+{
+    cancelScan();
+}
+
+void FuzzyFinderDialog::setRoot(const QString& root)
+{
+    m_queryEdit->selectAll();
+    m_queryEdit->setFocus();
+
+    if (root == m_root && (m_candidates || m_scanWatcher->isRunning()) &&
+        (!m_candidates || m_scannedAt.elapsed() < CacheMaxAgeMs))
+        return;
+
+    if (root != m_root) {
+        m_root = root;
+        m_candidates.reset();
+        m_lastQuery.clear();
+        m_lastMatched.clear();
+        m_list->clear();
+    }
+    startScan();
+}
+
+// The tree is read in the background; the previous list of the same root,
+// if any, stays usable until the new one is ready.
+void FuzzyFinderDialog::startScan()
+{
+    cancelScan();
+    m_scanCancel = std::make_shared<std::atomic<bool>>(false);
+    m_statusLabel->setText(tr("Reading %1 ...").arg(m_root));
+    m_scanWatcher->setFuture(QtConcurrent::run([root = m_root, cancel = m_scanCancel]() {
+        return scanTree(root, cancel.get());
+    }));
+}
+
+void FuzzyFinderDialog::cancelScan()
+{
+    if (!m_scanWatcher->isRunning())
+        return;
+    *m_scanCancel = true;
+    m_scanWatcher->waitForFinished();
+}
+
+void FuzzyFinderDialog::onScanFinished()
+{
+    if (m_scanCancel && *m_scanCancel)
+        return;
+    m_candidates = m_scanWatcher->result();
+    m_scannedAt.start();
+    m_lastQuery.clear();
+    m_lastMatched.clear();
+    updateResults();
+}
+
+// Paths are stored relative to the root and as encoded on disk, so the
+// query is matched on the same bytes (see QFile::encodeName()).
+FuzzyFinderDialog::CandidateList FuzzyFinderDialog::scanTree(const QString& root, const std::atomic<bool>* cancel)
+{
+    std::string rootPath = QFile::encodeName(root).toStdString();
+    while (rootPath.size() > 1 && rootPath.back() == '/')
+        rootPath.pop_back();
+    const std::size_t prefix = rootPath == "/" ? 1 : rootPath.size() + 1;
+
+    auto candidates = std::make_shared<search::FuzzyCandidates>();
+    std::mutex mutex;
+
+    search::WalkOptions options;
+    options.cancel = cancel;
+    options.ignoreFiles = true;
+    options.oneFileSystem = true;
+    search::ParallelWalker walker(options);
+    walker.run(rootPath, [&](const search::WalkEntry& entry) {
+        const std::string path = entry.path();
+        std::lock_guard<std::mutex> lock(mutex);
+        candidates->add(std::string_view(path).substr(prefix));
+        return search::VisitResult::Continue;
+    });
+    return candidates;
+}
+
+void FuzzyFinderDialog::updateResults()
+{
+    m_list->clear();
+    if (!m_candidates)
+        return;
+
+    const QByteArray query = QFile::encodeName(m_queryEdit->text().trimmed());
+    const QString total = QLocale().toString(static_cast<qulonglong>(m_candidates->size()));
+    auto addRow = [this](std::uint32_t index) {
+        const std::string_view path = m_candidates->at(index);
+        m_list->addItem(QFile::decodeName(QByteArray(path.data(), static_cast<int>(path.size()))));
+    };
+
+    if (query.isEmpty()) {
+        const std::size_t shown = std::min<std::size_t>(MaxShown, m_candidates->size());
+        for (std::size_t i = 0; i < shown; ++i)
+            addRow(static_cast<std::uint32_t>(i));
+        m_lastQuery.clear();
+        m_lastMatched.clear();
+        m_statusLabel->setText(tr("%1 entries").arg(total));
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+
+        // A longer query matches a subset of what the shorter one did
+        const bool narrow = !m_lastQuery.isEmpty() && query.startsWith(m_lastQuery);
+        const search::FuzzyMatcher matcher(std::string_view(query.constData(), static_cast<std::size_t>(query.size())));
+        search::FuzzyResults results =
+            search::fuzzyFind(*m_candidates, matcher, MaxShown, narrow ? &m_lastMatched : nullptr);
+        for (const search::FuzzyHit& hit : results.best)
+            addRow(hit.index);
+        m_lastQuery = query;
+        m_lastMatched = std::move(results.matched);
+
+        m_statusLabel->setText(tr("%1 of %2 match (%3 ms)")
+                                   .arg(QLocale().toString(static_cast<qulonglong>(m_lastMatched.size())), total)
+                                   .arg(timer.elapsed()));
+    }
+
+    if (m_scanWatcher->isRunning())
+        m_statusLabel->setText(m_statusLabel->text() + tr(" - rereading ..."));
+    if (m_list->count() > 0)
+        m_list->setCurrentRow(0);
+}
+
+void FuzzyFinderDialog::moveSelection(int delta)
+{
+    if (m_list->count() == 0)
+        return;
+    const int row = qBound(0, m_list->currentRow() + delta, m_list->count() - 1);
+    m_list->setCurrentRow(row);
+}
+
+void FuzzyFinderDialog::activateCurrent()
+{
+    const QListWidgetItem* item = m_list->currentItem();
+    if (!item)
+        return;
+    const QString rootPrefix = m_root.endsWith('/') ? m_root : m_root + '/';
+    const QFileInfo info(rootPrefix + item->text());
+    hide();
+    emit requestGoToFile(info.absolutePath(), info.fileName());
+}
+
+bool FuzzyFinderDialog::doNextHit(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    moveSelection(1);
+    return true;
+}
+
+bool FuzzyFinderDialog::doPrevHit(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    moveSelection(-1);
+    return true;
+}
+
+bool FuzzyFinderDialog::doNextHitPage(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    moveSelection(qMax(1, m_list->viewport()->height() / qMax(1, m_list->sizeHintForRow(0))));
+    return true;
+}
+
+bool FuzzyFinderDialog::doPrevHitPage(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    moveSelection(-qMax(1, m_list->viewport()->height() / qMax(1, m_list->sizeHintForRow(0))));
+    return true;
+}
+
+bool FuzzyFinderDialog::doGoToHit(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    activateCurrent();
+    return true;
+}
+
+bool FuzzyFinderDialog::doRescan(QObject* obj, QKeyEvent* keyEvent)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(keyEvent);
+    startScan();
+    updateResults();
+    return true;
+}
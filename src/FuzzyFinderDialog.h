@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "search/FuzzyMatcher.h"
+
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QKeyEvent;
+
+// "Go to file" popup: fuzzy-matches what is typed against every path below
+// the panel's directory and lists the best hits as you type.
+//
+// The paths are collected once with search::ParallelWalker (honoring ignore
+// files, staying on one filesystem) and cached for the directory; the cache
+// is reused while it is younger than CacheMaxAgeMs, and Ctrl+R rereads it.
+// Each keystroke re-scores the paths on all cores (search::fuzzyFind); when
+// the query only got longer, just the previous matches are re-scored.
+class FuzzyFinderDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit FuzzyFinderDialog(QWidget* parent = nullptr);
+    ~FuzzyFinderDialog();
+
+    // Search below `root`; rereads the tree unless a fresh enough list of it is cached.
+    void setRoot(const QString& root);
+
+    Q_INVOKABLE bool doNextHit(QObject* obj, QKeyEvent* keyEvent);
+    Q_INVOKABLE bool doPrevHit(QObject* obj, QKeyEvent* keyEvent);
+    Q_INVOKABLE bool doNextHitPage(QObject* obj, QKeyEvent* keyEvent);
+    Q_INVOKABLE bool doPrevHitPage(QObject* obj, QKeyEvent* keyEvent);
+    Q_INVOKABLE bool doGoToHit(QObject* obj, QKeyEvent* keyEvent);
+    Q_INVOKABLE bool doRescan(QObject* obj, QKeyEvent* keyEvent);
+
+signals:
+    void requestGoToFile(const QString& dir, const QString& name);
+
+private:
+    using CandidateList = std::shared_ptr<const search::FuzzyCandidates>;
+
+    void startScan();
+    void cancelScan();
+    void onScanFinished();
+    void updateResults();
+    void moveSelection(int delta);
+    void activateCurrent();
+
+    static CandidateList scanTree(const QString& root, const std::atomic<bool>* cancel);
+
+    QLineEdit* m_queryEdit;
+    QListWidget* m_list;
+    QLabel* m_statusLabel;
+
+    QString m_root;
+    CandidateList m_candidates;                       // paths below m_root, relative to it
+    QElapsedTimer m_scannedAt;
+    QFutureWatcher<CandidateList>* m_scanWatcher;
+    std::shared_ptr<std::atomic<bool>> m_scanCancel;  // of the running scan
+
+    QByteArray m_lastQuery;                           // what m_lastMatched was computed for
+    std::vector<std::uint32_t> m_lastMatched;
+
+    static constexpr int MaxShown = 200;
+    static constexpr qint64 CacheMaxAgeMs = 5 * 60 * 1000;
+};
@@ -2,6 +2,7 @@
 
 #include "Config.h"
 #include "ConfigDialog.h"
+#include "NameIndexService.h"
 #include "FilePaneWidget.h"
 #include "FilePanel.h"
 #include <mrutabwidget.h>
@@ -43,6 +44,9 @@
 
 #include "SortedDirIterator.h"
 #include "SearchDialog.h"
+#include "FuzzyFinderDialog.h"
+#include "DuplicatesDialog.h"
+#include "DiskReportDialog.h"
 #include "DistroInfo.h"
 #include "DistroInfoDialog.h"
 #include "FunctionBar.h"
@@ -66,6 +70,7 @@ MainWindow::MainWindow(QWidget *parent)
     QString cfg = Config::instance().defaultConfigPath();
     Config::instance().load(cfg);
     Config::instance().setConfigPath(cfg);
+    NameIndexService::instance().applyConfig();
 
 #ifndef _WIN32
     // First-run: populate compare tools list by scanning standard binary dirs
@@ -449,6 +454,7 @@ void MainWindow::onConfigSaved()
 {
     // Reload config from file
     Config::instance().load(Config::instance().configPath());
+    NameIndexService::instance().applyConfig();
 
     // Apply window geometry (not startup, so skip resize on Wayland)
     // NOTE: On Wayland, the compositor may block programmatic window enlargement
@@ -760,6 +766,27 @@ void MainWindow::setupUi() {
     });
     commandsMenu->addAction(m_searchAction);
 
+    // Commands menu - Go to file (Alt+Shift+F7 managed by KeyRouter/TOML)
+    QAction* fuzzyFindAction = new QAction(tr("Go to file..."), this);
+    connect(fuzzyFindAction, &QAction::triggered, this, [this]() {
+        doFuzzyFind(nullptr, nullptr);
+    });
+    commandsMenu->addAction(fuzzyFindAction);
+
+    // Commands menu - Find duplicates (Alt+Shift+F2 managed by KeyRouter/TOML)
+    QAction* findDuplicatesAction = new QAction(tr("Find duplicates..."), this);
+    connect(findDuplicatesAction, &QAction::triggered, this, [this]() {
+        doFindDuplicates(nullptr, nullptr);
+    });
+    commandsMenu->addAction(findDuplicatesAction);
+
+    // Commands menu - Disk usage report (Alt+Shift+F8 managed by KeyRouter/TOML)
+    QAction* diskReportAction = new QAction(tr("Disk usage report..."), this);
+    connect(diskReportAction, &QAction::triggered, this, [this]() {
+        doDiskReport(nullptr, nullptr);
+    });
+    commandsMenu->addAction(diskReportAction);
+
     // Commands menu - Run Terminal (F9 shortcut managed by KeyRouter/TOML)
     QAction* runTerminalAction = new QAction(tr("Run Terminal"), this);
     runTerminalAction->setIcon(QIcon(":/icons/terminal.svg"));
@@ -2252,14 +2279,48 @@ void MainWindow::openViewerForFile(const QString& filePath) {
     viewerFrame->activateWindow();
 }
 
+// Hex view with the cursor on `offset`, e.g. where a byte pattern matched
+void MainWindow::openViewerAtOffset(const QString& filePath, qint64 offset) {
+    QFileInfo info(filePath);
+    if (!info.isFile())
+        return;
+
+    if (!viewerFrame)
+        viewerFrame = new ViewerFrame(filePath, this);
+    viewerFrame->openFileAt(filePath, offset);
+    viewerFrame->show();
+    viewerFrame->raise();
+    viewerFrame->activateWindow();
+}
+
 void MainWindow::goToFile(const QString& dir, const QString& name) {
     FilePanel* panel = currentFilePanel();
     if (!panel)
         return;
 
     QDir targetDir(dir);
-    if (!targetDir.exists())
+    if (!targetDir.exists()) {
+        // Archive member found by search: "archive.zip/inner/dir" - open the
+        // archive in the panel and go to the member's directory inside it
+        QString archivePath = dir;
+        while (!QFileInfo(archivePath).isFile()) {
+            const int slash = archivePath.lastIndexOf('/');
+            if (slash <= 0)
+                return;
+            archivePath.truncate(slash);
+        }
+        const QFileInfo archiveInfo(archivePath);
+        panel->currentPath = archiveInfo.absolutePath();
+        panel->loadDirectory();
+        panel->enterArchive(archivePath);
+        if (!panel->insideArchive)
+            return;
+        panel->archiveCurrentDir = dir.mid(archivePath.size() + 1);
+        panel->loadArchiveDirectory();
+        panel->selectEntryByName(name);
+        panel->setFocus();
         return;
+    }
 
     panel->currentPath = targetDir.absolutePath();
     panel->loadDirectory();
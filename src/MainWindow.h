@@ -24,6 +24,9 @@ class FunctionBar;
 class ViewerFrame;
 class FilePanel;
 class SearchDialog;
+class FuzzyFinderDialog;
+class DuplicatesDialog;
+class DiskReportDialog;
 class MruTabWidget;
 QT_BEGIN_NAMESPACE
 class QSplitter;
@@ -59,6 +62,9 @@ private:
     EditorFrame *editorFrame = nullptr;
     QPointer<ViewerFrame> viewerFrame;
     SearchDialog* m_searchDialog = nullptr;
+    FuzzyFinderDialog* m_fuzzyFinder = nullptr;
+    DuplicatesDialog* m_duplicatesDialog = nullptr;
+    DiskReportDialog* m_diskReportDialog = nullptr;
     int numberForWidget(QTableView* widget);
     void showFavoriteDirsMenu(Side side, const QPoint& pos = QPoint());
 
@@ -100,6 +106,7 @@ private:
     // Methods for opening editor/viewer with specific file
     void openEditorForFile(const QString& filePath);
     void openViewerForFile(const QString& filePath);
+    void openViewerAtOffset(const QString& filePath, qint64 offset);
     void goToFile(const QString& dir, const QString& name);
 
     void applyConfigGeometry(bool isStartup = true);
@@ -0,0 +1,693 @@
+#include "NameIndexService.h"
+#include "Config.h"
+#include "search/NameIndex.h"
+#include "search/TrigramIndex.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMutexLocker>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Re-read directories are folded into a fresh index file once there are this many
+constexpr std::size_t CompactThreshold = 4096;
+// Re-read files are folded into a fresh content index once there are this many
+constexpr std::size_t ContentCompactThreshold = 16384;
+constexpr int RefreshDelayMs = 300;
+constexpr int RecheckIntervalMs = 60 * 1000;
+constexpr int WatchBatchSize = 4096;
+
+QString normalizedPath(const QString& path)
+{
+    return QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+}
+
+QString indexFileName(const QString& root, const QString& suffix)
+{
+    const QByteArray hash = QCryptographicHash::hash(root.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QString::fromLatin1(hash.left(16)) + suffix;
+}
+
+std::string toNative(const QString& path)
+{
+    return QFile::encodeName(path).toStdString();
+}
+
+QString fromNative(const std::string& path)
+{
+    return QFile::decodeName(QByteArray::fromStdString(path));
+}
+
+QString absolutePath(const QString& root, const QString& relPath)
+{
+    if (relPath.isEmpty())
+        return root;
+    return root.endsWith('/') ? root + relPath : root + '/' + relPath;
+}
+
+// True if `path` lies in the tree of `root` (both cleaned); `relPath` gets the rest.
+bool isInside(const QString& path, const QString& root, QString* relPath)
+{
+    if (path == root) {
+        relPath->clear();
+        return true;
+    }
+    const QString prefix = root.endsWith('/') ? root : root + '/';
+    if (!path.startsWith(prefix))
+        return false;
+    *relPath = path.mid(prefix.size());
+    return true;
+}
+
+} // anonymous namespace
+
+NameIndexService& NameIndexService::instance()
+{
+    // Owned by the application object, so it goes away with the event loop
+    static NameIndexService* instance = new NameIndexService();
+    return *instance;
+}
+
+NameIndexService::NameIndexService()
+    : QObject(QCoreApplication::instance())
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_refreshTimer(new QTimer(this))
+    , m_recheckTimer(new QTimer(this))
+{
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &NameIndexService::onDirectoryChanged);
+
+    // Bursts of changes (unpacking an archive, a build) are collected into one refresh
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(RefreshDelayMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &NameIndexService::refreshDirtyRoots);
+
+    m_recheckTimer->setInterval(RecheckIntervalMs);
+    connect(m_recheckTimer, &QTimer::timeout, this, &NameIndexService::recheckUnwatchedRoots);
+    m_recheckTimer->start();
+
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &NameIndexService::shutdown);
+
+#ifdef Q_OS_LINUX
+    m_writeWatchFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_writeWatchFd >= 0) {
+        m_writeNotifier = new QSocketNotifier(m_writeWatchFd, QSocketNotifier::Read, this);
+        connect(m_writeNotifier, &QSocketNotifier::activated, this, &NameIndexService::readWriteEvents);
+    }
+#endif
+}
+
+QString NameIndexService::defaultIndexDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/name-index";
+}
+
+void NameIndexService::applyConfig()
+{
+    const Config& cfg = Config::instance();
+    const QDir indexDir(cfg.indexDirectory().isEmpty() ? defaultIndexDirectory() : cfg.indexDirectory());
+
+    QSet<QString> wanted;
+    for (const QString& root : cfg.indexRoots()) {
+        if (!root.trimmed().isEmpty())
+            wanted.insert(normalizedPath(root.trimmed()));
+    }
+
+    for (auto it = m_roots.begin(); it != m_roots.end();) {
+        if (wanted.contains(it.key()) && it->indexFile == indexDir.filePath(indexFileName(it.key(), ".idx"))) {
+            ++it;
+            continue;
+        }
+        // A task still running for this root finds it gone and drops its result
+        dropContent(it.key());
+        unwatch(it.key());
+        publish(it.key(), nullptr);
+        it = m_roots.erase(it);
+    }
+
+    if (cfg.indexContents() != m_indexContents) {
+        m_indexContents = cfg.indexContents();
+        for (auto it = m_roots.begin(); it != m_roots.end(); ++it) {
+            if (!m_indexContents)
+                dropContent(it.key());
+            else if (it->live && !it->contentBusy)
+                startContentLoad(it.key(), false);
+        }
+    }
+
+    if (!wanted.isEmpty() && !indexDir.mkpath(".")) {
+        qWarning() << "Cannot create filename index directory" << indexDir.path();
+        return;
+    }
+
+    for (const QString& root : wanted) {
+        if (m_roots.contains(root))
+            continue;
+        IndexedRoot indexed;
+        indexed.path = root;
+        indexed.indexFile = indexDir.filePath(indexFileName(root, ".idx"));
+        indexed.contentFile = indexDir.filePath(indexFileName(root, ".content.idx"));
+        m_roots.insert(root, indexed);
+        startLoad(root, false);
+    }
+}
+
+std::shared_ptr<search::LiveNameIndex> NameIndexService::indexFor(const QString& path, std::string* relPath) const
+{
+    const QString cleaned = normalizedPath(path);
+
+    QMutexLocker locker(&m_readyMutex);
+    std::shared_ptr<search::LiveNameIndex> best;
+    QString bestRoot;
+    QString bestRel;
+    for (const auto& ready : m_ready) {
+        QString rel;
+        // Nested roots: the innermost index is the smallest one to query
+        if (ready.first.size() > bestRoot.size() && isInside(cleaned, ready.first, &rel)) {
+            best = ready.second;
+            bestRoot = ready.first;
+            bestRel = rel;
+        }
+    }
+    if (best && relPath)
+        *relPath = toNative(bestRel);
+    return best;
+}
+
+std::shared_ptr<search::LiveTrigramIndex> NameIndexService::contentIndex(const std::string& root) const
+{
+    QMutexLocker locker(&m_readyMutex);
+    for (const auto& ready : m_readyContent) {
+        if (ready.first == root)
+            return ready.second;
+    }
+    return nullptr;
+}
+
+void NameIndexService::startLoad(const QString& root, bool rebuild)
+{
+    IndexedRoot& indexed = m_roots[root];
+    indexed.busy = true;
+
+    const std::string rootPath = toNative(root);
+    const std::string indexFile = toNative(indexed.indexFile);
+    std::shared_ptr<search::LiveNameIndex> live = indexed.live;
+
+    runTask([this, root, rootPath, indexFile, live, rebuild]() mutable {
+        std::shared_ptr<const search::NameIndex> base;
+        if (!rebuild) {
+            base = search::NameIndex::open(indexFile);
+            if (base && base->root() != rootPath)
+                base = nullptr;
+        }
+        if (!base && search::NameIndex::build(rootPath, indexFile, 0, &m_cancel))
+            base = search::NameIndex::open(indexFile);
+
+        std::vector<std::string> directories;
+        if (base) {
+            if (live)
+                live->reset(base);
+            else
+                live = std::make_shared<search::LiveNameIndex>(base);
+
+            // Catch up with whatever changed while the application was not
+            // running, or while the build was walking the tree
+            for (const std::string& dir : base->changedDirectories(&m_cancel)) {
+                if (m_cancel.load())
+                    return;
+                live->refreshDirectory(dir);
+            }
+            directories = live->directories();
+        } else {
+            live.reset();
+        }
+        if (m_cancel.load())
+            return;
+
+        QMetaObject::invokeMethod(this, [this, root, live, directories]() {
+            onLoaded(root, live, directories);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void NameIndexService::onLoaded(const QString& root, std::shared_ptr<search::LiveNameIndex> live,
+                                const std::vector<std::string>& directories)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end())
+        return;
+    it->busy = false;
+    if (!live) {
+        qWarning() << "Cannot build filename index of" << root;
+        return;
+    }
+
+    it->live = live;
+    publish(root, live);
+    watch(root, directories);
+    emit indexReady(root);
+
+    if (m_indexContents && !it->content && !it->contentBusy)
+        startContentLoad(root, false);
+    if (!it->dirty.isEmpty())
+        m_refreshTimer->start();
+}
+
+void NameIndexService::startRefresh(const QString& root, const QStringList& dirs, bool recheck)
+{
+    IndexedRoot& indexed = m_roots[root];
+    indexed.busy = true;
+
+    std::vector<std::string> relPaths;
+    for (const QString& dir : dirs)
+        relPaths.push_back(toNative(dir));
+    std::shared_ptr<search::LiveNameIndex> live = indexed.live;
+
+    runTask([this, root, live, relPaths, recheck]() mutable {
+        if (recheck)
+            relPaths = live->base()->changedDirectories(&m_cancel);
+
+        std::vector<std::string> read;
+        for (const std::string& relPath : relPaths) {
+            if (m_cancel.load())
+                return;
+            std::vector<std::string> dirs = live->refreshDirectory(relPath);
+            read.insert(read.end(), dirs.begin(), dirs.end());
+        }
+        const bool compact = live->overrideCount() > CompactThreshold;
+
+        QMetaObject::invokeMethod(this, [this, root, read, compact]() {
+            onRefreshed(root, read, compact);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void NameIndexService::onRefreshed(const QString& root, const std::vector<std::string>& directories, bool compact)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end())
+        return;
+    it->busy = false;
+
+    watch(root, directories);
+    if (it->content) {
+        // Files written before the new directories were watched went unseen
+        for (const std::string& dir : directories) {
+            if (!m_writeWatchDescriptors.contains(absolutePath(root, fromNative(dir))))
+                it->newDirectories.insert(fromNative(dir));
+        }
+        watchWrites(root, directories);
+    }
+    if (compact)
+        startLoad(root, true);
+    else if (!it->dirty.isEmpty())
+        m_refreshTimer->start();
+}
+
+void NameIndexService::onDirectoryChanged(const QString& path)
+{
+    // With nested roots a directory belongs to several indexes, but is
+    // watched only once
+    QString relPath;
+    for (auto it = m_roots.begin(); it != m_roots.end(); ++it) {
+        if (isInside(path, it.key(), &relPath)) {
+            it->dirty.insert(relPath);
+            m_refreshTimer->start();   // restarts: waits for the burst to settle
+        }
+    }
+}
+
+void NameIndexService::refreshDirtyRoots()
+{
+    for (auto it = m_roots.begin(); it != m_roots.end(); ++it) {
+        // A busy root is picked up again when its task finishes
+        if (!it->dirty.isEmpty() && !it->busy && it->live) {
+            const QStringList dirs(it->dirty.begin(), it->dirty.end());
+            it->dirty.clear();
+            startRefresh(it.key(), dirs, false);
+        }
+        const bool contentDirty = !it->dirtyFiles.isEmpty() || !it->newDirectories.isEmpty() || it->contentRecheck;
+        if (contentDirty && !it->contentBusy && it->content)
+            startContentRefresh(it.key());
+    }
+}
+
+void NameIndexService::recheckUnwatchedRoots()
+{
+    for (auto it = m_roots.begin(); it != m_roots.end(); ++it) {
+        if (!it->fullyWatched && !it->busy && it->live)
+            startRefresh(it.key(), QStringList(), true);
+        if (!it->contentFullyWatched && !it->contentBusy && it->content) {
+            it->contentRecheck = true;
+            startContentRefresh(it.key());
+        }
+    }
+}
+
+void NameIndexService::watch(const QString& root, const std::vector<std::string>& directories)
+{
+    auto paths = std::make_shared<QStringList>();
+    paths->reserve(static_cast<int>(directories.size()));
+    for (const std::string& dir : directories)
+        paths->append(absolutePath(root, fromNative(dir)));
+    watchBatch(root, paths, 0);
+}
+
+// Large trees have hundreds of thousands of directories; add their watches a
+// batch at a time so the GUI stays responsive.
+void NameIndexService::watchBatch(const QString& root, std::shared_ptr<const QStringList> paths, int from)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end() || !it->fullyWatched || from >= paths->size())
+        return;
+
+    const QStringList batch = paths->mid(from, WatchBatchSize);
+    const QStringList failed = m_watcher->addPaths(batch);
+    const bool outOfWatches = std::any_of(failed.begin(), failed.end(), [](const QString& dir) {
+        return QFileInfo::exists(dir);   // not just removed in the meantime
+    });
+    if (outOfWatches) {
+        // Out of inotify watches: fall back to periodic mtime checks
+        qWarning() << "Filename index of" << root << "is too large to watch; checking it periodically instead";
+        it->fullyWatched = false;
+        return;
+    }
+    QTimer::singleShot(0, this, [this, root, paths, from]() {
+        watchBatch(root, paths, from + WatchBatchSize);
+    });
+}
+
+void NameIndexService::unwatch(const QString& root)
+{
+    QStringList paths;
+    QString relPath;
+    for (const QString& dir : m_watcher->directories()) {
+        if (!isInside(dir, root, &relPath))
+            continue;
+        bool shared = false;
+        for (auto it = m_roots.cbegin(); it != m_roots.cend() && !shared; ++it)
+            shared = it.key() != root && isInside(dir, it.key(), &relPath);
+        if (!shared)
+            paths.append(dir);
+    }
+    if (!paths.isEmpty())
+        m_watcher->removePaths(paths);
+}
+
+void NameIndexService::startContentLoad(const QString& root, bool rebuild)
+{
+    IndexedRoot& indexed = m_roots[root];
+    indexed.contentBusy = true;
+
+    const std::string rootPath = toNative(root);
+    const std::string contentFile = toNative(indexed.contentFile);
+    std::shared_ptr<search::LiveNameIndex> live = indexed.live;
+    std::shared_ptr<search::LiveTrigramIndex> content = indexed.content;
+
+    runTask([this, root, rootPath, contentFile, live, content, rebuild]() mutable {
+        std::shared_ptr<const search::TrigramIndex> base;
+        if (!rebuild) {
+            base = search::TrigramIndex::open(contentFile);
+            if (base && base->root() != rootPath)
+                base = nullptr;
+        }
+        if (!base && search::TrigramIndex::build(*live, contentFile, 0, &m_cancel))
+            base = search::TrigramIndex::open(contentFile);
+
+        std::vector<std::string> directories;
+        if (base) {
+            if (content)
+                content->reset(base);
+            else
+                content = std::make_shared<search::LiveTrigramIndex>(base);
+            // Files written while the application was not running, or while
+            // the index was being built
+            content->refreshFiles(content->staleFiles(*live, &m_cancel), &m_cancel);
+            directories = live->directories();
+        } else {
+            content.reset();
+        }
+        if (m_cancel.load())
+            return;
+
+        QMetaObject::invokeMethod(this, [this, root, content, directories]() {
+            onContentLoaded(root, content, directories);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void NameIndexService::onContentLoaded(const QString& root, std::shared_ptr<search::LiveTrigramIndex> content,
+                                       const std::vector<std::string>& directories)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end())
+        return;
+    it->contentBusy = false;
+    if (!m_indexContents)
+        return;   // switched off meanwhile
+    if (!content) {
+        qWarning() << "Cannot build content index of" << root;
+        return;
+    }
+
+    it->content = content;
+    publishContent(root, content);
+    watchWrites(root, directories);
+    m_refreshTimer->start();   // whatever was written meanwhile
+}
+
+void NameIndexService::startContentRefresh(const QString& root)
+{
+    IndexedRoot& indexed = m_roots[root];
+    indexed.contentBusy = true;
+
+    std::vector<std::string> files;
+    for (const QString& file : indexed.dirtyFiles)
+        files.push_back(toNative(file));
+    std::vector<std::string> newDirectories;
+    for (const QString& dir : indexed.newDirectories)
+        newDirectories.push_back(toNative(dir));
+    const bool recheck = indexed.contentRecheck;
+    indexed.dirtyFiles.clear();
+    indexed.newDirectories.clear();
+    indexed.contentRecheck = false;
+    std::shared_ptr<search::LiveNameIndex> live = indexed.live;
+    std::shared_ptr<search::LiveTrigramIndex> content = indexed.content;
+
+    runTask([this, root, live, content, files, newDirectories, recheck]() mutable {
+        if (recheck)
+            files = content->staleFiles(*live, &m_cancel);
+        for (const std::string& dir : newDirectories) {
+            search::IndexQuery query;
+            query.subtree = dir;
+            query.cancel = &m_cancel;
+            QMutex mutex;
+            live->query(query, [&](const search::IndexEntry& e) {
+                if (e.type == search::EntryType::File) {
+                    QMutexLocker locker(&mutex);
+                    files.push_back(e.dirPath.empty() ? std::string(e.name)
+                                                      : std::string(e.dirPath) + '/' + std::string(e.name));
+                }
+                return true;
+            });
+        }
+        content->refreshFiles(files, &m_cancel);
+        const bool compact = content->overrideCount() > ContentCompactThreshold;
+
+        QMetaObject::invokeMethod(this, [this, root, compact]() {
+            onContentRefreshed(root, compact);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void NameIndexService::onContentRefreshed(const QString& root, bool compact)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end())
+        return;
+    it->contentBusy = false;
+    if (!m_indexContents)
+        return;
+
+    if (compact)
+        startContentLoad(root, true);
+    else if (!it->dirtyFiles.isEmpty() || !it->newDirectories.isEmpty() || it->contentRecheck)
+        m_refreshTimer->start();
+}
+
+// Stop maintaining the content index of `root`; a task still running for it
+// finds m_indexContents off or the root gone and drops its result.
+void NameIndexService::dropContent(const QString& root)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end())
+        return;
+    unwatchWrites(root);
+    publishContent(root, nullptr);
+    it->content.reset();
+    it->contentFullyWatched = true;
+    it->contentRecheck = false;
+    it->dirtyFiles.clear();
+    it->newDirectories.clear();
+}
+
+void NameIndexService::watchWrites(const QString& root, const std::vector<std::string>& directories)
+{
+    auto paths = std::make_shared<QStringList>();
+    paths->reserve(static_cast<int>(directories.size()));
+    for (const std::string& dir : directories)
+        paths->append(absolutePath(root, fromNative(dir)));
+    watchWritesBatch(root, paths, 0);
+}
+
+void NameIndexService::watchWritesBatch(const QString& root, std::shared_ptr<const QStringList> paths, int from)
+{
+    auto it = m_roots.find(root);
+    if (it == m_roots.end() || !it->content || !it->contentFullyWatched || from >= paths->size())
+        return;
+
+#ifdef Q_OS_LINUX
+    if (m_writeWatchFd >= 0) {
+        const int end = std::min(from + WatchBatchSize, static_cast<int>(paths->size()));
+        for (int i = from; i < end; ++i) {
+            const QString& dir = paths->at(i);
+            if (m_writeWatchDescriptors.contains(dir))
+                continue;
+            const int wd = ::inotify_add_watch(m_writeWatchFd, QFile::encodeName(dir).constData(),
+                                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR);
+            if (wd < 0) {
+                if (errno != ENOSPC)
+                    continue;   // removed in the meantime
+                qWarning() << "Content index of" << root << "is too large to watch; checking it periodically instead";
+                it->contentFullyWatched = false;
+                return;
+            }
+            m_writeWatches.insert(wd, dir);
+            m_writeWatchDescriptors.insert(dir, wd);
+        }
+        QTimer::singleShot(0, this, [this, root, paths, from]() {
+            watchWritesBatch(root, paths, from + WatchBatchSize);
+        });
+        return;
+    }
+#endif
+    it->contentFullyWatched = false;   // no inotify: rely on the periodic recheck
+}
+
+void NameIndexService::unwatchWrites(const QString& root)
+{
+#ifdef Q_OS_LINUX
+    QString relPath;
+    for (auto w = m_writeWatchDescriptors.begin(); w != m_writeWatchDescriptors.end();) {
+        bool drop = isInside(w.key(), root, &relPath);
+        for (auto it = m_roots.cbegin(); it != m_roots.cend() && drop; ++it)
+            drop = it.key() == root || !it->content || !isInside(w.key(), it.key(), &relPath);
+        if (!drop) {
+            ++w;
+            continue;
+        }
+        ::inotify_rm_watch(m_writeWatchFd, w.value());
+        m_writeWatches.remove(w.value());
+        w = m_writeWatchDescriptors.erase(w);
+    }
+#else
+    Q_UNUSED(root);
+#endif
+}
+
+void NameIndexService::readWriteEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    for (;;) {
+        const ssize_t n = ::read(m_writeWatchFd, buffer, sizeof(buffer));
+        if (n <= 0)
+            break;
+        for (const char* p = buffer; p < buffer + n;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (auto it = m_roots.begin(); it != m_roots.end(); ++it)
+                    it->contentRecheck = it->content != nullptr;
+                m_refreshTimer->start();
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_writeWatchDescriptors.remove(m_writeWatches.take(event->wd));
+                continue;
+            }
+            if ((event->mask & IN_ISDIR) || event->len == 0)
+                continue;
+            const auto watch = m_writeWatches.constFind(event->wd);
+            if (watch == m_writeWatches.constEnd())
+                continue;
+
+            const QString path = absolutePath(*watch, QFile::decodeName(event->name));
+            QString relPath;
+            for (auto it = m_roots.begin(); it != m_roots.end(); ++it) {
+                if (it->content && isInside(path, it.key(), &relPath)) {
+                    it->dirtyFiles.insert(relPath);
+                    m_refreshTimer->start();
+                }
+            }
+        }
+    }
+#endif
+}
+
+void NameIndexService::publishContent(const QString& root, const std::shared_ptr<search::LiveTrigramIndex>& content)
+{
+    const std::string rootPath = toNative(root);
+    QMutexLocker locker(&m_readyMutex);
+    for (int i = m_readyContent.size() - 1; i >= 0; --i) {
+        if (m_readyContent[i].first == rootPath)
+            m_readyContent.removeAt(i);
+    }
+    if (content)
+        m_readyContent.append(qMakePair(rootPath, content));
+}
+
+void NameIndexService::publish(const QString& root, const std::shared_ptr<search::LiveNameIndex>& live)
+{
+    QMutexLocker locker(&m_readyMutex);
+    for (int i = m_ready.size() - 1; i >= 0; --i) {
+        if (m_ready[i].first == root)
+            m_ready.removeAt(i);
+    }
+    if (live)
+        m_ready.append(qMakePair(root, live));
+}
+
+void NameIndexService::runTask(std::function<void()> task)
+{
+    for (int i = m_tasks.size() - 1; i >= 0; --i) {
+        if (m_tasks[i].isFinished())
+            m_tasks.removeAt(i);
+    }
+    m_tasks.append(QtConcurrent::run(std::move(task)));
+}
+
+void NameIndexService::shutdown()
+{
+    m_cancel.store(true);
+    for (QFuture<void>& task : m_tasks)
+        task.waitForFinished();
+    m_tasks.clear();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace search { class LiveNameIndex; class LiveTrigramIndex; }
+
+class QFileSystemWatcher;
+class QSocketNotifier;
+class QTimer;
+
+// Keeps filename indexes (see search::NameIndex) of the trees listed in
+// Config::indexRoots() up to date, so SearchDialog can answer name searches
+// without walking the disk.
+//
+// On startup each index file is opened and checked against the current
+// directory mtimes; missing or unreadable ones are built in the background.
+// Afterwards every indexed directory is watched with QFileSystemWatcher and
+// changed directories are re-read after a short debounce. Trees larger than
+// the inotify watch limit are rechecked by mtime every minute instead. Once
+// many directories have been re-read the index file is rebuilt.
+//
+// With Config::indexContents() each root also gets a trigram index of its
+// file contents (see search::TrigramIndex), built once the filename index is
+// ready. Files are re-read when they are closed after writing or moved in
+// (inotify IN_CLOSE_WRITE / IN_MOVED_TO, which QFileSystemWatcher does not
+// report); without inotify they are found by the periodic recheck.
+class NameIndexService : public QObject {
+    Q_OBJECT
+
+public:
+    static NameIndexService& instance();
+
+    // Start, keep or drop indexes to match Config::indexRoots() and
+    // Config::indexDirectory(). Call after the configuration changed.
+    void applyConfig();
+
+    // The ready index whose tree contains `path`, or null. `relPath` receives
+    // `path` relative to the index root. Thread-safe.
+    std::shared_ptr<search::LiveNameIndex> indexFor(const QString& path, std::string* relPath) const;
+
+    // The content index of the index rooted at `root` (search::LiveNameIndex::root()),
+    // or null if contents are not indexed or the index is not ready. Thread-safe.
+    std::shared_ptr<search::LiveTrigramIndex> contentIndex(const std::string& root) const;
+
+    // Index directory used when Config::indexDirectory() is empty.
+    static QString defaultIndexDirectory();
+
+signals:
+    void indexReady(const QString& root);
+
+private:
+    struct IndexedRoot {
+        QString path;                                  // absolute, no trailing '/'
+        QString indexFile;
+        std::shared_ptr<search::LiveNameIndex> live;   // null until loaded
+        bool busy = false;                             // a background task owns `live`
+        bool fullyWatched = true;
+        QSet<QString> dirty;                           // relative directories to re-read
+
+        QString contentFile;
+        std::shared_ptr<search::LiveTrigramIndex> content;   // null until loaded, or when disabled
+        bool contentBusy = false;
+        bool contentFullyWatched = true;
+        bool contentRecheck = false;                   // events were lost, compare all files
+        QSet<QString> dirtyFiles;                      // relative files to re-read
+        QSet<QString> newDirectories;                  // relative directories whose files are all new
+    };
+
+    NameIndexService();
+
+    void startLoad(const QString& root, bool rebuild);
+    void onLoaded(const QString& root, std::shared_ptr<search::LiveNameIndex> live,
+                  const std::vector<std::string>& directories);
+    void startRefresh(const QString& root, const QStringList& dirs, bool recheck);
+    void onRefreshed(const QString& root, const std::vector<std::string>& directories, bool compact);
+    void onDirectoryChanged(const QString& path);
+    void refreshDirtyRoots();
+    void recheckUnwatchedRoots();
+    void watch(const QString& root, const std::vector<std::string>& directories);
+    void watchBatch(const QString& root, std::shared_ptr<const QStringList> paths, int from);
+    void unwatch(const QString& root);
+    void publish(const QString& root, const std::shared_ptr<search::LiveNameIndex>& live);
+
+    void startContentLoad(const QString& root, bool rebuild);
+    void onContentLoaded(const QString& root, std::shared_ptr<search::LiveTrigramIndex> content,
+                         const std::vector<std::string>& directories);
+    void startContentRefresh(const QString& root);
+    void onContentRefreshed(const QString& root, bool compact);
+    void dropContent(const QString& root);
+    void watchWrites(const QString& root, const std::vector<std::string>& directories);
+    void watchWritesBatch(const QString& root, std::shared_ptr<const QStringList> paths, int from);
+    void unwatchWrites(const QString& root);
+    void readWriteEvents();
+    void publishContent(const QString& root, const std::shared_ptr<search::LiveTrigramIndex>& content);
+    void runTask(std::function<void()> task);
+    void shutdown();
+
+    QHash<QString, IndexedRoot> m_roots;               // GUI thread only
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_refreshTimer;
+    QTimer* m_recheckTimer;
+    QList<QFuture<void>> m_tasks;
+    std::atomic<bool> m_cancel{false};
+    bool m_indexContents = false;
+
+    // Directories watched for written files, by inotify watch descriptor
+    int m_writeWatchFd = -1;
+    QSocketNotifier* m_writeNotifier = nullptr;
+    QHash<int, QString> m_writeWatches;
+    QHash<QString, int> m_writeWatchDescriptors;
+
+    // Ready indexes, for indexFor() and contentIndex() from search threads
+    mutable QMutex m_readyMutex;
+    QList<QPair<QString, std::shared_ptr<search::LiveNameIndex>>> m_ready;
+    QList<QPair<std::string, std::shared_ptr<search::LiveTrigramIndex>>> m_readyContent;
+};
@@ -0,0 +1,46 @@
+#include "NameMask.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QStringList>
+
+NameMask::NameMask(const QString& masks, bool caseSensitive, bool partOfName)
+{
+    const QString pattern = masks.trimmed().isEmpty() ? QStringLiteral("*") : masks;
+    const QByteArray encoded = QFile::encodeName(pattern);
+
+    if (search::GlobMatcher::supports(std::string_view(encoded.constData(), encoded.size()), caseSensitive)) {
+        search::GlobOptions options;
+        options.caseSensitive = caseSensitive;
+        options.partOfName = partOfName;
+        m_glob = search::GlobMatcher(std::string_view(encoded.constData(), encoded.size()), options);
+        return;
+    }
+
+    QStringList alternatives;
+    for (const std::string& mask : search::GlobMatcher::split(std::string_view(encoded.constData(), encoded.size()))) {
+        QString wildcard = QFile::decodeName(QByteArray::fromStdString(mask));
+        if (partOfName && !wildcard.startsWith('*'))
+            wildcard.prepend('*');
+        if (partOfName && !wildcard.endsWith('*'))
+            wildcard.append('*');
+        alternatives.append(QRegularExpression::wildcardToRegularExpression(wildcard));
+    }
+    m_regex = QRegularExpression(alternatives.join('|'), QRegularExpression::CaseInsensitiveOption);
+    m_useRegex = true;
+}
+
+bool NameMask::matches(const QString& name) const
+{
+    if (m_useRegex)
+        return m_regex.match(name).hasMatch();
+    const QByteArray encoded = QFile::encodeName(name);
+    return m_glob.matches(std::string_view(encoded.constData(), encoded.size()));
+}
+
+bool NameMask::matches(std::string_view name) const
+{
+    if (m_useRegex)
+        return m_regex.match(QFile::decodeName(QByteArray(name.data(), static_cast<int>(name.size())))).hasMatch();
+    return m_glob.matches(name);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QRegularExpression>
+#include <QString>
+
+#include <string>
+#include <string_view>
+
+#include "search/GlobMatcher.h"
+
+// File name mask as typed by the user: wildcards, several masks separated
+// by ';' ("*.cpp;*.h"). An empty mask matches every name.
+//
+// Matching runs on search::GlobMatcher. Only case-insensitive masks with
+// non-ASCII characters, which need Unicode case folding, are converted to a
+// QRegularExpression instead.
+class NameMask {
+public:
+    NameMask() = default;
+    explicit NameMask(const QString& masks, bool caseSensitive = false, bool partOfName = false);
+
+    bool matches(const QString& name) const;
+    // Name as encoded on disk (QFile::encodeName()), e.g. straight from a
+    // directory entry, without decoding it first.
+    bool matches(std::string_view name) const;
+
+    // A literal every matching name contains (encoded, folded when matching
+    // case-insensitively), or "" if there is none.
+    const std::string& requiredLiteral() const { return m_glob.requiredLiteral(); }
+
+private:
+    search::GlobMatcher m_glob;
+    QRegularExpression m_regex;
+    bool m_useRegex = false;
+};
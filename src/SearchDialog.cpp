@@ -13,7 +13,15 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QLocale>
+#include <QRegularExpression>
 #include <algorithm>
+#include <numeric>
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include "search/HexPattern.h"
+#include "search/ParallelSort.h"
 
 #include "keys/ObjectRegistry.h"
 
@@ -24,13 +32,14 @@
 SearchResultsModel::SearchResultsModel(QObject* parent)
     : QAbstractTableModel(parent)
 {
+    clear();
 }
 
 int SearchResultsModel::rowCount(const QModelIndex& parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_isSorted ? m_sortedIndices.size() : m_results.size();
+    return m_rows.size();
 }
 
 int SearchResultsModel::columnCount(const QModelIndex& parent) const
@@ -45,25 +54,22 @@ QVariant SearchResultsModel::data(const QModelIndex& index, int role) const
     if (!index.isValid() || index.row() >= rowCount() || index.column() >= ColumnCount)
         return QVariant();
 
-    // Get actual result index (sorted or direct)
-    int resultIndex = m_isSorted ? m_sortedIndices[index.row()] : index.row();
-
-    // Bounds check for resultIndex
-    if (resultIndex < 0 || resultIndex >= m_results.size())
-        return QVariant();
-
-    const SearchResult& result = m_results[resultIndex];
+    const Row& result = rowAt(index.row());
 
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
             case ColumnName:
-                return result.name;
+                return nameOf(result).toString();
             case ColumnDir:
-                return result.dir;
+                return m_dirs[result.dir];
             case ColumnSize:
                 return formatSize(result.size);
             case ColumnModified:
-                return formatDateTime(result.modifiedTimestamp);
+                return formatDateTime(result.modified);
+            case ColumnMatch:
+                if (result.matchOffset >= 0)
+                    return QStringLiteral("%1 @ 0x%2").arg(m_matches[result.match]).arg(result.matchOffset, 0, 16);
+                return m_matches[result.match];
         }
     }
 
@@ -81,156 +87,238 @@ QVariant SearchResultsModel::headerData(int section, Qt::Orientation orientation
             case ColumnName: return tr("Name");
             case ColumnSize: return tr("Size");
             case ColumnModified: return tr("Modified");
+            case ColumnMatch: return tr("Match");
         }
     }
 
     return QVariant();
 }
 
+// The permutation is computed on a snapshot of the tables - implicitly
+// shared copies, so results keep arriving meanwhile - and applied when it is
+// ready. Rows added in between stay at the end until the next sort.
 void SearchResultsModel::sort(int column, Qt::SortOrder order)
 {
-    if (m_results.isEmpty())
+    if (m_rows.isEmpty())
         return;
 
-    // Optimization: if same column, just reverse the order instead of re-sorting
-    bool sameColumn = (m_sortColumn == column && m_isSorted);
-    bool justReverse = sameColumn && (m_sortOrder != order);
-
-    // Store persistent indices and map them to actual data indices BEFORE sorting
-    QModelIndexList oldPersistentIndexes = persistentIndexList();
-    QVector<int> oldDataIndices;  // Map to actual data indices
-
-    // Only process persistent indices if there are any (optimization for large datasets)
-    if (!oldPersistentIndexes.isEmpty()) {
-        oldDataIndices.reserve(oldPersistentIndexes.size());
-        for (const QModelIndex& idx : oldPersistentIndexes) {
-            int row = idx.row();
-            if (row >= 0 && row < rowCount()) {
-                // Get the actual data index BEFORE we modify m_sortedIndices
-                int dataIndex = m_isSorted ? m_sortedIndices[row] : row;
-                oldDataIndices.append(dataIndex);
-            } else {
-                oldDataIndices.append(-1);  // Invalid
-            }
+    const quint64 request = ++m_sortRequest;
+
+    // Same column, other direction: reversing is enough
+    if (m_sortColumn == column && !m_sortedIndices.isEmpty() && m_sortedRows == m_rows.size()) {
+        if (m_sortOrder != order) {
+            QVector<int> reversed(m_sortedIndices.rbegin(), m_sortedIndices.rend());
+            m_sortOrder = order;
+            applyOrder(std::move(reversed));
         }
+        return;
     }
 
-    emit layoutAboutToBeChanged();
-
-    m_sortColumn = column;
-    m_sortOrder = order;
-
-    // Fast path: just reverse if same column, different order
-    if (justReverse) {
-        std::reverse(m_sortedIndices.begin(), m_sortedIndices.end());
-    } else {
-        updateSortedIndices();
-    }
+    auto* watcher = new QFutureWatcher<QVector<int>>(this);
+    connect(watcher, &QFutureWatcher<QVector<int>>::finished, this, [this, watcher, request, column, order]() {
+        watcher->deleteLater();
+        if (request != m_sortRequest)
+            return;  // cleared or sorted differently since
+        m_sortColumn = column;
+        m_sortOrder = order;
+        applyOrder(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([rows = m_rows, names = m_names, dirs = m_dirs, matches = m_matches,
+                                          column, order]() {
+        return sortedOrder(rows, names, dirs, matches, column, order);
+    }));
+}
 
-    // Update persistent indices only if there are any
-    if (!oldPersistentIndexes.isEmpty()) {
-        // Create reverse map: dataIndex -> newRow (for fast lookup)
-        QHash<int, int> dataIndexToNewRow;
-        dataIndexToNewRow.reserve(m_sortedIndices.size());
-        for (int newRow = 0; newRow < m_sortedIndices.size(); ++newRow) {
-            dataIndexToNewRow[m_sortedIndices[newRow]] = newRow;
+// Order of `rows` by `column`. Strings are compared once per distinct value
+// where possible: directories and terms are ranked up front, so only names
+// need string comparisons. Ties fall back to insertion order.
+QVector<int> SearchResultsModel::sortedOrder(const QVector<Row>& rows, const QString& names,
+                                             const QVector<QString>& dirs, const QVector<QString>& matches,
+                                             int column, Qt::SortOrder order)
+{
+    auto ranks = [](const QVector<QString>& table) {
+        QVector<int> byValue(table.size());
+        std::iota(byValue.begin(), byValue.end(), 0);
+        std::sort(byValue.begin(), byValue.end(), [&table](int a, int b) { return table[a] < table[b]; });
+        QVector<quint32> rank(table.size());
+        for (int i = 0; i < byValue.size(); ++i)
+            rank[byValue[i]] = static_cast<quint32>(i);
+        return rank;
+    };
+    const QVector<quint32> dirRank = column == ColumnDir ? ranks(dirs) : QVector<quint32>();
+    const QVector<quint32> matchRank = column == ColumnMatch ? ranks(matches) : QVector<quint32>();
+
+    auto name = [&names, &rows](int i) {
+        return QStringView(names).mid(rows[i].nameOffset, rows[i].nameLength);
+    };
+    auto less = [&](int a, int b) {
+        const Row& ra = rows[a];
+        const Row& rb = rows[b];
+        switch (column) {
+            case ColumnName: {
+                const int c = name(a).compare(name(b));
+                if (c != 0)
+                    return c < 0;
+                break;
+            }
+            case ColumnDir: {
+                // Same directory: order by name, so the result reads like a path listing
+                if (ra.dir != rb.dir)
+                    return dirRank[ra.dir] < dirRank[rb.dir];
+                const int c = name(a).compare(name(b));
+                if (c != 0)
+                    return c < 0;
+                break;
+            }
+            case ColumnSize:
+                if (ra.size != rb.size)
+                    return ra.size < rb.size;
+                break;
+            case ColumnModified:
+                if (ra.modified != rb.modified)
+                    return ra.modified < rb.modified;
+                break;
+            case ColumnMatch:
+                if (ra.match != rb.match)
+                    return matchRank[ra.match] < matchRank[rb.match];
+                if (ra.matchOffset != rb.matchOffset)
+                    return ra.matchOffset < rb.matchOffset;
+                break;
         }
+        return a < b;
+    };
+
+    QVector<int> result(rows.size());
+    std::iota(result.begin(), result.end(), 0);
+    // Descending order compares swapped operands (negating the result
+    // would break strict weak ordering for equal keys)
+    if (order == Qt::AscendingOrder)
+        search::parallelSort(result.begin(), result.end(), less);
+    else
+        search::parallelSort(result.begin(), result.end(), [&less](int a, int b) { return less(b, a); });
+    return result;
+}
 
-        // Update persistent indices to reflect new positions
-        QModelIndexList newPersistentIndexes;
-        newPersistentIndexes.reserve(oldPersistentIndexes.size());
+// Show the rows in `order` (indices into m_rows; rows added since it was
+// computed are appended), moving persistent indices along in one pass.
+void SearchResultsModel::applyOrder(QVector<int> order)
+{
+    const int sortedRows = order.size();
+    for (int i = sortedRows; i < m_rows.size(); ++i)
+        order.append(i);
 
-        for (int i = 0; i < oldPersistentIndexes.size(); ++i) {
-            const QModelIndex& oldIdx = oldPersistentIndexes[i];
-            int dataIndex = oldDataIndices[i];
+    emit layoutAboutToBeChanged();
 
-            if (dataIndex < 0 || dataIndex >= m_results.size())
+    const QModelIndexList oldPersistent = persistentIndexList();
+    if (!oldPersistent.isEmpty()) {
+        QVector<int> newRowOf(m_rows.size());
+        for (int row = 0; row < order.size(); ++row)
+            newRowOf[order[row]] = row;
+
+        QModelIndexList newPersistent;
+        newPersistent.reserve(oldPersistent.size());
+        for (const QModelIndex& idx : oldPersistent) {
+            const int row = idx.row();
+            if (row < 0 || row >= m_rows.size()) {
+                newPersistent.append(QModelIndex());
                 continue;
-
-            // Find where this data item is in the NEW sorted order (O(1) lookup)
-            auto it = dataIndexToNewRow.find(dataIndex);
-            if (it != dataIndexToNewRow.end()) {
-                int newRow = it.value();
-                newPersistentIndexes.append(index(newRow, oldIdx.column()));
             }
+            const int dataIndex = m_sortedIndices.isEmpty() ? row : m_sortedIndices[row];
+            newPersistent.append(index(newRowOf[dataIndex], idx.column()));
         }
-
-        changePersistentIndexList(oldPersistentIndexes, newPersistentIndexes);
+        changePersistentIndexList(oldPersistent, newPersistent);
     }
 
+    m_sortedIndices = std::move(order);
+    m_sortedRows = sortedRows;
     emit layoutChanged();
 }
 
-void SearchResultsModel::addResult(const QString& path, qint64 size, qint64 modifiedTimestamp)
+void SearchResultsModel::addResults(const QVector<SearchHit>& hits)
 {
-    // Split path into directory and name
-    QFileInfo info(path);
-    QString dir = info.path();
-    QString name = info.fileName();
+    if (hits.isEmpty())
+        return;
+
+    // Add to raw data without sorting - just append, as one block of rows.
+    // If the view is sorted already, the new rows go at its end.
+    const int firstRow = m_rows.size();
+    beginInsertRows(QModelIndex(), firstRow, firstRow + hits.size() - 1);
+    m_rows.reserve(m_rows.size() + hits.size());
+    QString lastDir;
+    quint32 lastDirIndex = 0;
+    for (const SearchHit& hit : hits) {
+        // Split path into directory and name; paths are absolute
+        const int slash = hit.path.lastIndexOf('/');
+        QString dir;
+        QStringView name;
+        if (slash < 0) {
+            dir = QFileInfo(hit.path).path();
+            name = QStringView(hit.path);
+        } else {
+            dir = slash == 0 ? QStringLiteral("/") : hit.path.left(slash);
+            name = QStringView(hit.path).mid(slash + 1);
+        }
+        // Hits tend to come in runs from the same directory
+        if (lastDir.isNull() || dir != lastDir) {
+            lastDirIndex = intern(m_dirs, m_dirIndex, dir);
+            lastDir = dir;
+        }
 
-    // Add to raw data without sorting - just append
-    int newRow = m_results.size();
-    beginInsertRows(QModelIndex(), newRow, newRow);
-    m_results.append({dir, name, size, modifiedTimestamp});
+        Row row;
+        row.dir = lastDirIndex;
+        row.match = hit.matchedTerm.isEmpty() ? 0 : intern(m_matches, m_matchIndex, hit.matchedTerm);
+        row.nameOffset = static_cast<quint32>(m_names.size());
+        row.nameLength = static_cast<quint16>(name.size());
+        row.isDir = hit.isDir;
+        row.size = hit.size;
+        row.modified = hit.modifiedMs;
+        row.matchOffset = hit.matchOffset;
+        m_names.append(name);
+
+        if (!m_sortedIndices.isEmpty())
+            m_sortedIndices.append(m_rows.size());
+        m_rows.append(row);
+    }
     endInsertRows();
 }
 
 void SearchResultsModel::clear()
 {
     beginResetModel();
-    m_results.clear();
+    m_rows.clear();
+    m_names.clear();
+    m_dirs.clear();
+    m_dirIndex.clear();
+    m_matches = {QString()};
+    m_matchIndex.clear();
+    m_matchIndex.insert(QString(), 0);
     m_sortedIndices.clear();
+    m_sortedRows = 0;
     m_sortColumn = -1;
-    m_isSorted = false;
+    ++m_sortRequest;
     endResetModel();
 }
 
-const SearchResult& SearchResultsModel::resultAt(int row) const
+SearchResult SearchResultsModel::resultAt(int row) const
 {
-    int resultIndex = m_isSorted ? m_sortedIndices[row] : row;
-    return m_results[resultIndex];
+    const Row& r = rowAt(row);
+    return {m_dirs[r.dir], nameOf(r).toString(), r.size, r.modified, m_matches[r.match], r.matchOffset, r.isDir};
 }
 
-void SearchResultsModel::updateSortedIndices()
+QStringView SearchResultsModel::nameOf(const Row& row) const
 {
-    // Initialize indices array (0, 1, 2, ...)
-    m_sortedIndices.resize(m_results.size());
-    for (int i = 0; i < m_results.size(); ++i)
-        m_sortedIndices[i] = i;
-
-    // Sort indices based on column data
-    std::sort(m_sortedIndices.begin(), m_sortedIndices.end(),
-        [this](int a, int b) {
-            // Bounds check - protect against invalid indices
-            if (a < 0 || a >= m_results.size() || b < 0 || b >= m_results.size()) {
-                return a < b;  // Fallback comparison
-            }
-
-            const SearchResult& ra = m_results[a];
-            const SearchResult& rb = m_results[b];
-
-            bool less = false;
-            switch (m_sortColumn) {
-                case ColumnName:
-                    less = ra.name < rb.name;
-                    break;
-                case ColumnDir:
-                    less = ra.dir < rb.dir;
-                    break;
-                case ColumnSize:
-                    less = ra.size < rb.size;
-                    break;
-                case ColumnModified:
-                    less = ra.modifiedTimestamp < rb.modifiedTimestamp;
-                    break;
-                default:
-                    return a < b;  // Stable fallback
-            }
-
-            return m_sortOrder == Qt::AscendingOrder ? less : !less;
-        });
+    return QStringView(m_names).mid(row.nameOffset, row.nameLength);
+}
 
-    m_isSorted = true;
+quint32 SearchResultsModel::intern(QVector<QString>& table, QHash<QString, quint32>& index, const QString& s)
+{
+    auto it = index.constFind(s);
+    if (it != index.constEnd())
+        return it.value();
+    const auto id = static_cast<quint32>(table.size());
+    table.append(s);
+    index.insert(s, id);
+    return id;
 }
 
 QString SearchResultsModel::formatSize(qint64 size) const
@@ -311,16 +399,20 @@ void SearchDialog::setupUi()
 
     m_startButton = new QPushButton(tr("Start"), this);
     m_stopButton = new QPushButton(tr("Stop"), this);
+    m_pauseButton = new QPushButton(tr("Pause"), this);
     m_resetButton = new QPushButton(tr("Reset"), this);
     m_clearButton = new QPushButton(tr("Clear"), this);
     m_closeButton = new QPushButton(tr("Close"), this);
 
     m_stopButton->setEnabled(false);
+    m_pauseButton->setEnabled(false);
+    m_pauseButton->setToolTip(tr("Suspend the search where it is, to resume it later"));
     m_resetButton->setToolTip(tr("Reset options to defaults (keep results)"));
     m_clearButton->setToolTip(tr("Reset options and clear results"));
 
     buttonLayout->addWidget(m_startButton);
     buttonLayout->addWidget(m_stopButton);
+    buttonLayout->addWidget(m_pauseButton);
     buttonLayout->addWidget(m_resetButton);
     buttonLayout->addWidget(m_clearButton);
     buttonLayout->addWidget(m_closeButton);
@@ -331,6 +423,7 @@ void SearchDialog::setupUi()
     // Connections
     connect(m_startButton, &QPushButton::clicked, this, &SearchDialog::onStartSearch);
     connect(m_stopButton, &QPushButton::clicked, this, &SearchDialog::onStopSearch);
+    connect(m_pauseButton, &QPushButton::clicked, this, &SearchDialog::onPauseSearch);
     connect(m_resetButton, &QPushButton::clicked, this, &SearchDialog::onResetOptions);
     connect(m_clearButton, &QPushButton::clicked, this, &SearchDialog::onClearAll);
     connect(m_closeButton, &QPushButton::clicked, this, &QDialog::accept);
@@ -365,7 +458,7 @@ void SearchDialog::createStandardTab()
     auto* fileNameLayout = new QHBoxLayout();
     fileNameLayout->addWidget(new QLabel(tr("File name:")), 0);
     m_fileNameEdit = new QLineEdit(criteriaGroup);
-    m_fileNameEdit->setPlaceholderText(tr("e.g., test or *.txt"));
+    m_fileNameEdit->setPlaceholderText(tr("e.g., test, *.txt or *.cpp;*.h"));
     fileNameLayout->addWidget(m_fileNameEdit, 1);
 
     // Not checkbox for filename
@@ -400,6 +493,14 @@ void SearchDialog::createStandardTab()
     m_itemTypeCombo->setCurrentIndex(0);  // default: Files and directories
 
     itemTypeLayout->addWidget(m_itemTypeCombo);
+    itemTypeLayout->addSpacing(20);
+
+    m_searchArchivesCheck = new QCheckBox(tr("Search in archives"), criteriaGroup);
+    m_searchArchivesCheck->setToolTip(tr("Also match the files inside archives (zip, tar, 7z, ...), read "
+                                         "without extracting them. Not combined with the file content or "
+                                         "executable filters. Compressed files (.gz, .xz, .zst, ...) are "
+                                         "searched for text in their decompressed content."));
+    itemTypeLayout->addWidget(m_searchArchivesCheck);
     itemTypeLayout->addStretch();
 
     criteriaLayout->addLayout(itemTypeLayout);
@@ -434,11 +535,28 @@ void SearchDialog::createStandardTab()
     textOptionsLayout->addSpacing(20);
     m_textCaseSensitiveCheck = new QCheckBox(tr("Case sensitive"), criteriaGroup);
     m_wholeWordsCheck = new QCheckBox(tr("Whole words only"), criteriaGroup);
+    m_textRegexCheck = new QCheckBox(tr("Regular expression"), criteriaGroup);
+    m_textRegexCheck->setToolTip(tr("Perl-compatible regex, matched line by line"));
+    m_textHexCheck = new QCheckBox(tr("Hex bytes"), criteriaGroup);
+    m_textHexCheck->setToolTip(tr("Byte pattern in hex, ?? for any byte, e.g. \"7F 45 4C 46 ?? 01\". "
+                                  "Matched on the raw file data; the Match column shows the offset "
+                                  "and View opens the hex view there."));
     textOptionsLayout->addWidget(m_textCaseSensitiveCheck);
     textOptionsLayout->addWidget(m_wholeWordsCheck);
+    textOptionsLayout->addWidget(m_textRegexCheck);
+    textOptionsLayout->addWidget(m_textHexCheck);
     textOptionsLayout->addStretch();
     criteriaLayout->addLayout(textOptionsLayout);
 
+    // Byte patterns have no case, words or regex syntax
+    connect(m_textHexCheck, &QCheckBox::toggled, this, [this](bool hex) {
+        m_textCaseSensitiveCheck->setEnabled(!hex);
+        m_wholeWordsCheck->setEnabled(!hex);
+        m_textRegexCheck->setEnabled(!hex);
+        if (hex)
+            m_textRegexCheck->setChecked(false);
+    });
+
     layout->addWidget(criteriaGroup);
 
     // Search in results checkbox (shown only when results exist)
@@ -511,6 +629,98 @@ void SearchDialog::createAdvancedTab()
 
     layout->addWidget(attributesGroup);
 
+    // Additional text terms
+    auto* termsGroup = new QGroupBox(tr("Containing any of these terms (one per line):"), m_advancedTab);
+    auto* termsLayout = new QVBoxLayout(termsGroup);
+
+    m_containingTermsEdit = new QPlainTextEdit(termsGroup);
+    m_containingTermsEdit->setPlaceholderText(tr("Searched together with \"Containing text\" in a single pass"));
+    m_containingTermsEdit->setToolTip(tr("A file matches if it contains any of the terms; the Match column shows which one"));
+    m_containingTermsEdit->setMaximumHeight(100);
+    termsLayout->addWidget(m_containingTermsEdit);
+
+    layout->addWidget(termsGroup);
+
+    // Results
+    auto* resultsGroup = new QGroupBox(tr("Results:"), m_advancedTab);
+    auto* resultsLayout = new QVBoxLayout(resultsGroup);
+
+    m_sortResultsCheck = new QCheckBox(tr("Sort results when search finishes"), resultsGroup);
+    m_sortResultsCheck->setToolTip(tr("Results are collected by several threads in no particular order"));
+    m_sortResultsCheck->setChecked(true);  // default ON
+    resultsLayout->addWidget(m_sortResultsCheck);
+
+    layout->addWidget(resultsGroup);
+
+    // Traversal: what is never descended into
+    auto* traversalGroup = new QGroupBox(tr("Traversal:"), m_advancedTab);
+    auto* traversalLayout = new QFormLayout(traversalGroup);
+
+    m_excludeDirsEdit = new QLineEdit(traversalGroup);
+    m_excludeDirsEdit->setPlaceholderText(tr("e.g., node_modules;.git;build*"));
+    m_excludeDirsEdit->setToolTip(tr("Directories whose name matches one of these masks are neither "
+                                     "searched nor reported"));
+    traversalLayout->addRow(tr("Skip directories:"), m_excludeDirsEdit);
+
+    m_ignoreFilesCheck = new QCheckBox(tr("Honor .gitignore and .ignore files"), traversalGroup);
+    m_ignoreFilesCheck->setToolTip(tr("Skip what the ignore files found along the way exclude, and .git "
+                                      "directories. Ignore files above the search directory count too, "
+                                      "up to the top of its git work tree."));
+    traversalLayout->addRow(m_ignoreFilesCheck);
+
+    m_oneFileSystemCheck = new QCheckBox(tr("Stay on one filesystem"), traversalGroup);
+    m_oneFileSystemCheck->setToolTip(tr("Do not descend into mounted filesystems (snapshots, network shares, "
+                                        "removable media) below the search directory"));
+    traversalLayout->addRow(m_oneFileSystemCheck);
+
+    layout->addWidget(traversalGroup);
+
+    // Priority: how much of the machine the search may take
+    auto* priorityGroup = new QGroupBox(tr("Priority:"), m_advancedTab);
+    auto* priorityLayout = new QFormLayout(priorityGroup);
+
+    auto* ioLayout = new QHBoxLayout();
+    m_ioClassCombo = new QComboBox(priorityGroup);
+    m_ioClassCombo->addItem(tr("Normal"));          // index 0
+    m_ioClassCombo->addItem(tr("Best effort"));     // index 1
+    m_ioClassCombo->addItem(tr("Idle"));            // index 2
+    m_ioClassCombo->setToolTip(tr("Idle: the search only reads the disk when nothing else does"));
+    ioLayout->addWidget(m_ioClassCombo);
+    ioLayout->addWidget(new QLabel(tr("Level:"), priorityGroup));
+    m_ioLevelSpin = new QSpinBox(priorityGroup);
+    m_ioLevelSpin->setRange(0, 7);
+    m_ioLevelSpin->setValue(7);
+    m_ioLevelSpin->setToolTip(tr("0 is the highest priority, 7 the lowest"));
+    m_ioLevelSpin->setEnabled(false);
+    ioLayout->addWidget(m_ioLevelSpin);
+    ioLayout->addStretch();
+    priorityLayout->addRow(tr("Disk I/O:"), ioLayout);
+
+    m_niceSpin = new QSpinBox(priorityGroup);
+    m_niceSpin->setRange(0, 19);
+    m_niceSpin->setToolTip(tr("Nice level of the searching threads; 19 yields the CPU to everything else"));
+    priorityLayout->addRow(tr("CPU nice level:"), m_niceSpin);
+
+    connect(m_ioClassCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        m_ioLevelSpin->setEnabled(index == 1);
+    });
+
+    layout->addWidget(priorityGroup);
+
+    // Filename index
+    auto* indexGroup = new QGroupBox(tr("Filename index:"), m_advancedTab);
+    auto* indexLayout = new QVBoxLayout(indexGroup);
+
+    m_useIndexCheck = new QCheckBox(tr("Use the filename index when the directory is indexed"), indexGroup);
+    m_useIndexCheck->setToolTip(tr("Indexed directories are set up in Settings \u2192 General. "
+                                   "Directories on other filesystems below them are not searched. "
+                                   "If file contents are indexed too, text searches only read the "
+                                   "files that can contain the text."));
+    m_useIndexCheck->setChecked(true);  // default ON
+    indexLayout->addWidget(m_useIndexCheck);
+
+    layout->addWidget(indexGroup);
+
     layout->addStretch();
 }
 
@@ -519,6 +729,25 @@ void SearchDialog::createResultsTab()
     m_resultsTab = new QWidget();
     auto* layout = new QVBoxLayout(m_resultsTab);
 
+    // Search as you type: edits the file name of the Standard tab and
+    // searches again shortly after the last keystroke
+    auto* typeLayout = new QHBoxLayout();
+    typeLayout->addWidget(new QLabel(tr("Search as you type:")), 0);
+    m_typeQueryEdit = new QLineEdit(m_resultsTab);
+    m_typeQueryEdit->setPlaceholderText(tr("File name; refining it filters the results instead of searching again"));
+    m_typeQueryEdit->setClearButtonEnabled(true);
+    typeLayout->addWidget(m_typeQueryEdit, 1);
+    layout->addLayout(typeLayout);
+
+    m_typeTimer = new QTimer(this);
+    m_typeTimer->setSingleShot(true);
+    m_typeTimer->setInterval(TypeDelayMs);
+    connect(m_typeTimer, &QTimer::timeout, this, &SearchDialog::onTypeQueryChanged);
+    connect(m_typeQueryEdit, &QLineEdit::textEdited, this, [this](const QString& text) {
+        m_fileNameEdit->setText(text);
+        m_typeTimer->start();
+    });
+
     // Results view with model
     m_resultsView = new QTableView(m_resultsTab);
     m_resultsView->setModel(m_resultsModel);
@@ -530,11 +759,12 @@ void SearchDialog::createResultsTab()
     m_resultsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_resultsView->setSortingEnabled(true);  // Allow user to sort by clicking headers
 
-    // Set column widths: Dir, Name, Size, Modified
+    // Set column widths: Dir, Name, Size, Modified, Match
     m_resultsView->setColumnWidth(0, 250);  // Dir
     m_resultsView->setColumnWidth(1, 200);  // Name
     m_resultsView->setColumnWidth(2, 90);   // Size
     m_resultsView->setColumnWidth(3, 130);  // Modified
+    m_resultsView->setColumnWidth(4, 120);  // Match
 
     layout->addWidget(m_resultsView);
 
@@ -578,44 +808,47 @@ void SearchDialog::createResultsTab()
 
 void SearchDialog::onStartSearch()
 {
-    // Validate input
-    QString searchPath = m_searchInEdit->text().trimmed();
-    if (searchPath.isEmpty()) {
-        QMessageBox::warning(this, tr("Search"), tr("Please specify a directory to search in."));
-        return;
-    }
-
-    QDir dir(searchPath);
-    if (!dir.exists()) {
-        QMessageBox::warning(this, tr("Search"), tr("The specified directory does not exist."));
+    SearchCriteria criteria;
+    if (!collectCriteria(criteria, false))
         return;
-    }
 
     // Check if "Search in results" mode
-    bool searchInResults = m_searchInResultsCheck->isVisible() &&
-                          m_searchInResultsCheck->isChecked();
+    criteria.searchInResults = m_searchInResultsCheck->isVisible() &&
+                               m_searchInResultsCheck->isChecked();
 
-    // Collect previous results if in search-in-results mode
-    QVector<QString> previousResults;
-    if (searchInResults) {
-        int count = m_resultsModel->resultCount();
-        previousResults.reserve(count);
-        for (int i = 0; i < count; ++i) {
-            const SearchResult& result = m_resultsModel->resultAt(i);
-            previousResults.append(result.dir + "/" + result.name);
-        }
-    }
+    // Collect previous results if in search-in-results mode; the worker
+    // reuses what is known about them
+    if (criteria.searchInResults)
+        criteria.previousResults = currentResultsAsHits();
 
-    // Clear results only if not searching in results
-    if (!searchInResults) {
-        m_resultsModel->clear();
-    }
+    // The narrowed results replace the previous ones
+    m_resultsModel->clear();
     m_foundCount = 0;
+    m_typeTimer->stop();
+    m_typeQueryEdit->setText(m_fileNameEdit->text());
+
+    startWorker(criteria);
+
+    // Switch to results tab
+    m_tabWidget->setCurrentWidget(m_resultsTab);
+}
+
+// Options as set in the dialog. What is invalid is reported in a message
+// box, or in the status line while typing (`interactive`).
+bool SearchDialog::collectCriteria(SearchCriteria& criteria, bool interactive)
+{
+    // Validate input
+    QString searchPath = m_searchInEdit->text().trimmed();
+    if (searchPath.isEmpty())
+        return rejectCriteria(tr("Please specify a directory to search in."), interactive);
+
+    QDir dir(searchPath);
+    if (!dir.exists())
+        return rejectCriteria(tr("The specified directory does not exist."), interactive);
 
     // ─────────────────────────────────────────────────────────
     // Prepare search criteria
     // ─────────────────────────────────────────────────────────
-    SearchCriteria criteria;
     criteria.searchPath = searchPath;
 
     // File name pattern
@@ -631,6 +864,35 @@ void SearchDialog::onStartSearch()
     criteria.textCaseSensitive = m_textCaseSensitiveCheck->isChecked();
     criteria.wholeWords = m_wholeWordsCheck->isChecked();
     criteria.negateContainingText = m_negateContainingTextCheck->isChecked();
+    for (const QString& line : m_containingTermsEdit->toPlainText().split('\n')) {
+        QString term = line.trimmed();
+        if (!term.isEmpty())
+            criteria.containingTerms.append(term);
+    }
+    criteria.textRegex = m_textRegexCheck->isChecked();
+    criteria.textHex = m_textHexCheck->isChecked();
+    if (criteria.textHex) {
+        QStringList patterns = criteria.containingTerms;
+        if (!criteria.containingText.isEmpty())
+            patterns.prepend(criteria.containingText);
+        for (const QString& pattern : patterns) {
+            if (!search::HexPatternMatcher::isValid(pattern.toStdString())) {
+                return rejectCriteria(tr("Invalid hex pattern \"%1\": expected hex byte pairs or ??, "
+                                         "with at least one byte given").arg(pattern), interactive);
+            }
+        }
+    } else if (criteria.textRegex) {
+        QStringList patterns = criteria.containingTerms;
+        if (!criteria.containingText.isEmpty())
+            patterns.prepend(criteria.containingText);
+        for (const QString& pattern : patterns) {
+            QRegularExpression regex(pattern);
+            if (!regex.isValid()) {
+                return rejectCriteria(tr("Invalid regular expression \"%1\": %2").arg(pattern, regex.errorString()),
+                                      interactive);
+            }
+        }
+    }
 
     // File size
     bool ok;
@@ -678,10 +940,8 @@ void SearchDialog::onStartSearch()
     // Validate: file content filter requires files, conflicts with "directories only"
     if (criteria.fileContentFilter != FileContentFilter::Any) {
         if (criteria.itemTypeFilter == ItemTypeFilter::DirectoriesOnly) {
-            QMessageBox::warning(this, tr("Search"),
-                tr("Conflict: File content filter requires searching files, "
-                   "but 'Directories only' is selected on the Standard tab."));
-            return;
+            return rejectCriteria(tr("Conflict: File content filter requires searching files, "
+                                     "but 'Directories only' is selected on the Standard tab."), interactive);
         }
         // Force files-only when content filter is active
         criteria.itemTypeFilter = ItemTypeFilter::FilesOnly;
@@ -703,10 +963,58 @@ void SearchDialog::onStartSearch()
             break;
     }
 
-    // Search in results mode
-    criteria.searchInResults = searchInResults;
-    criteria.previousResultPaths = previousResults;
+    criteria.excludeDirs = m_excludeDirsEdit->text().trimmed();
+    criteria.respectIgnoreFiles = m_ignoreFilesCheck->isChecked();
+    criteria.oneFileSystem = m_oneFileSystemCheck->isChecked();
+    criteria.useIndex = m_useIndexCheck->isChecked();
+    switch (m_ioClassCombo->currentIndex()) {
+        case 1:
+            criteria.priority.ioClass = search::IoClass::BestEffort;
+            break;
+        case 2:
+            criteria.priority.ioClass = search::IoClass::Idle;
+            break;
+        default:
+            criteria.priority.ioClass = search::IoClass::Default;
+            break;
+    }
+    criteria.priority.ioLevel = m_ioLevelSpin->value();
+    criteria.priority.nice = m_niceSpin->value();
+    criteria.searchArchives = m_searchArchivesCheck->isChecked();
+
+    return true;
+}
+
+bool SearchDialog::rejectCriteria(const QString& message, bool interactive)
+{
+    if (interactive)
+        m_statusLabel->setText(message);
+    else
+        QMessageBox::warning(this, tr("Search"), message);
+    return false;
+}
+
+QVector<SearchHit> SearchDialog::currentResultsAsHits() const
+{
+    const int count = m_resultsModel->resultCount();
+    QVector<SearchHit> hits;
+    hits.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const SearchResult result = m_resultsModel->resultAt(i);
+        SearchHit hit;
+        hit.path = result.dir.endsWith('/') ? result.dir + result.name : result.dir + "/" + result.name;
+        hit.isDir = result.isDir;
+        hit.size = result.size;
+        hit.modifiedMs = result.modifiedTimestamp;
+        hit.matchedTerm = result.match;
+        hit.matchOffset = result.matchOffset;
+        hits.append(hit);
+    }
+    return hits;
+}
 
+void SearchDialog::startWorker(const SearchCriteria& criteria)
+{
     // ─────────────────────────────────────────────────────────
     // Create worker and thread
     // ─────────────────────────────────────────────────────────
@@ -716,36 +1024,80 @@ void SearchDialog::onStartSearch()
 
     // Connect signals
     connect(m_searchThread, &QThread::started, m_searchWorker, &SearchWorker::startSearch);
-    connect(m_searchWorker, &SearchWorker::resultFound, this, &SearchDialog::onResultFound);
+    connect(m_searchWorker, &SearchWorker::resultsFound, this, &SearchDialog::onResultsFound);
     connect(m_searchWorker, &SearchWorker::searchFinished, this, &SearchDialog::onSearchFinished);
-    connect(m_searchWorker, &SearchWorker::progressUpdate, this, &SearchDialog::onProgressUpdate);
 
     // Cleanup on finish
     connect(m_searchWorker, &SearchWorker::searchFinished, m_searchThread, &QThread::quit);
     connect(m_searchThread, &QThread::finished, m_searchWorker, &QObject::deleteLater);
     connect(m_searchThread, &QThread::finished, m_searchThread, &QObject::deleteLater);
 
+    m_runningCriteria = criteria;
+    m_runningCriteria.previousResults.clear();   // not needed to tell what ran
+    m_stopRequested = false;
+
     // Update UI
     m_startButton->setEnabled(false);
     m_stopButton->setEnabled(true);
+    m_pauseButton->setEnabled(true);
+    m_pauseButton->setText(tr("Pause"));
+    m_paused = false;
 
-    if (searchInResults) {
+    if (criteria.searchInResults) {
         m_statusLabel->setText(tr("Filtering results..."));
     } else {
         m_statusLabel->setText(tr("Searching..."));
     }
 
-    // Switch to results tab
-    m_tabWidget->setCurrentWidget(m_resultsTab);
-
     // Start search
     m_searchThread->start();
 }
 
+// Search as you type: the last complete walk's results are kept, and a
+// query they are sure to contain all matches of (SearchCriteria::narrows)
+// filters them instead of walking the disk again - "rep" -> "report", or a
+// filter added. Backspacing back to the walked query, or any step in
+// between, still filters the same set; only a broader query walks again
+// and so becomes the new base.
+void SearchDialog::onTypeQueryChanged()
+{
+    SearchCriteria criteria;
+    if (!collectCriteria(criteria, true))
+        return;
+
+    // The running search is replaced; this comes back once it stopped
+    if (m_searchWorker) {
+        m_typeRestartPending = true;
+        onStopSearch();
+        return;
+    }
+
+    if (m_hasTypeBase && criteria.narrows(m_typeBase)) {
+        criteria.searchInResults = true;
+        criteria.previousResults = m_typeCandidates;
+        criteria.keepPreviousMatches = criteria.sameContentCriteria(m_typeBase);
+    }
+    m_resultsModel->clear();
+    m_foundCount = 0;
+
+    // Nothing narrows down to something: done without a worker (which
+    // would walk the disk for an empty list)
+    if (criteria.searchInResults && criteria.previousResults.isEmpty()) {
+        m_statusLabel->setText(tr("Search finished. Found %1 file(s).").arg(0));
+        m_hasResults = false;
+        m_searchInResultsCheck->setVisible(false);
+        m_feedToListboxButton->setEnabled(false);
+        return;
+    }
+    startWorker(criteria);
+}
+
 void SearchDialog::onStopSearch()
 {
-    if (m_searchWorker)
+    if (m_searchWorker) {
+        m_stopRequested = true;
         m_searchWorker->stopSearch();
+    }
 
     // Enable "Feed to listbox" button if we have any results (even if search was interrupted)
     int currentCount = m_resultsModel->resultCount();
@@ -756,33 +1108,68 @@ void SearchDialog::onStopSearch()
     }
 }
 
-void SearchDialog::onResultFound(const QString& path, qint64 size, const QDateTime& modified)
+// The worker's threads are parked with their state, so nothing is lost
+// while paused; Stop also ends a paused search.
+void SearchDialog::onPauseSearch()
 {
-    // Add result to model - just raw data, no sorting yet
-    m_resultsModel->addResult(path, size, modified.toMSecsSinceEpoch());
+    if (!m_searchWorker)
+        return;
+
+    m_paused = !m_paused;
+    if (m_paused) {
+        m_searchWorker->pauseSearch();
+        m_pauseButton->setText(tr("Resume"));
+        m_statusLabel->setText(tr("Paused - ") + m_statusLabel->text());
+    } else {
+        m_searchWorker->resumeSearch();
+        m_pauseButton->setText(tr("Pause"));
+    }
 }
 
-void SearchDialog::onProgressUpdate(int searchedFiles, int foundFiles)
+void SearchDialog::onResultsFound(const QVector<SearchHit>& hits, int searchedFiles, int foundFiles)
 {
-    m_statusLabel->setText(tr("Searched %1 files, found %2").arg(searchedFiles).arg(foundFiles));
+    // Add results to model - just raw data, no sorting yet
+    m_resultsModel->addResults(hits);
+    // Batches sent just before a pause may still arrive
+    const QString progress = tr("Searched %1 files, found %2").arg(searchedFiles).arg(foundFiles);
+    m_statusLabel->setText(m_paused ? tr("Paused - ") + progress : progress);
 }
 
 void SearchDialog::onSearchFinished()
 {
     m_startButton->setEnabled(true);
     m_stopButton->setEnabled(false);
+    m_pauseButton->setEnabled(false);
+    m_pauseButton->setText(tr("Pause"));
+    m_paused = false;
 
     // Get final count from model
     int finalCount = m_resultsModel->resultCount();
     m_statusLabel->setText(tr("Search finished. Found %1 file(s).").arg(finalCount));
 
+    // Results arrive unordered from the parallel walk - order them once by path
+    if (m_sortResultsCheck->isChecked() && finalCount > 0)
+        m_resultsView->sortByColumn(SearchResultsModel::ColumnDir, Qt::AscendingOrder);
+
     // Show "Search in results" checkbox and enable "Feed to listbox" if we have results
     m_hasResults = (finalCount > 0);
     m_searchInResultsCheck->setVisible(m_hasResults);
     m_feedToListboxButton->setEnabled(m_hasResults);
 
+    // A complete walk is what search as you type narrows down
+    if (!m_stopRequested && !m_runningCriteria.searchInResults) {
+        m_typeBase = m_runningCriteria;
+        m_typeCandidates = currentResultsAsHits();
+        m_hasTypeBase = true;
+    }
+
     m_searchWorker = nullptr;
     m_searchThread = nullptr;
+
+    if (m_typeRestartPending) {
+        m_typeRestartPending = false;
+        onTypeQueryChanged();
+    }
 }
 
 void SearchDialog::onResultActivated(int row)
@@ -837,7 +1224,12 @@ bool SearchDialog::doView(QObject *obj, QKeyEvent *keyEvent) {
     if (!info.isFile())
         return true;
 
-    emit requestView(fullPath);
+    // Hex pattern hits open where they matched
+    const SearchResult result = m_resultsModel->resultAt(m_resultsView->currentIndex().row());
+    if (result.matchOffset >= 0)
+        emit requestViewAt(fullPath, result.matchOffset);
+    else
+        emit requestView(fullPath);
     return true;
 }
 
@@ -859,9 +1251,12 @@ void SearchDialog::onResetOptions()
     m_partOfNameCheck->setChecked(true);
     m_negateFileNameCheck->setChecked(false);
     m_itemTypeCombo->setCurrentIndex(0);  // Files and directories
+    m_searchArchivesCheck->setChecked(false);
     m_containingTextEdit->clear();
     m_textCaseSensitiveCheck->setChecked(false);
     m_wholeWordsCheck->setChecked(false);
+    m_textRegexCheck->setChecked(false);
+    m_textHexCheck->setChecked(false);
     m_negateContainingTextCheck->setChecked(false);
     m_searchInResultsCheck->setChecked(false);
 
@@ -870,6 +1265,15 @@ void SearchDialog::onResetOptions()
     m_maxSizeEdit->clear();
     m_fileContentFilterCombo->setCurrentIndex(0);  // Any
     m_executableBitsCombo->setCurrentIndex(0);     // Not specified
+    m_containingTermsEdit->clear();
+    m_sortResultsCheck->setChecked(true);
+    m_excludeDirsEdit->clear();
+    m_ignoreFilesCheck->setChecked(false);
+    m_oneFileSystemCheck->setChecked(false);
+    m_ioClassCombo->setCurrentIndex(0);            // Normal
+    m_ioLevelSpin->setValue(7);
+    m_niceSpin->setValue(0);
+    m_useIndexCheck->setChecked(true);
 
     // Switch to Standard tab
     m_tabWidget->setCurrentWidget(m_standardTab);
@@ -883,6 +1287,9 @@ void SearchDialog::onClearAll()
     // Clear results
     m_resultsModel->clear();
     m_hasResults = false;
+    m_typeCandidates.clear();
+    m_hasTypeBase = false;
+    m_typeQueryEdit->clear();
     m_searchInResultsCheck->setVisible(false);
     m_feedToListboxButton->setEnabled(false);
     m_statusLabel->setText(tr("Ready"));
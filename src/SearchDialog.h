@@ -5,24 +5,38 @@
 #include <QDialog>
 #include <QLabel>
 #include <QLineEdit>
+#include <QPlainTextEdit>
 #include <QPushButton>
+#include <QSpinBox>
 #include <QTabWidget>
 #include <QTableView>
 #include <QThread>
+#include <QTimer>
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QStringView>
 #include <QVector>
 
-class SearchWorker;
+#include "SearchWorker.h"
 
-// Raw search result data
+// One search result, as handed out by SearchResultsModel
 struct SearchResult {
     QString dir;   // directory path
     QString name;  // file/directory name
     qint64 size;
     qint64 modifiedTimestamp;  // QDateTime as msecsSinceEpoch for efficient sorting
+    QString match;             // term that matched a "containing text" search
+    qint64 matchOffset = -1;   // where a hex pattern matched, -1 otherwise
+    bool isDir = false;
 };
 
 // Custom model for search results - memory efficient, sortable
+//
+// Results are stored as fixed-size rows: parent directories and matched
+// terms are interned (a search usually finds many files per directory and
+// few distinct terms), and names are kept back to back in one string. Sorting
+// works on a permutation of the rows and runs in the background on several
+// threads; the view keeps showing the previous order until it is done.
 class SearchResultsModel : public QAbstractTableModel {
     Q_OBJECT
 
@@ -32,7 +46,8 @@ public:
         ColumnName = 1,
         ColumnSize = 2,
         ColumnModified = 3,
-        ColumnCount = 4
+        ColumnMatch = 4,
+        ColumnCount = 5
     };
 
     explicit SearchResultsModel(QObject* parent = nullptr);
@@ -47,19 +62,42 @@ public:
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
     // Data management
-    void addResult(const QString& path, qint64 size, qint64 modifiedTimestamp);
+    void addResults(const QVector<SearchHit>& hits);
     void clear();
-    int resultCount() const { return m_results.size(); }
-    const SearchResult& resultAt(int row) const;
+    int resultCount() const { return m_rows.size(); }
+    SearchResult resultAt(int row) const;
 
 private:
-    QVector<SearchResult> m_results;
-    QVector<int> m_sortedIndices;  // Indices into m_results (for sorting without moving data)
+    struct Row {
+        quint32 dir;          // index into m_dirs
+        quint32 match;        // index into m_matches
+        quint32 nameOffset;   // name is m_names[nameOffset, nameOffset + nameLength)
+        quint16 nameLength;   // a single path component, far below 64K
+        bool isDir;
+        qint64 size;
+        qint64 modified;      // msecs since epoch
+        qint64 matchOffset;   // -1 unless a hex pattern matched
+    };
+
+    const Row& rowAt(int row) const { return m_rows[m_sortedIndices.isEmpty() ? row : m_sortedIndices[row]]; }
+    QStringView nameOf(const Row& row) const;
+    static quint32 intern(QVector<QString>& table, QHash<QString, quint32>& index, const QString& s);
+    static QVector<int> sortedOrder(const QVector<Row>& rows, const QString& names, const QVector<QString>& dirs,
+                                    const QVector<QString>& matches, int column, Qt::SortOrder order);
+    void applyOrder(QVector<int> order);
+
+    QVector<Row> m_rows;
+    QString m_names;                          // all names, back to back
+    QVector<QString> m_dirs;                  // distinct directories
+    QHash<QString, quint32> m_dirIndex;
+    QVector<QString> m_matches;               // distinct matched terms, [0] is ""
+    QHash<QString, quint32> m_matchIndex;
+    QVector<int> m_sortedIndices;             // view row -> index into m_rows; empty = unsorted
+    int m_sortedRows = 0;                     // rows in order; later ones were appended unsorted
     int m_sortColumn = -1;
     Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
-    bool m_isSorted = false;
+    quint64 m_sortRequest = 0;                // bumped by sort() and clear(); older sorts are dropped
 
-    void updateSortedIndices();
     QString formatSize(qint64 size) const;
     QString formatDateTime(qint64 timestamp) const;
 };
@@ -82,18 +120,20 @@ public:
 signals:
     void requestEdit(const QString& filePath);
     void requestView(const QString& filePath);
+    void requestViewAt(const QString& filePath, qint64 offset);
     void requestGoToFile(const QString& dir, const QString& name);
     void requestFeedToListbox(const QVector<SearchResult>& results, const QString& searchPath);
 
 private slots:
     void onStartSearch();
     void onStopSearch();
+    void onPauseSearch();
     void onResetOptions();
     void onClearAll();
-    void onResultFound(const QString& path, qint64 size, const QDateTime& modified);
+    void onResultsFound(const QVector<SearchHit>& hits, int searchedFiles, int foundFiles);
     void onSearchFinished();
-    void onProgressUpdate(int searchedFiles, int foundFiles);
     void onResultActivated(int row);
+    void onTypeQueryChanged();
 
 private:
     void setupUi();
@@ -101,6 +141,11 @@ private:
     void createAdvancedTab();
     void createResultsTab();
 
+    bool collectCriteria(SearchCriteria& criteria, bool interactive);
+    bool rejectCriteria(const QString& message, bool interactive);
+    QVector<SearchHit> currentResultsAsHits() const;
+    void startWorker(const SearchCriteria& criteria);
+
     // UI elements
     QTabWidget* m_tabWidget;
 
@@ -113,9 +158,12 @@ private:
     QComboBox* m_itemTypeCombo;
     QCheckBox* m_partOfNameCheck;
     QCheckBox* m_negateFileNameCheck;
+    QCheckBox* m_searchArchivesCheck;
     QLineEdit* m_containingTextEdit;
     QCheckBox* m_textCaseSensitiveCheck;
     QCheckBox* m_wholeWordsCheck;
+    QCheckBox* m_textRegexCheck;
+    QCheckBox* m_textHexCheck;
     QCheckBox* m_negateContainingTextCheck;
     QCheckBox* m_searchInResultsCheck;
 
@@ -130,16 +178,38 @@ private:
     // File attributes group
     QComboBox* m_executableBitsCombo;
 
+    // Additional text terms (one per line)
+    QPlainTextEdit* m_containingTermsEdit;
+
+    // Results group
+    QCheckBox* m_sortResultsCheck;
+
+    // Traversal group
+    QLineEdit* m_excludeDirsEdit;
+    QCheckBox* m_ignoreFilesCheck;
+    QCheckBox* m_oneFileSystemCheck;
+
+    // Priority group
+    QComboBox* m_ioClassCombo;
+    QSpinBox* m_ioLevelSpin;
+    QSpinBox* m_niceSpin;
+
+    // Filename index group
+    QCheckBox* m_useIndexCheck;
+
     // Results tab
     QWidget* m_resultsTab;
     QTableView* m_resultsView;
     SearchResultsModel* m_resultsModel;
     QLabel* m_statusLabel;
     QPushButton* m_feedToListboxButton;
+    QLineEdit* m_typeQueryEdit;
+    QTimer* m_typeTimer;
 
     // Control buttons
     QPushButton* m_startButton;
     QPushButton* m_stopButton;
+    QPushButton* m_pauseButton;
     QPushButton* m_resetButton;
     QPushButton* m_clearButton;
     QPushButton* m_closeButton;
@@ -151,4 +221,16 @@ private:
     QString m_startPath;
     int m_foundCount;
     bool m_hasResults;  // Track if we have previous results (for search-in-results mode)
+    bool m_paused = false;
+
+    SearchCriteria m_runningCriteria;     // of the search in progress or last run, without previous results
+    bool m_stopRequested = false;         // the running search was stopped, its results are partial
+
+    // Search as you type
+    SearchCriteria m_typeBase;            // the last complete walk
+    QVector<SearchHit> m_typeCandidates;  // and what it found
+    bool m_hasTypeBase = false;
+    bool m_typeRestartPending = false;    // search again once the running search stopped
+
+    static constexpr int TypeDelayMs = 250;
 };
\ No newline at end of file
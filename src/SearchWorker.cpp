@@ -1,193 +1,591 @@
 #include "SearchWorker.h"
-#include "SortedDirIterator.h"
+#include "NameIndexService.h"
 #include "quitls.h"
-
+#include "search/FileScanner.h"
+#include "search/HexPattern.h"
+#include "search/LiteralMatcher.h"
+#include "search/MultiLiteralMatcher.h"
+#include "search/NameIndex.h"
+#include "search/RegexLiterals.h"
+#include "search/TrigramIndex.h"
+#include "search/ParallelWalker.h"
+
+#include <QBuffer>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
 #include <QRegularExpression>
 
+#include <algorithm>
+
+#include <sys/stat.h>
+
+namespace {
+
+bool hasWildcards(const QString& pattern)
+{
+    return pattern.contains('*') || pattern.contains('?') || pattern.contains('[') || pattern.contains(';');
+}
+
+// True if every name `next` matches, `previous` matches too
+bool narrowsFileName(const SearchCriteria& next, const SearchCriteria& previous)
+{
+    if (previous.fileNamePattern == "*" && !previous.negateFileName)
+        return true;
+    if (next.negateFileName != previous.negateFileName)
+        return false;
+    if (next.fileNamePattern == previous.fileNamePattern && next.partOfName == previous.partOfName &&
+        (next.fileNameCaseSensitive || !previous.fileNameCaseSensitive))
+        return true;
+
+    // A name containing the longer part contains the shorter one
+    if (next.negateFileName || !next.partOfName || !previous.partOfName ||
+        hasWildcards(next.fileNamePattern) || hasWildcards(previous.fileNamePattern))
+        return false;
+    if (previous.fileNameCaseSensitive)
+        return next.fileNameCaseSensitive && next.fileNamePattern.contains(previous.fileNamePattern);
+    return next.fileNamePattern.contains(previous.fileNamePattern, Qt::CaseInsensitive);
+}
+
+bool hasTextCriteria(const SearchCriteria& criteria)
+{
+    return !criteria.containingText.isEmpty() || !criteria.containingTerms.isEmpty();
+}
+
+bool sameTextCriteria(const SearchCriteria& a, const SearchCriteria& b)
+{
+    return a.containingText == b.containingText && a.containingTerms == b.containingTerms &&
+           a.textCaseSensitive == b.textCaseSensitive && a.wholeWords == b.wholeWords &&
+           a.negateContainingText == b.negateContainingText && a.textRegex == b.textRegex &&
+           a.textHex == b.textHex;
+}
+
+} // anonymous namespace
+
+bool SearchCriteria::narrows(const SearchCriteria& previous) const
+{
+    // The same files must have been walked
+    if (searchPath != previous.searchPath || excludeDirs != previous.excludeDirs ||
+        respectIgnoreFiles != previous.respectIgnoreFiles || oneFileSystem != previous.oneFileSystem ||
+        searchArchives != previous.searchArchives)
+        return false;
+
+    if (!narrowsFileName(*this, previous))
+        return false;
+
+    if (previous.minSize >= 0 && minSize < previous.minSize)
+        return false;
+    if (previous.maxSize >= 0 && (maxSize < 0 || maxSize > previous.maxSize))
+        return false;
+    if (itemTypeFilter != previous.itemTypeFilter && previous.itemTypeFilter != ItemTypeFilter::FilesAndDirectories)
+        return false;
+
+    // Content filters can be added, but archive members cannot be read
+    // again from a previous result
+    if (searchArchives)
+        return sameContentCriteria(previous);
+    if (!sameTextCriteria(*this, previous) && hasTextCriteria(previous))
+        return false;
+    if (fileContentFilter != previous.fileContentFilter && previous.fileContentFilter != FileContentFilter::Any)
+        return false;
+    if (executableBits != previous.executableBits &&
+        previous.executableBits != ExecutableBitsFilter::NotSpecified)
+        return false;
+    return true;
+}
+
+bool SearchCriteria::sameContentCriteria(const SearchCriteria& previous) const
+{
+    return sameTextCriteria(*this, previous) && fileContentFilter == previous.fileContentFilter &&
+           executableBits == previous.executableBits;
+}
+
 SearchWorker::SearchWorker(const SearchCriteria& criteria, QObject* parent)
     : QObject(parent)
     , m_criteria(criteria)
     , m_shouldStop(false)
 {
-    // Convert wildcard pattern to regex
-    QString pattern = m_criteria.fileNamePattern;
-    if (pattern.isEmpty())
-        pattern = "*";
-
-    // Add wildcards for "part of name" mode
-    if (m_criteria.partOfName && !pattern.startsWith("*"))
-        pattern = "*" + pattern;
-    if (m_criteria.partOfName && !pattern.endsWith("*"))
-        pattern = pattern + "*";
-
-    // Escape special regex chars and convert wildcards
-    pattern.replace("\\", "\\\\");
-    pattern.replace(".", "\\.");
-    pattern.replace("*", ".*");
-    pattern.replace("?", ".");
-    pattern = "^" + pattern + "$";
+    qRegisterMetaType<QVector<SearchHit>>("QVector<SearchHit>");
+    m_sinceFlush.start();
+
+    m_fileNameMask = NameMask(m_criteria.fileNamePattern, m_criteria.fileNameCaseSensitive, m_criteria.partOfName);
+
+    // Unlike the name mask, an empty exclude list excludes nothing
+    const QByteArray excludeDirs = QFile::encodeName(m_criteria.excludeDirs);
+    m_hasExcludeDirs = !search::GlobMatcher::split(
+        std::string_view(excludeDirs.constData(), static_cast<std::size_t>(excludeDirs.size()))).empty();
+    if (m_hasExcludeDirs)
+        m_excludeDirMask = NameMask(m_criteria.excludeDirs);
+
+    // Every matching name contains it, which lets the filename index skip
+    // most names without testing the mask
+    if (!m_criteria.negateFileName)
+        m_nameLiteral = m_fileNameMask.requiredLiteral();
+
+    // Containing text: the main text plus any extra terms; a file matches if
+    // it contains any of them. Matched on raw bytes whenever that is exact,
+    // i.e. unless a case-insensitive search has to fold non-ASCII characters.
+    if (!m_criteria.containingText.isEmpty())
+        m_textTerms.append(m_criteria.containingText);
+    for (const QString& term : m_criteria.containingTerms) {
+        if (!term.isEmpty() && !m_textTerms.contains(term))
+            m_textTerms.append(term);
+    }
 
-    QRegularExpression::PatternOption option = m_criteria.fileNameCaseSensitive
-        ? QRegularExpression::NoPatternOption
-        : QRegularExpression::CaseInsensitiveOption;
+    if (!m_textTerms.isEmpty() && m_criteria.textHex) {
+        // Hex mode: raw bytes only, never decoded. No literals for the
+        // content index either - it only holds trigrams of text.
+        std::vector<std::string> patterns;
+        for (const QString& term : m_textTerms)
+            patterns.push_back(term.toStdString());
+        m_textMatcher = std::make_shared<search::HexPatternMatcher>(patterns);
+    } else if (!m_textTerms.isEmpty() && m_criteria.textRegex) {
+        // Regex mode: all terms form one alternation. Literal fragments every
+        // match must contain serve as a byte-level prefilter, and the regex
+        // only runs on the lines where one of them occurs.
+        QString regexPattern = m_textTerms.first();
+        if (m_textTerms.size() > 1) {
+            QStringList groups;
+            for (const QString& term : m_textTerms)
+                groups.append("(?:" + term + ")");
+            regexPattern = groups.join('|');
+        }
+        if (m_criteria.wholeWords)
+            regexPattern = "\\b(?:" + regexPattern + ")\\b";
+        m_contentRegex = QRegularExpression(regexPattern, m_criteria.textCaseSensitive
+            ? QRegularExpression::NoPatternOption
+            : QRegularExpression::CaseInsensitiveOption);
+
+        const QByteArray utf8 = regexPattern.toUtf8();
+        std::vector<std::string> literals =
+            search::requiredLiterals(std::string_view(utf8.constData(), static_cast<std::size_t>(utf8.size())));
+        bool bytesExact = !literals.empty();
+        for (const std::string& literal : literals)
+            bytesExact = bytesExact && search::LiteralMatcher::supports(literal, m_criteria.textCaseSensitive);
+
+        if (bytesExact && literals.size() == 1)
+            m_textMatcher = std::make_shared<search::LiteralMatcher>(literals.front(), m_criteria.textCaseSensitive);
+        else if (bytesExact)
+            m_textMatcher = std::make_shared<search::MultiLiteralMatcher>(literals, m_criteria.textCaseSensitive);
+        if (bytesExact)
+            m_textLiterals = std::move(literals);
+    } else if (!m_textTerms.isEmpty()) {
+        std::vector<std::string> needles;
+        bool bytesExact = true;
+        for (const QString& term : m_textTerms) {
+            const QByteArray utf8 = term.toUtf8();
+            needles.emplace_back(utf8.constData(), static_cast<std::size_t>(utf8.size()));
+            bytesExact = bytesExact && search::LiteralMatcher::supports(needles.back(), m_criteria.textCaseSensitive);
+        }
 
-    m_fileNameRegex = QRegularExpression(pattern, option);
+        if (bytesExact && needles.size() == 1)
+            m_textMatcher = std::make_shared<search::LiteralMatcher>(needles.front(), m_criteria.textCaseSensitive);
+        else if (bytesExact)
+            m_textMatcher = std::make_shared<search::MultiLiteralMatcher>(needles, m_criteria.textCaseSensitive);
+        if (bytesExact)
+            m_textLiterals = std::move(needles);
+
+        if (m_criteria.wholeWords) {
+            for (const QString& term : m_textTerms) {
+                QString wordPattern = "\\b" + QRegularExpression::escape(term) + "\\b";
+                m_wholeWordRegexes.append(QRegularExpression(wordPattern, m_criteria.textCaseSensitive
+                    ? QRegularExpression::NoPatternOption
+                    : QRegularExpression::CaseInsensitiveOption));
+            }
+        }
+    }
 }
 
 void SearchWorker::startSearch()
 {
     m_shouldStop = false;
+    enterSearchThread();
 
     // ─────────────────────────────────────────────────────────
     // MODE 1: Search in results
     // ─────────────────────────────────────────────────────────
-    if (m_criteria.searchInResults && !m_criteria.previousResultPaths.isEmpty()) {
-        int searchedFiles = 0;
-        int foundFiles = 0;
-
-        for (const QString& path : m_criteria.previousResultPaths) {
-            if (m_shouldStop)
-                break;
-
-            QFileInfo info(path);
-            if (!info.exists())
-                continue;
-
-            searchedFiles++;
-
-            // Update progress periodically
-            if (searchedFiles % 100 == 0)
-                emit progressUpdate(searchedFiles, foundFiles);
-
-            bool isDir = info.isDir();
-            bool isFile = info.isFile();
-
-            // Apply all filters
-            if (!matchesItemType(isDir, isFile))
-                continue;
-
-            // Filename pattern (with negation)
-            bool nameMatches = matchesFileName(info.fileName());
-            if (m_criteria.negateFileName)
-                nameMatches = !nameMatches;
-            if (!nameMatches)
-                continue;
-
-            // Size filter (files only)
-            if (isFile && !matchesFileSize(info.size()))
-                continue;
-
-            // Text content filter (files only, directories cannot contain text)
-            if (!m_criteria.containingText.isEmpty()) {
-                if (isDir)
-                    continue;  // Directories cannot contain text
-                bool textMatches = matchesContainingText(info.absoluteFilePath());
-                if (m_criteria.negateContainingText)
-                    textMatches = !textMatches;
-                if (!textMatches)
-                    continue;
-            }
-
-            // File content filter (files only)
-            if (isFile && !matchesFileContentFilter(info.absoluteFilePath(), info.size()))
-                continue;
-
-            // Executable bits filter
-            if (!matchesExecutableBits(info.absoluteFilePath()))
-                continue;
-
-            // All filters passed
-            foundFiles++;
-            emit resultFound(info.absoluteFilePath(), info.size(), info.lastModified());
-        }
-
-        emit progressUpdate(searchedFiles, foundFiles);
+    if (m_criteria.searchInResults && !m_criteria.previousResults.isEmpty()) {
+        searchPreviousResults();
         emit searchFinished();
         return;
     }
 
     // ─────────────────────────────────────────────────────────
-    // MODE 2: Normal filesystem search
+    // MODE 2: Filename index
+    // ─────────────────────────────────────────────────────────
+    // The index records neither ignore files nor mount points, so those
+    // options need the real tree
+    if (m_criteria.useIndex && !m_criteria.respectIgnoreFiles && !m_criteria.oneFileSystem) {
+        std::string relPath;
+        std::shared_ptr<search::LiveNameIndex> index =
+            NameIndexService::instance().indexFor(m_criteria.searchPath, &relPath);
+        if (index && index->hasDirectory(relPath)) {
+            searchIndex(*index, relPath);
+            emit searchFinished();
+            return;
+        }
+    }
+
     // ─────────────────────────────────────────────────────────
-    QDir::Filters filters = QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden;
+    // MODE 3: Normal filesystem search
+    // ─────────────────────────────────────────────────────────
+    // The tree is walked by a pool of workers (see ParallelWalker), and each
+    // worker runs the filters - content matching included - on the entries it
+    // reads, so traversal and content search overlap. Results are therefore
+    // reported in no particular order; SearchDialog sorts them at the end.
+    search::WalkOptions options;
+    options.threads = m_criteria.threads > 0 ? static_cast<unsigned>(m_criteria.threads) : 0;
+    options.cancel = &m_shouldStop;
+    options.pause = &m_pause;
+    options.oneFileSystem = m_criteria.oneFileSystem;
+    options.ignoreFiles = m_criteria.respectIgnoreFiles;
+    search::ParallelWalker walker(options);
+
+    // What the result row and the filters need from a stat; everything else
+    // is decided from d_type and the name, so most entries are never stat()ed
+    unsigned statFields = search::StatSize | search::StatMtime;
+    if (m_criteria.executableBits != SearchCriteria::ExecutableBitsFilter::NotSpecified)
+        statFields |= search::StatMode;
+
+    walker.run(QFile::encodeName(m_criteria.searchPath).toStdString(),
+               [&](const search::WalkEntry& entry) {
+        enterSearchThread();
+        const bool isLink = entry.type == search::EntryType::Symlink;
+        bool isDir = entry.type == search::EntryType::Directory;
+        bool isFile = entry.type == search::EntryType::File;
+        // Excluded directories are pruned here, before they are read
+        if (isDir && isExcludedDir(entry.name))
+            return search::VisitResult::SkipDirectory;
+        if ((isFile || isDir) && ++m_searchedFiles % 1000 == 0)
+            flushResults(false);
+
+        if (isFile && m_criteria.searchArchives) {
+            const QString name = QFile::decodeName(QByteArray(entry.name.data(), static_cast<int>(entry.name.size())));
+            if (isSearchableArchive(name))
+                searchArchive(QFile::decodeName(QByteArray::fromStdString(entry.path())));
+        }
+
+        // Filename pattern (with negation), tested on the raw name
+        bool nameMatches = m_fileNameMask.matches(entry.name);
+        if (m_criteria.negateFileName)
+            nameMatches = !nameMatches;
+        if (!nameMatches)
+            return search::VisitResult::Continue;
+
+        // Type filters need no stat unless the entry is a symlink, which
+        // counts as what it points to
+        if (!isLink && (!matchesItemType(isDir, isFile) || (isDir && !m_textTerms.isEmpty())))
+            return search::VisitResult::Continue;
+
+        search::EntryStat st;
+        if (!search::statEntry(entry, isLink ? statFields | search::StatType : statFields, st))
+            return search::VisitResult::Continue;
+        if (isLink) {
+            isDir = st.type == search::EntryType::Directory;
+            isFile = st.type == search::EntryType::File;
+            if (isFile || isDir)
+                ++m_searchedFiles;
+        }
+
+        const QString path = QFile::decodeName(QByteArray::fromStdString(entry.path()));
+        QString matchedTerm;
+        qint64 matchOffset = -1;
+        if (!matchesEntry(path, isDir, isFile, static_cast<qint64>(st.size), st.mode, &matchedTerm, &matchOffset))
+            return search::VisitResult::Continue;
+
+        // All filters passed
+        addResult(path, isDir, static_cast<qint64>(st.size), st.mtimeNs / 1000000, matchedTerm, matchOffset);
+        return search::VisitResult::Continue;
+    });
+
+    flushResults(true);
+    emit searchFinished();
+}
+
+// Narrow the previous results. Their type, size and time are taken as they
+// were found, so nothing is stat()ed again - only the content and
+// executable filters touch the files, and not even those when the previous
+// results were found with the same ones (keepPreviousMatches). The results
+// are checked in chunks on a thread pool, which reports through addResult()
+// like the walker does.
+void SearchWorker::searchPreviousResults()
+{
+    const QVector<SearchHit>& previous = m_criteria.previousResults;
+    QVector<QPair<int, int>> chunks;
+    for (int begin = 0; begin < previous.size(); begin += PreviousResultsChunk)
+        chunks.append({begin, qMin(begin + PreviousResultsChunk, static_cast<int>(previous.size()))});
+
+    QThreadPool pool;
+    if (m_criteria.threads > 0)
+        pool.setMaxThreadCount(m_criteria.threads);
+    QtConcurrent::blockingMap(&pool, chunks, [this, &previous](const QPair<int, int>& chunk) {
+        for (int i = chunk.first; i < chunk.second && !m_shouldStop; ++i)
+            filterPreviousResult(previous[i]);
+    });
+
+    flushResults(true);
+}
+
+void SearchWorker::filterPreviousResult(const SearchHit& previous)
+{
+    enterSearchThread();
+    if (++m_searchedFiles % 100 == 0)
+        flushResults(false);
+
+    // Filename pattern (with negation)
+    bool nameMatches = matchesFileName(previous.path.mid(previous.path.lastIndexOf('/') + 1));
+    if (m_criteria.negateFileName)
+        nameMatches = !nameMatches;
+    if (!nameMatches)
+        return;
 
-    SortedDirIterator it(m_criteria.searchPath, filters);
+    // Only the name, size and type can have become stricter; the match found
+    // before stands
+    if (m_criteria.keepPreviousMatches) {
+        if (!matchesItemType(previous.isDir, !previous.isDir) || (!previous.isDir && !matchesFileSize(previous.size)))
+            return;
+        addResult(previous.path, previous.isDir, previous.size, previous.modifiedMs, previous.matchedTerm,
+                  previous.matchOffset);
+        return;
+    }
 
-    int searchedFiles = 0;
-    int foundFiles = 0;
+    // An archive member ("x.zip/inner/file") cannot be read again from its
+    // path, so it cannot be shown to pass new content filters
+    const bool readsContent = !m_textTerms.isEmpty() || m_criteria.fileContentFilter != FileContentFilter::Any;
+    if (readsContent && m_criteria.searchArchives && !previous.isDir && !QFileInfo(previous.path).isFile())
+        return;
 
-    while (it.hasNext() && !m_shouldStop) {
-        QFileInfo info = it.next();
+    QString matchedTerm;
+    qint64 matchOffset = -1;
+    if (!matchesEntry(previous.path, previous.isDir, !previous.isDir, previous.size, 0, &matchedTerm, &matchOffset))
+        return;
 
-        bool isDir = info.isDir();
-        bool isFile = info.isFile();
+    addResult(previous.path, previous.isDir, previous.size, previous.modifiedMs, matchedTerm, matchOffset);
+}
 
-        if (isFile || isDir)
-            searchedFiles++;
+// Enumerate candidates from the filename index instead of the disk. Names
+// are tested first, on the index alone; only entries whose name matches are
+// looked at on disk. Their size and time are re-read as well, because the
+// directory watcher does not see files modified in place - and an entry
+// that no longer exists is dropped. When the root also has a content index,
+// files it rules out for the containing text are not read at all.
+void SearchWorker::searchIndex(const search::LiveNameIndex& index, const std::string& relPath)
+{
+    std::shared_ptr<const search::TrigramFilter> contentFilter;
+    if (!m_textLiterals.empty()) {
+        if (auto content = NameIndexService::instance().contentIndex(index.root()))
+            contentFilter = content->filter(m_textLiterals);
+    }
 
-        // Update progress periodically
-        if (searchedFiles % 1000 == 0)
-            emit progressUpdate(searchedFiles, foundFiles);
+    search::IndexQuery query;
+    query.subtree = relPath;
+    query.literal = m_nameLiteral;
+    query.caseSensitive = m_criteria.fileNameCaseSensitive;
+    query.threads = m_criteria.threads > 0 ? static_cast<unsigned>(m_criteria.threads) : 0;
+    query.cancel = &m_shouldStop;
+
+    const QString root = QFile::decodeName(QByteArray::fromStdString(index.root()));
+    const QString rootPrefix = root.endsWith('/') ? root : root + '/';
+
+    index.query(query, [&](const search::IndexEntry& entry) {
+        enterSearchThread();
+        // The index holds excluded directories too; their entries are
+        // dropped by path, which costs no I/O
+        if (m_hasExcludeDirs) {
+            std::string_view below = entry.dirPath;
+            below.remove_prefix(std::min(below.size(), relPath.size()));
+            if (hasExcludedDir(below) ||
+                (entry.type == search::EntryType::Directory && isExcludedDir(entry.name)))
+                return true;
+        }
 
-        // Item type filter
-        if (!matchesItemType(isDir, isFile))
-            continue;
+        if ((entry.type == search::EntryType::File || entry.type == search::EntryType::Directory) &&
+            ++m_searchedFiles % 1000 == 0)
+            flushResults(false);
+
+        if (entry.type == search::EntryType::File && m_criteria.searchArchives) {
+            const QString name = QFile::decodeName(QByteArray(entry.name.data(), static_cast<int>(entry.name.size())));
+            if (isSearchableArchive(name)) {
+                QString archivePath = rootPrefix;
+                if (!entry.dirPath.empty())
+                    archivePath += QFile::decodeName(QByteArray(entry.dirPath.data(), static_cast<int>(entry.dirPath.size()))) + '/';
+                searchArchive(archivePath + name);
+            }
+        }
 
-        // Filename pattern (with negation)
-        bool nameMatches = matchesFileName(info.fileName());
+        bool nameMatches = m_fileNameMask.matches(entry.name);
         if (m_criteria.negateFileName)
             nameMatches = !nameMatches;
         if (!nameMatches)
-            continue;
-
-        // For files: check size, content, and advanced filters
-        if (isFile) {
-            // Size filter
-            if (!matchesFileSize(info.size()))
-                continue;
-
-            // Text content filter
-            if (!m_criteria.containingText.isEmpty()) {
-                bool textMatches = matchesContainingText(info.absoluteFilePath());
-                if (m_criteria.negateContainingText)
-                    textMatches = !textMatches;
-                if (!textMatches)
-                    continue;
-            }
+            return true;
 
-            // File content filter
-            if (!matchesFileContentFilter(info.absoluteFilePath(), info.size()))
-                continue;
-        } else if (isDir) {
-            // Directories cannot contain text - skip them when searching for text content
-            if (!m_criteria.containingText.isEmpty())
-                continue;
+        QString path = rootPrefix;
+        if (!entry.dirPath.empty()) {
+            path += QFile::decodeName(QByteArray(entry.dirPath.data(), static_cast<int>(entry.dirPath.size())));
+            path += '/';
         }
+        path += QFile::decodeName(QByteArray(entry.name.data(), static_cast<int>(entry.name.size())));
 
-        // Executable bits filter (applies to both files and directories)
-        if (!matchesExecutableBits(info.absoluteFilePath()))
-            continue;
+        // Follows symlinks, like QFileInfo in the filesystem search
+        struct stat st;
+        if (::stat(QFile::encodeName(path).constData(), &st) != 0)
+            return true;
+        const bool isDir = S_ISDIR(st.st_mode);
+        const bool isFile = S_ISREG(st.st_mode);
+
+        // The content index has the compressed bytes of compressed files
+        bool mayContainText = true;
+        if (contentFilter && isFile && !(m_criteria.searchArchives && isCompressedFile(path))) {
+            std::string entryPath(entry.dirPath);
+            if (!entryPath.empty())
+                entryPath += '/';
+            entryPath.append(entry.name);
+            mayContainText = contentFilter->mayContain(entryPath, st);
+        }
 
-        // All filters passed
-        foundFiles++;
-        emit resultFound(info.absoluteFilePath(), info.size(), info.lastModified());
-    }
+        QString matchedTerm;
+        qint64 matchOffset = -1;
+        if (!matchesEntry(path, isDir, isFile, st.st_size, st.st_mode, &matchedTerm, &matchOffset, mayContainText))
+            return true;
 
-    emit progressUpdate(searchedFiles, foundFiles);
-    emit searchFinished();
+        const qint64 mtimeMs = static_cast<qint64>(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+        addResult(path, isDir, st.st_size, mtimeMs, matchedTerm, matchOffset);
+        return true;
+    });
+
+    flushResults(true);
 }
 
 void SearchWorker::stopSearch()
 {
     m_shouldStop = true;
+    m_pause.resume();   // parked threads have to see the stop
+}
+
+void SearchWorker::pauseSearch()
+{
+    m_pause.pause();
+}
+
+void SearchWorker::resumeSearch()
+{
+    m_pause.resume();
+}
+
+// Called by every thread that does work for the search - this worker's own,
+// the walker's, the index query's and the pool's - before each entry: parks
+// it while the search is paused, and gives it the requested priority the
+// first time. All of these threads end with the search, so the priority
+// needs no undoing.
+void SearchWorker::enterSearchThread() const
+{
+    m_pause.wait();
+    if (m_criteria.priority.isDefault())
+        return;
+    thread_local const SearchWorker* prioritizedFor = nullptr;
+    if (prioritizedFor != this) {
+        search::applyToCurrentThread(m_criteria.priority);
+        prioritizedFor = this;
+    }
+}
+
+// Results are queued to the dialog in batches instead of one signal each:
+// a batch goes out once it is full or FlushIntervalMs after the previous
+// one, along with the progress counters, so a search with many hits costs
+// the GUI thread a few events per second instead of one per hit. Batches
+// are emitted under the lock, which keeps them (and the counters) in order
+// while several walker threads report.
+void SearchWorker::addResult(const QString& path, bool isDir, qint64 size, qint64 modifiedMs,
+                             const QString& matchedTerm, qint64 matchOffset)
+{
+    QMutexLocker locker(&m_pendingMutex);
+    m_pending.append({path, isDir, size, modifiedMs, matchedTerm, matchOffset});
+    ++m_foundFiles;
+    if (m_pending.size() >= BatchSize || m_sinceFlush.elapsed() >= FlushIntervalMs)
+        emitPending();
+}
+
+// Deliver what is pending if the interval has passed, or right away with
+// `force`. Called periodically while entries are searched, so progress
+// keeps moving when nothing is found.
+void SearchWorker::flushResults(bool force)
+{
+    QMutexLocker locker(&m_pendingMutex);
+    if (force || m_sinceFlush.elapsed() >= FlushIntervalMs)
+        emitPending();
+}
+
+void SearchWorker::emitPending()
+{
+    QVector<SearchHit> batch;
+    batch.swap(m_pending);
+    m_pending.reserve(BatchSize);
+    m_sinceFlush.restart();
+    emit resultsFound(batch, m_searchedFiles.load(), m_foundFiles.load());
+}
+
+// Every filter except the name pattern. `mayContainText` false means a
+// content index already ruled the file out for the containing text.
+bool SearchWorker::matchesEntry(const QString& filePath, bool isDir, bool isFile, qint64 size, quint32 mode,
+                                QString* matchedTerm, qint64* matchOffset, bool mayContainText) const
+{
+    // Item type filter
+    if (!matchesItemType(isDir, isFile))
+        return false;
+
+    // For files: check size, content, and advanced filters
+    if (isFile) {
+        // Size filter
+        if (!matchesFileSize(size))
+            return false;
+
+        // Text content filter
+        if (!m_textTerms.isEmpty()) {
+            bool textMatches = mayContainText && matchesContainingText(filePath, matchedTerm, matchOffset);
+            if (m_criteria.negateContainingText)
+                textMatches = !textMatches;
+            if (!textMatches)
+                return false;
+        }
+
+        // File content filter
+        if (!matchesFileContentFilter(filePath, size))
+            return false;
+    } else if (isDir) {
+        // Directories cannot contain text - skip them when searching for text content
+        if (!m_textTerms.isEmpty())
+            return false;
+    }
+
+    // Executable bits filter (applies to both files and directories)
+    return matchesExecutableBits(filePath, mode);
 }
 
 bool SearchWorker::matchesFileName(const QString& fileName) const
 {
-    return m_fileNameRegex.match(fileName).hasMatch();
+    return m_fileNameMask.matches(fileName);
+}
+
+bool SearchWorker::isExcludedDir(std::string_view name) const
+{
+    return m_hasExcludeDirs && m_excludeDirMask.matches(name);
+}
+
+// True if a directory of the '/'-separated relative path `relDir` is excluded
+bool SearchWorker::hasExcludedDir(std::string_view relDir) const
+{
+    while (!relDir.empty()) {
+        const std::size_t slash = relDir.find('/');
+        const std::string_view component = relDir.substr(0, slash);
+        if (!component.empty() && isExcludedDir(component))
+            return true;
+        if (slash == std::string_view::npos)
+            break;
+        relDir.remove_prefix(slash + 1);
+    }
+    return false;
 }
 
 bool SearchWorker::matchesFileSize(qint64 size) const
@@ -201,43 +599,213 @@ bool SearchWorker::matchesFileSize(qint64 size) const
     return true;
 }
 
-bool SearchWorker::matchesContainingText(const QString& filePath) const
+// Options for matching the containing text with m_textMatcher
+search::ScanOptions SearchWorker::textScanOptions(QString* matchedTerm) const
+{
+    search::ScanOptions options;
+    options.cancel = &m_shouldStop;
+    options.pause = &m_pause;
+    if (m_criteria.textRegex) {
+        // Prefilter hit: confirm with the full regex on that line
+        options.verifyLine = [this, matchedTerm](const char* line, std::size_t length) {
+            QRegularExpressionMatch match = m_contentRegex.match(QString::fromUtf8(line, static_cast<int>(length)));
+            if (!match.hasMatch())
+                return false;
+            if (matchedTerm)
+                *matchedTerm = match.captured(0);
+            return true;
+        };
+    } else if (m_criteria.textHex) {
+        options.rawBytes = true;
+    } else {
+        options.wholeWords = m_criteria.wholeWords;
+    }
+    return options;
+}
+
+// `matchOffset`, if given, receives where a hex pattern matched; text
+// matches leave it alone.
+bool SearchWorker::matchesContainingText(const QString& filePath, QString* matchedTerm, qint64* matchOffset) const
 {
+    if (m_criteria.searchArchives && isCompressedFile(filePath))
+        return matchesCompressedText(filePath, matchedTerm);
+
+    if (m_textMatcher) {
+        const search::ScanOptions options = textScanOptions(matchedTerm);
+        search::StreamMatch match;
+        switch (search::scanFile(QFile::encodeName(filePath).toStdString(), *m_textMatcher, options, &match)) {
+            case search::ScanStatus::Found:
+                if (matchedTerm && !m_criteria.textRegex)
+                    *matchedTerm = m_textTerms.value(match.pattern);
+                if (matchOffset && m_criteria.textHex)
+                    *matchOffset = static_cast<qint64>(match.offset);
+                return true;
+            case search::ScanStatus::NotFound:
+            case search::ScanStatus::Failed:
+                return false;
+            case search::ScanStatus::NeedsDecoding:
+                break;  // UTF-16/32 file, decode it below
+        }
+    }
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
         return false;
+    return matchesContainingTextDecoded(file, matchedTerm);
+}
 
-    QTextStream in(&file);
+// Slow path: decode the data line by line. Used for UTF-16/32 files, for
+// case-insensitive searches of non-ASCII text and for regexes without a
+// literal prefilter.
+bool SearchWorker::matchesContainingTextDecoded(QIODevice& device, QString* matchedTerm) const
+{
+    QTextStream in(&device);
     Qt::CaseSensitivity cs = m_criteria.textCaseSensitive
         ? Qt::CaseSensitive
         : Qt::CaseInsensitive;
 
-    // For whole words, create a regex pattern
-    if (m_criteria.wholeWords) {
-        QString searchText = QRegularExpression::escape(m_criteria.containingText);
-        QString pattern = "\\b" + searchText + "\\b";
-        QRegularExpression::PatternOption option = m_criteria.textCaseSensitive
-            ? QRegularExpression::NoPatternOption
-            : QRegularExpression::CaseInsensitiveOption;
-        QRegularExpression regex(pattern, option);
-
+    if (m_criteria.textRegex) {
         while (!in.atEnd() && !m_shouldStop) {
-            QString line = in.readLine();
-            if (regex.match(line).hasMatch())
+            QRegularExpressionMatch match = m_contentRegex.match(in.readLine());
+            if (match.hasMatch()) {
+                if (matchedTerm)
+                    *matchedTerm = match.captured(0);
                 return true;
+            }
         }
-    } else {
-        // Simple substring search
-        while (!in.atEnd() && !m_shouldStop) {
-            QString line = in.readLine();
-            if (line.contains(m_criteria.containingText, cs))
+        return false;
+    }
+
+    while (!in.atEnd() && !m_shouldStop) {
+        QString line = in.readLine();
+        for (int i = 0; i < m_textTerms.size(); ++i) {
+            bool found = m_criteria.wholeWords
+                ? m_wholeWordRegexes[i].match(line).hasMatch()
+                : line.contains(m_textTerms[i], cs);
+            if (found) {
+                if (matchedTerm)
+                    *matchedTerm = m_textTerms[i];
                 return true;
+            }
         }
     }
 
     return false;
 }
 
+// Containing text of the archive member being read. Streamed through the
+// byte matcher like a file; members that need decoding are buffered in
+// memory (up to MaxDecodedMemberSize) and decoded.
+bool SearchWorker::matchesArchiveMemberText(const ArchiveDataReader& read, QString* matchedTerm,
+                                            qint64* matchOffset) const
+{
+    QByteArray data;
+    if (m_textMatcher) {
+        const search::ScanOptions options = textScanOptions(matchedTerm);
+        search::StreamScanner scanner(*m_textMatcher, options);
+        bool firstRead = true;
+        for (;;) {
+            m_pause.wait();
+            if (m_shouldStop)
+                return false;
+            std::size_t capacity;
+            char* dst = scanner.writeBuffer(capacity);
+            const qint64 n = read(dst, static_cast<qint64>(capacity));
+            if (n < 0)
+                return false;
+            if (firstRead) {
+                firstRead = false;
+                if (!options.rawBytes && search::hasWideBom(dst, static_cast<std::size_t>(n))) {
+                    data.append(dst, static_cast<int>(n));
+                    break;
+                }
+            }
+            if (scanner.commit(static_cast<std::size_t>(n))) {
+                if (matchedTerm && !m_criteria.textRegex)
+                    *matchedTerm = m_textTerms.value(scanner.match().pattern);
+                if (matchOffset && m_criteria.textHex)
+                    *matchOffset = static_cast<qint64>(scanner.match().offset);
+                return true;
+            }
+            if (n == 0)
+                return false;
+        }
+    }
+
+    char buffer[64 * 1024];
+    for (;;) {
+        if (m_shouldStop || data.size() > MaxDecodedMemberSize)
+            return false;
+        const qint64 n = read(buffer, sizeof(buffer));
+        if (n < 0)
+            return false;
+        if (n == 0)
+            break;
+        data.append(buffer, static_cast<int>(n));
+    }
+    QBuffer device(&data);
+    device.open(QIODevice::ReadOnly | QIODevice::Text);
+    return matchesContainingTextDecoded(device, matchedTerm);
+}
+
+// Containing text of a compressed single file (.gz, .xz, .zst, ...), matched
+// on its decompressed data like an archive member: decompression stops at
+// the first hit. Hex offsets would point into the decompressed data, which
+// the viewer does not show, so none is reported.
+bool SearchWorker::matchesCompressedText(const QString& filePath, QString* matchedTerm) const
+{
+    bool found = false;
+    readCompressedFile(filePath, [&](const ArchiveDataReader& read) {
+        found = matchesArchiveMemberText(read, matchedTerm, nullptr);
+    });
+    return found;
+}
+
+// Report the members of an archive that pass the filters, reading it once.
+// Members have no permissions or content type worth checking, so they never
+// match while the executable-bits or the file content filter is active.
+void SearchWorker::searchArchive(const QString& archivePath)
+{
+    if (m_criteria.executableBits != SearchCriteria::ExecutableBitsFilter::NotSpecified ||
+        m_criteria.fileContentFilter != FileContentFilter::Any)
+        return;
+
+    scanArchive(archivePath, [&](const ArchiveEntry& entry, const ArchiveDataReader& read) {
+        m_pause.wait();
+        if (m_shouldStop)
+            return false;
+        if (++m_searchedFiles % 1000 == 0)
+            flushResults(false);
+
+        bool nameMatches = m_fileNameMask.matches(entry.name);
+        if (m_criteria.negateFileName)
+            nameMatches = !nameMatches;
+        if (!nameMatches)
+            return true;
+
+        const bool isDir = entry.isDirectory;
+        if (!matchesItemType(isDir, !isDir))
+            return true;
+        if (!isDir && !matchesFileSize(entry.size))
+            return true;
+
+        QString matchedTerm;
+        qint64 matchOffset = -1;
+        if (!m_textTerms.isEmpty()) {
+            if (isDir)
+                return true;
+            bool textMatches = matchesArchiveMemberText(read, &matchedTerm, &matchOffset);
+            if (m_criteria.negateContainingText)
+                textMatches = !textMatches;
+            if (!textMatches)
+                return true;
+        }
+
+        addResult(archivePath + '/' + entry.path, isDir, entry.size, entry.modTime.toMSecsSinceEpoch(), matchedTerm,
+                  matchOffset);
+        return true;
+    });
+}
+
 bool SearchWorker::matchesItemType(bool isDir, bool isFile) const
 {
     switch (m_criteria.itemTypeFilter) {
@@ -274,63 +842,37 @@ bool SearchWorker::matchesFileContentFilter(const QString& filePath, qint64 file
             return (header.size() >= 2 && header[0] == '#' && header[1] == '!');
         }
 
-        case FileContentFilter::ZeroFilled: {
+        case FileContentFilter::ZeroFilled:
             // Empty files are not considered zero-filled
             if (fileSize == 0)
                 return false;
-
-            QFile file(filePath);
-            if (!file.open(QIODevice::ReadOnly))
-                return false;
-
-            // Adaptive chunk sizes: 4 KiB -> 64 KiB -> 1 MiB
-            constexpr qint64 initialChunk = 4 * 1024;
-            constexpr qint64 mediumChunk = 64 * 1024;
-            constexpr qint64 largeChunk = 1024 * 1024;
-
-            QByteArray buffer;
-            int chunksRead = 0;
-
-            while (!file.atEnd() && !m_shouldStop) {
-                qint64 chunkSize;
-                if (chunksRead == 0)
-                    chunkSize = initialChunk;
-                else if (chunksRead <= 2)
-                    chunkSize = mediumChunk;
-                else
-                    chunkSize = largeChunk;
-
-                buffer = file.read(chunkSize);
-                chunksRead++;
-
-                for (char byte : buffer) {
-                    if (byte != 0) {
-                        file.close();
-                        return false;
-                    }
-                }
-            }
-
-            file.close();
-            return !m_shouldStop;
-        }
+            return search::isZeroFilledFile(QFile::encodeName(filePath).toStdString(), &m_shouldStop, &m_pause);
     }
     return true;
 }
 
-bool SearchWorker::matchesExecutableBits(const QString& filePath) const
+// `mode` is the st_mode when the caller already has it, 0 to look it up.
+bool SearchWorker::matchesExecutableBits(const QString& filePath, quint32 mode) const
 {
     using EBF = SearchCriteria::ExecutableBitsFilter;
 
     if (m_criteria.executableBits == EBF::NotSpecified)
         return true;  // Don't check
 
-    QFileInfo info(filePath);
-    QFile::Permissions perms = info.permissions();
-
-    bool ownerExec = perms & QFile::ExeOwner;
-    bool groupExec = perms & QFile::ExeGroup;
-    bool otherExec = perms & QFile::ExeOther;
+    bool ownerExec;
+    bool groupExec;
+    bool otherExec;
+    if (mode != 0) {
+        ownerExec = mode & S_IXUSR;
+        groupExec = mode & S_IXGRP;
+        otherExec = mode & S_IXOTH;
+    } else {
+        QFileInfo info(filePath);
+        QFile::Permissions perms = info.permissions();
+        ownerExec = perms & QFile::ExeOwner;
+        groupExec = perms & QFile::ExeGroup;
+        otherExec = perms & QFile::ExeOther;
+    }
 
     bool anyExec = ownerExec || groupExec || otherExec;
     bool allExec = ownerExec && groupExec && otherExec;
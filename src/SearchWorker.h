@@ -2,10 +2,28 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QRegularExpression>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QMutex>
 #include <QVector>
 
+#include "Archives.h"
+#include "NameMask.h"
+#include "search/ThreadControl.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace search { class ByteMatcher; class LiveNameIndex; struct ScanOptions; }
+
+class QIODevice;
+
 enum class ItemTypeFilter {
     FilesAndDirectories,  // Search both files and directories
     FilesOnly,            // Only files
@@ -20,9 +38,21 @@ enum class FileContentFilter {
     ZeroFilled     // Zero-filled file (USB write failure)
 };
 
+// One result as delivered to the dialog
+struct SearchHit {
+    QString path;
+    bool isDir = false;
+    qint64 size = 0;
+    qint64 modifiedMs = 0;    // msecs since epoch
+    QString matchedTerm;
+    qint64 matchOffset = -1;  // byte offset of the match, hex patterns only
+};
+
+Q_DECLARE_METATYPE(SearchHit)
+
 struct SearchCriteria {
     QString searchPath;
-    QString fileNamePattern;      // wildcard pattern (e.g., "*.txt")
+    QString fileNamePattern;      // wildcard masks, ";"-separated (e.g., "*.txt;*.md")
     bool fileNameCaseSensitive = false;
     bool partOfName = true;       // add * before and after pattern
     bool negateFileName = false;  // Invert filename match
@@ -31,6 +61,9 @@ struct SearchCriteria {
     bool textCaseSensitive = false;
     bool wholeWords = false;
     bool negateContainingText = false;  // Invert text content match
+    QStringList containingTerms;  // more terms; a file matches if it contains any of them
+    bool textRegex = false;       // text and terms are regular expressions (matched per line)
+    bool textHex = false;         // text and terms are hex byte patterns, "??" = any byte (see HexPatternMatcher)
 
     qint64 minSize = -1;          // -1 means no limit
     qint64 maxSize = -1;          // -1 means no limit
@@ -51,7 +84,29 @@ struct SearchCriteria {
 
     // Search in results mode
     bool searchInResults = false;       // Hybrid filtering mode
-    QVector<QString> previousResultPaths;  // Full paths from previous search
+    QVector<SearchHit> previousResults; // from the previous search; their size, time and type are reused
+    bool keepPreviousMatches = false;   // previousResults were found with these same content criteria
+                                        // (sameContentCriteria): their match stands, files are not read again
+
+    // Traversal
+    int threads = 0;              // walker threads, 0 = one per CPU core
+    QString excludeDirs;          // directory masks not descended into, ";"-separated (e.g., "node_modules;.git")
+    bool respectIgnoreFiles = false;  // skip what .gitignore / .ignore files exclude
+    bool oneFileSystem = false;   // do not descend into other mounted filesystems
+    bool useIndex = true;         // answer from a filename index when one covers searchPath
+    search::ThreadPriority priority;  // I/O class and nice level of the searching threads
+    bool searchArchives = false;  // also match archive members, reported as "archive.zip/inner/path",
+                                  // and search the decompressed text of .gz/.xz/.zst/... files
+
+    // True if everything these criteria match, `previous` matched too, so a
+    // complete result of `previous` can be filtered instead of walking the
+    // disk again: a longer part of a name, a filter added or tightened.
+    // Errs on the side of false.
+    bool narrows(const SearchCriteria& previous) const;
+
+    // True if the containing text, content and executable filters are the
+    // same as in `previous`, so what `previous` found still passes them.
+    bool sameContentCriteria(const SearchCriteria& previous) const;
 };
 
 class SearchWorker : public QObject {
@@ -60,24 +115,67 @@ class SearchWorker : public QObject {
 public:
     explicit SearchWorker(const SearchCriteria& criteria, QObject* parent = nullptr);
 
+    // Park the searching threads where they are and let them go on; safe
+    // to call from any thread
+    void pauseSearch();
+    void resumeSearch();
+
 public slots:
     void startSearch();
     void stopSearch();
 
 signals:
-    void resultFound(const QString& path, qint64 size, const QDateTime& modified);
+    // A batch of results (possibly empty) and the progress so far
+    void resultsFound(const QVector<SearchHit>& hits, int searchedFiles, int foundFiles);
     void searchFinished();
-    void progressUpdate(int searchedFiles, int foundFiles);
 
 private:
+    void enterSearchThread() const;
+    void searchPreviousResults();
+    void filterPreviousResult(const SearchHit& previous);
+    void searchIndex(const search::LiveNameIndex& index, const std::string& relPath);
+    bool matchesEntry(const QString& filePath, bool isDir, bool isFile, qint64 size, quint32 mode,
+                      QString* matchedTerm, qint64* matchOffset, bool mayContainText = true) const;
     bool matchesFileName(const QString& fileName) const;
+    bool isExcludedDir(std::string_view name) const;
+    bool hasExcludedDir(std::string_view relDir) const;
+    void addResult(const QString& path, bool isDir, qint64 size, qint64 modifiedMs, const QString& matchedTerm,
+                   qint64 matchOffset = -1);
+    void flushResults(bool force);
+    void emitPending();
     bool matchesFileSize(qint64 size) const;
-    bool matchesContainingText(const QString& filePath) const;
+    bool matchesContainingText(const QString& filePath, QString* matchedTerm = nullptr,
+                               qint64* matchOffset = nullptr) const;
+    bool matchesContainingTextDecoded(QIODevice& device, QString* matchedTerm) const;
+    search::ScanOptions textScanOptions(QString* matchedTerm) const;
+    bool matchesArchiveMemberText(const ArchiveDataReader& read, QString* matchedTerm, qint64* matchOffset) const;
+    bool matchesCompressedText(const QString& filePath, QString* matchedTerm) const;
+    void searchArchive(const QString& archivePath);
     bool matchesItemType(bool isDir, bool isFile) const;
     bool matchesFileContentFilter(const QString& filePath, qint64 fileSize) const;
-    bool matchesExecutableBits(const QString& filePath) const;
+    bool matchesExecutableBits(const QString& filePath, quint32 mode = 0) const;
 
     SearchCriteria m_criteria;
-    QRegularExpression m_fileNameRegex;
-    bool m_shouldStop;
+    NameMask m_fileNameMask;
+    NameMask m_excludeDirMask;                                 // only used if m_hasExcludeDirs
+    bool m_hasExcludeDirs = false;
+    std::string m_nameLiteral;                                 // every matching name contains it (UTF-8)
+    QStringList m_textTerms;                                   // containingText + containingTerms
+    std::shared_ptr<const search::ByteMatcher> m_textMatcher;  // null if a term needs Unicode case folding
+    std::vector<std::string> m_textLiterals;                   // what m_textMatcher looks for, to query a content index
+    QVector<QRegularExpression> m_wholeWordRegexes;            // per term, for the decoding fallback
+    QRegularExpression m_contentRegex;                         // regex mode: all terms as one alternation
+    std::atomic<bool> m_shouldStop;
+    search::PauseGate m_pause;
+
+    static constexpr int MaxDecodedMemberSize = 64 * 1024 * 1024;
+    static constexpr int BatchSize = 512;
+    static constexpr int PreviousResultsChunk = 256;             // previous results per thread pool task
+    static constexpr qint64 FlushIntervalMs = 100;
+
+    std::atomic<int> m_searchedFiles{0};
+    std::atomic<int> m_foundFiles{0};
+    QMutex m_pendingMutex;                                     // guards the batch state below
+    QVector<SearchHit> m_pending;                              // results not delivered yet
+    QElapsedTimer m_sinceFlush;
 };
\ No newline at end of file
@@ -51,6 +51,15 @@ int HexViewWidget::bytesPerLine() const
     return m_bytesPerLine;
 }
 
+void HexViewWidget::setCursorPosition(qint64 position)
+{
+    if (!m_data || m_size == 0)
+        return;
+    m_cursorPosition = qBound(0LL, position, m_size - 1);
+    ensureCursorVisible();
+    viewport()->update();
+}
+
 void HexViewWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
@@ -198,10 +207,15 @@ void HexViewWidget::keyPressEvent(QKeyEvent *event)
         break;
     }
 
-    // Ensure cursor is visible
+    ensureCursorVisible();
+}
+
+void HexViewWidget::ensureCursorVisible()
+{
+    // At least one line, for a widget that has not been laid out yet
     qint64 cursorLine = m_cursorPosition / m_bytesPerLine;
     qint64 firstVisible = verticalScrollBar()->value();
-    qint64 visibleLines = viewport()->height() / m_charHeight;
+    qint64 visibleLines = qMax(1, viewport()->height() / m_charHeight);
 
     if (cursorLine < firstVisible) {
         verticalScrollBar()->setValue(static_cast<int>(cursorLine));
@@ -19,6 +19,10 @@ public:
     void setBytesPerLine(int bytes);
     int bytesPerLine() const;
 
+    // Move the cursor to byte `position` and scroll it into view
+    void setCursorPosition(qint64 position);
+    qint64 cursorPosition() const { return m_cursorPosition; }
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
@@ -28,6 +32,7 @@ protected:
 
 private:
     void updateScrollbars();
+    void ensureCursorVisible();
     qint64 positionAtPoint(const QPoint &point);
 
     const char* m_data = nullptr;
@@ -45,6 +45,13 @@ void ViewerFrame::openFile(const QString& filePath)
     m_viewerWidget->openFile(filePath);
 }
 
+void ViewerFrame::openFileAt(const QString& filePath, qint64 offset)
+{
+    openFile(filePath);
+    m_viewerWidget->showOffset(offset);
+    updateMenuChecks();
+}
+
 void ViewerFrame::setupMenuBar()
 {
     m_menuBar = new QMenuBar(this);
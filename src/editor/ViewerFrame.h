@@ -17,6 +17,8 @@ public:
     ~ViewerFrame() override;
 
     void openFile(const QString& filePath);
+    // Open in Hex mode at byte `offset`
+    void openFileAt(const QString& filePath, qint64 offset);
 
 protected:
     void closeEvent(QCloseEvent *event) override;
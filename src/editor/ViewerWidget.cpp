@@ -142,6 +142,13 @@ void ViewerWidget::setViewMode(ViewMode mode)
     }
 }
 
+void ViewerWidget::showOffset(qint64 offset)
+{
+    setViewMode(ViewMode::Hex);
+    if (m_hexViewer)
+        m_hexViewer->setCursorPosition(offset);
+}
+
 bool ViewerWidget::eventFilter(QObject* watched, QEvent* event)
 {
     Q_UNUSED(watched);
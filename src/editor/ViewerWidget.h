@@ -46,6 +46,9 @@ public:
 
     void setViewMode(ViewMode mode);
 
+    // Switch to Hex mode with the cursor on byte `offset`
+    void showOffset(qint64 offset);
+
 protected:
     bool eventFilter(QObject* watched, QEvent* event) override;
 
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+namespace search {
+
+// Location of a match inside a buffer.
+struct Match {
+    std::size_t offset = 0;
+    std::size_t length = 0;
+    int pattern = 0;        // index of the matched pattern, for multi-pattern matchers
+};
+
+// Byte-level pattern matcher used by the content scanners.
+// Implementations are immutable after construction and safe to share
+// between threads.
+class ByteMatcher {
+public:
+    virtual ~ByteMatcher() = default;
+
+    // Find the match with the smallest offset >= `from` that lies entirely
+    // inside data[0, len). Returns false if there is none.
+    virtual bool find(const char* data, std::size_t len, std::size_t from, Match& out) const = 0;
+
+    // Upper bound on the length of a match. Scanners keep this many bytes
+    // between consecutive reads so matches spanning a read boundary are found.
+    virtual std::size_t maxMatchLength() const = 0;
+};
+
+} // namespace search
@@ -0,0 +1,308 @@
+#include "DuplicateFinder.h"
+#include "ParallelWalker.h"
+#include "ThreadControl.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+namespace search {
+
+namespace {
+
+constexpr std::size_t HashBufferSize = 1024 * 1024;
+
+// One inode with all the paths that link to it
+struct Inode {
+    std::uint64_t size = 0;
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::vector<DuplicateFile> links;
+    std::uint64_t sample = 0;      // Sampling stage
+    std::string digest;            // Hashing stage
+    bool failed = false;           // unreadable, drop it
+};
+
+// Inodes (indices) that nothing has told apart yet
+using Candidates = std::vector<std::size_t>;
+
+struct Cancelled {};
+
+bool cancelled(const DuplicateOptions& options)
+{
+    return options.cancel && options.cancel->load(std::memory_order_relaxed);
+}
+
+void setStage(const DuplicateOptions& options, DuplicateStage stage, std::uint64_t total)
+{
+    if (!options.progress)
+        return;
+    options.progress->stage = stage;
+    options.progress->done = 0;
+    options.progress->total = total;
+}
+
+// Run `work` on every inode of `items`: each device gets its own threads,
+// as many as it reads well with, and its inodes in inode order.
+void forEachPerDevice(std::vector<Inode>& inodes, const Candidates& items, const DuplicateOptions& options,
+                      const std::function<void(Inode&)>& work)
+{
+    std::map<std::uint64_t, Candidates> byDevice;
+    for (std::size_t i : items)
+        byDevice[inodes[i].device].push_back(i);
+
+    struct DeviceQueue {
+        Candidates items;
+        std::atomic<std::size_t> next{0};
+    };
+    std::vector<std::unique_ptr<DeviceQueue>> queues;
+    std::vector<std::thread> threads;
+    for (auto& [device, list] : byDevice) {
+        std::sort(list.begin(), list.end(),
+                  [&inodes](std::size_t a, std::size_t b) { return inodes[a].inode < inodes[b].inode; });
+        auto queue = std::make_unique<DeviceQueue>();
+        queue->items = std::move(list);
+        const auto count = static_cast<unsigned>(
+            std::min<std::size_t>(deviceReadConcurrency(device), queue->items.size()));
+        for (unsigned t = 0; t < count; ++t) {
+            threads.emplace_back([&inodes, &options, &work, q = queue.get()]() {
+                for (;;) {
+                    if (options.pause)
+                        options.pause->wait();
+                    const std::size_t n = q->next.fetch_add(1, std::memory_order_relaxed);
+                    if (n >= q->items.size() || cancelled(options))
+                        return;
+                    work(inodes[q->items[n]]);
+                }
+            });
+        }
+        queues.push_back(std::move(queue));
+    }
+    for (std::thread& t : threads)
+        t.join();
+}
+
+// Split every class by `key`, keeping the parts that still hold two inodes
+template <typename Key>
+std::vector<Candidates> regroup(const std::vector<Inode>& inodes, const std::vector<Candidates>& classes, Key key)
+{
+    std::vector<Candidates> result;
+    for (const Candidates& candidates : classes) {
+        std::unordered_map<std::decay_t<decltype(key(inodes[0]))>, Candidates> parts;
+        for (std::size_t i : candidates) {
+            if (!inodes[i].failed)
+                parts[key(inodes[i])].push_back(i);
+        }
+        for (auto& [k, part] : parts) {
+            if (part.size() >= 2)
+                result.push_back(std::move(part));
+        }
+    }
+    return result;
+}
+
+bool readAt(int fd, char* buffer, std::size_t length, std::uint64_t offset)
+{
+    while (length > 0) {
+        const ssize_t n = ::pread(fd, buffer, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buffer += n;
+        length -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+unsigned deviceReadConcurrency(std::uint64_t device)
+{
+    const unsigned parallel = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+
+    // Partitions keep their queue settings in the parent disk's directory
+    const std::string base = "/sys/dev/block/" + std::to_string(major(device)) + ':' +
+                             std::to_string(minor(device));
+    for (const char* queue : {"/queue/rotational", "/../queue/rotational"}) {
+        std::ifstream in(base + queue);
+        int rotational;
+        if (in >> rotational)
+            return rotational ? 1 : parallel;
+    }
+    return parallel;   // no block device: network, tmpfs, btrfs subvolumes, ...
+}
+
+std::vector<DuplicateGroup> findDuplicates(const std::string& root, const DuplicateOptions& options)
+{
+    // Collecting
+    setStage(options, DuplicateStage::Collecting, 0);
+    const std::uint64_t minSize = std::max<std::uint64_t>(1, options.minSize);
+    std::vector<Inode> files;   // one per path for now
+    std::mutex mutex;
+    WalkOptions walkOptions;
+    walkOptions.threads = options.walkThreads;
+    walkOptions.cancel = options.cancel;
+    walkOptions.pause = options.pause;
+    walkOptions.oneFileSystem = options.oneFileSystem;
+    ParallelWalker walker(walkOptions);
+    walker.run(root, [&](const WalkEntry& entry) {
+        if (entry.type != EntryType::File)
+            return VisitResult::Continue;
+        EntryStat st;
+        if (!statEntry(entry, StatSize | StatMtime | StatIdentity, st) || st.size < minSize)
+            return VisitResult::Continue;
+        Inode file;
+        file.size = st.size;
+        file.device = st.device;
+        file.inode = st.inode;
+        file.links.push_back(DuplicateFile{entry.path(), st.mtimeNs, st.device, st.inode});
+        std::lock_guard<std::mutex> lock(mutex);
+        files.push_back(std::move(file));
+        if (options.progress)
+            options.progress->done.fetch_add(1, std::memory_order_relaxed);
+        return VisitResult::Continue;
+    });
+    if (cancelled(options))
+        return {};
+
+    // By size, merging the links of one inode; sizes with a single inode
+    // cannot have duplicates
+    std::sort(files.begin(), files.end(), [](const Inode& a, const Inode& b) {
+        if (a.size != b.size)
+            return a.size < b.size;
+        if (a.device != b.device)
+            return a.device < b.device;
+        if (a.inode != b.inode)
+            return a.inode < b.inode;
+        return a.links.front().path < b.links.front().path;
+    });
+    std::vector<Inode> inodes;
+    std::vector<Candidates> classes;
+    for (std::size_t i = 0; i < files.size();) {
+        std::size_t end = i;
+        while (end < files.size() && files[end].size == files[i].size)
+            ++end;
+        Candidates sameSize;
+        for (std::size_t j = i; j < end; ++j) {
+            const bool sameInode = !sameSize.empty() && inodes.back().device == files[j].device &&
+                                   inodes.back().inode == files[j].inode;
+            if (sameInode) {
+                inodes.back().links.push_back(std::move(files[j].links.front()));
+                continue;
+            }
+            sameSize.push_back(inodes.size());
+            inodes.push_back(std::move(files[j]));
+        }
+        if (sameSize.size() >= 2)
+            classes.push_back(std::move(sameSize));
+        else if (!sameSize.empty())
+            inodes.resize(sameSize.front());   // nothing else refers to it
+        i = end;
+    }
+    files.clear();
+    files.shrink_to_fit();
+
+    // Sampling: the ends of files larger than the two samples; smaller ones
+    // go straight to full hashing, which reads them just as cheaply
+    Candidates toSample;
+    for (const Candidates& candidates : classes) {
+        for (std::size_t i : candidates) {
+            if (inodes[i].size > 2 * options.sampleBytes)
+                toSample.push_back(i);
+        }
+    }
+    setStage(options, DuplicateStage::Sampling, toSample.size());
+    forEachPerDevice(inodes, toSample, options, [&options](Inode& inode) {
+        const int fd = ::open(inode.links.front().path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0) {
+            inode.failed = true;
+            return;
+        }
+        std::string data(2 * options.sampleBytes, '\0');
+        inode.failed = !readAt(fd, data.data(), options.sampleBytes, 0) ||
+                       !readAt(fd, data.data() + options.sampleBytes, options.sampleBytes,
+                               inode.size - options.sampleBytes);
+        ::close(fd);
+        inode.sample = std::hash<std::string_view>()(data);
+        if (options.progress)
+            options.progress->done.fetch_add(1, std::memory_order_relaxed);
+    });
+    if (cancelled(options))
+        return {};
+    classes = regroup(inodes, classes, [](const Inode& inode) { return inode.sample; });
+
+    // Hashing
+    Candidates toHash;
+    std::uint64_t totalBytes = 0;
+    for (const Candidates& candidates : classes) {
+        for (std::size_t i : candidates) {
+            toHash.push_back(i);
+            totalBytes += inodes[i].size;
+        }
+    }
+    setStage(options, DuplicateStage::Hashing, totalBytes);
+    forEachPerDevice(inodes, toHash, options, [&options](Inode& inode) {
+        std::uintmax_t reported = 0;
+        try {
+            inode.digest = utils::compute_file_hash(inode.links.front().path, HashBufferSize, "SHA-256",
+                                                    [&options, &reported](std::uintmax_t, std::uintmax_t processed) {
+                if (options.pause)
+                    options.pause->wait();
+                if (cancelled(options))
+                    throw Cancelled();
+                if (options.progress)
+                    options.progress->done.fetch_add(processed - reported, std::memory_order_relaxed);
+                reported = processed;
+            });
+        } catch (const Cancelled&) {
+            inode.failed = true;
+        } catch (const std::exception&) {
+            inode.failed = true;   // vanished or unreadable
+        }
+    });
+    if (cancelled(options))
+        return {};
+    classes = regroup(inodes, classes, [](const Inode& inode) { return inode.digest; });
+
+    std::vector<DuplicateGroup> groups;
+    groups.reserve(classes.size());
+    for (Candidates& candidates : classes) {
+        std::sort(candidates.begin(), candidates.end(), [&inodes](std::size_t a, std::size_t b) {
+            return inodes[a].links.front().path < inodes[b].links.front().path;
+        });
+        DuplicateGroup group;
+        group.size = inodes[candidates.front()].size;
+        group.copies = candidates.size();
+        for (std::size_t i : candidates) {
+            for (DuplicateFile& link : inodes[i].links)
+                group.files.push_back(std::move(link));
+        }
+        groups.push_back(std::move(group));
+    }
+    std::sort(groups.begin(), groups.end(), [](const DuplicateGroup& a, const DuplicateGroup& b) {
+        if (a.wastedBytes() != b.wastedBytes())
+            return a.wastedBytes() > b.wastedBytes();
+        return a.files.front().path < b.files.front().path;
+    });
+
+    setStage(options, DuplicateStage::Done, groups.size());
+    return groups;
+}
+
+} // namespace search
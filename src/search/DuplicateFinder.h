@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace search {
+
+class PauseGate;
+
+struct DuplicateFile {
+    std::string path;
+    std::int64_t mtimeNs = 0;
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+};
+
+// Files with the same content. Hard links are listed too, but only distinct
+// inodes count as copies.
+struct DuplicateGroup {
+    std::uint64_t size = 0;                  // of each file
+    std::vector<DuplicateFile> files;        // grouped by inode, each inode's links together
+    std::size_t copies = 0;                  // distinct inodes, always >= 2
+
+    std::uint64_t wastedBytes() const { return size * (copies - 1); }
+};
+
+enum class DuplicateStage : int {
+    Collecting,    // walking the tree
+    Sampling,      // hashing the first and last bytes of same-size files
+    Hashing,       // hashing whole files that still look alike
+    Done
+};
+
+// Where a findDuplicates() call is, for a progress display polling from
+// another thread. `done` and `total` count files in the hashing stages and
+// bytes of them in Hashing.
+struct DuplicateProgress {
+    std::atomic<DuplicateStage> stage{DuplicateStage::Collecting};
+    std::atomic<std::uint64_t> done{0};
+    std::atomic<std::uint64_t> total{0};
+};
+
+struct DuplicateOptions {
+    std::uint64_t minSize = 1;                     // smaller files are ignored; empty files are all alike
+    std::size_t sampleBytes = 4096;                // read at each end of a file in the Sampling stage
+    unsigned walkThreads = 0;                      // 0 = hardware concurrency
+    bool oneFileSystem = false;
+    const std::atomic<bool>* cancel = nullptr;
+    const PauseGate* pause = nullptr;
+    DuplicateProgress* progress = nullptr;
+};
+
+// Find the regular files below `root` whose content is identical, in
+// stages that each only look at what the previous one could not tell
+// apart: files are grouped by size, then by a hash of their first and last
+// options.sampleBytes, and only those still alike are hashed in full
+// (SHA-256 through utils::compute_file_hash). Links to one inode are hashed
+// once. Symbolic links are not followed.
+//
+// Both hashing stages run per device, with as many threads as the device
+// handles well - one for a spinning disk, where parallel reads only add
+// seeks, several for SSDs and everything else - and in inode order, which
+// roughly follows the on-disk layout. Groups come back largest waste first.
+// A cancelled search returns nothing.
+std::vector<DuplicateGroup> findDuplicates(const std::string& root, const DuplicateOptions& options = {});
+
+// Concurrent reads worth issuing to the block device behind `device` (an
+// st_dev): 1 if sysfs says it is rotational, more otherwise.
+unsigned deviceReadConcurrency(std::uint64_t device);
+
+} // namespace search
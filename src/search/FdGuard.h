@@ -0,0 +1,26 @@
+#pragma once
+
+#include <unistd.h>
+
+namespace search::detail {
+
+// Closes a file descriptor when it goes out of scope; a negative one (a
+// failed open) is left alone.
+class FdGuard {
+public:
+    explicit FdGuard(int fd) : m_fd(fd) {}
+    ~FdGuard()
+    {
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+    FdGuard(const FdGuard&) = delete;
+    FdGuard& operator=(const FdGuard&) = delete;
+
+    int get() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+} // namespace search::detail
@@ -0,0 +1,358 @@
+#include "FileScanner.h"
+#include "FdGuard.h"
+#include "LiteralMatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace search {
+
+using detail::FdGuard;
+
+namespace {
+
+constexpr std::size_t MaxLineLength = 64 * 1024 * 1024;
+
+constexpr std::size_t ZeroCheckBlock = 1024 * 1024;
+constexpr std::uint64_t ZeroSampleMinSize = 16 * 1024 * 1024;
+constexpr std::size_t ZeroSampleSize = 4096;
+
+// Same rule as \b in QRegularExpression: a boundary lies between a word and
+// a non-word character, or between a word character and the buffer edge.
+bool atWordBoundaries(const char* data, std::size_t len, const Match& m)
+{
+    if (m.length == 0)
+        return false;
+    const auto byteAt = [data](std::size_t i) { return static_cast<unsigned char>(data[i]); };
+
+    const bool firstIsWord = isWordByte(byteAt(m.offset));
+    const bool beforeIsWord = m.offset > 0 && isWordByte(byteAt(m.offset - 1));
+    if (firstIsWord == beforeIsWord)
+        return false;
+
+    const std::size_t end = m.offset + m.length;
+    const bool lastIsWord = isWordByte(byteAt(end - 1));
+    const bool afterIsWord = end < len && isWordByte(byteAt(end));
+    return lastIsWord != afterIsWord;
+}
+
+} // anonymous namespace
+
+bool hasWideBom(const char* data, std::size_t len)
+{
+    if (len < 2)
+        return false;
+    const auto b0 = static_cast<unsigned char>(data[0]);
+    const auto b1 = static_cast<unsigned char>(data[1]);
+    if ((b0 == 0xFF && b1 == 0xFE) || (b0 == 0xFE && b1 == 0xFF))
+        return true;   // UTF-16 LE/BE, UTF-32 LE
+    return len >= 4 && b0 == 0 && b1 == 0 && static_cast<unsigned char>(data[2]) == 0xFE &&
+           static_cast<unsigned char>(data[3]) == 0xFF;   // UTF-32 BE
+}
+
+StreamScanner::StreamScanner(const ByteMatcher& matcher, const ScanOptions& options)
+    : m_matcher(matcher)
+    , m_options(options)
+{
+    // Room for one full read plus the bytes carried over from the previous one.
+    m_capacity = std::max<std::size_t>(m_options.bufferSize, 1) + m_matcher.maxMatchLength() + 1;
+    m_buffer.reset(new char[m_capacity]);
+}
+
+char* StreamScanner::writeBuffer(std::size_t& capacity)
+{
+    capacity = m_capacity - m_have;
+    return m_buffer.get() + m_have;
+}
+
+bool StreamScanner::search(bool atEnd, std::size_t& resume)
+{
+    const char* data = m_buffer.get();
+    const std::size_t maxLen = m_matcher.maxMatchLength();
+
+    // Until the stream ends, a match starting in the last maxLen bytes may be
+    // cut short or lack the byte that follows it; leave those for the next round.
+    const std::size_t safeEnd = atEnd ? m_have : (m_have > maxLen ? m_have - maxLen : 0);
+
+    std::size_t pos = m_from;
+    Match m;
+    while (m_matcher.find(data, m_have, pos, m)) {
+        if (!atEnd && m.offset >= safeEnd)
+            break;
+        if (!m_options.wholeWords || atWordBoundaries(data, m_have, m)) {
+            m_match = StreamMatch{m_base + m.offset, m.length, m.pattern};
+            return true;
+        }
+        pos = m.offset + 1;
+    }
+    resume = std::max(m_from, safeEnd);
+    return false;
+}
+
+bool StreamScanner::searchLines(bool atEnd, std::size_t& resume)
+{
+    char* data = m_buffer.get();
+
+    // Only complete lines are searched; m_from is always the start of a line.
+    std::size_t limit = m_have;
+    if (!atEnd) {
+        const void* lastNewline = ::memrchr(data + m_from, '\n', m_have - m_from);
+        if (lastNewline)
+            limit = static_cast<std::size_t>(static_cast<const char*>(lastNewline) - data) + 1;
+        else if (m_have - m_from < MaxLineLength)
+            limit = m_from;
+    }
+
+    std::size_t pos = m_from;
+    Match m;
+    while (pos < limit && m_matcher.find(data, limit, pos, m)) {
+        const void* before = m.offset > m_from ? ::memrchr(data + m_from, '\n', m.offset - m_from) : nullptr;
+        const std::size_t lineStart = before ? static_cast<std::size_t>(static_cast<const char*>(before) - data) + 1
+                                             : m_from;
+        const void* after = std::memchr(data + m.offset, '\n', limit - m.offset);
+        const std::size_t lineEnd = after ? static_cast<std::size_t>(static_cast<const char*>(after) - data) : limit;
+
+        std::size_t lineLength = lineEnd - lineStart;
+        if (lineLength > 0 && data[lineStart + lineLength - 1] == '\r')
+            --lineLength;
+
+        if (m_options.wholeWords && !atWordBoundaries(data, m_have, m)) {
+            pos = m.offset + 1;   // another hit may follow on the same line
+            continue;
+        }
+        if (m_options.verifyLine(data + lineStart, lineLength)) {
+            m_match = StreamMatch{m_base + m.offset, m.length, m.pattern};
+            return true;
+        }
+        pos = lineEnd + 1;        // this line is settled
+    }
+    resume = limit;
+    return false;
+}
+
+bool StreamScanner::commit(std::size_t n)
+{
+    if (m_found)
+        return true;
+
+    const bool atEnd = n == 0;
+    m_have += n;
+
+    const bool lineMode = static_cast<bool>(m_options.verifyLine);
+    std::size_t resume = 0;
+    if (lineMode ? searchLines(atEnd, resume) : search(atEnd, resume)) {
+        m_found = true;
+        return true;
+    }
+    if (atEnd)
+        return false;
+
+    // Keep everything from `resume` on - in line mode that is the unfinished
+    // last line. Otherwise keep one byte more, so the word boundary test still
+    // sees the preceding character.
+    const std::size_t keepFrom = lineMode || resume == 0 ? resume : resume - 1;
+    std::memmove(m_buffer.get(), m_buffer.get() + keepFrom, m_have - keepFrom);
+    m_base += keepFrom;
+    m_have -= keepFrom;
+    m_from = resume - keepFrom;
+
+    // A long line may leave less than a full read of free space; grow.
+    const std::size_t wanted = m_have + m_options.bufferSize + m_matcher.maxMatchLength() + 1;
+    if (m_capacity < wanted) {
+        std::unique_ptr<char[]> grown(new char[wanted]);
+        std::memcpy(grown.get(), m_buffer.get(), m_have);
+        m_buffer = std::move(grown);
+        m_capacity = wanted;
+    }
+    return false;
+}
+
+bool StreamScanner::feed(const char* data, std::size_t len)
+{
+    while (len > 0 && !m_found) {
+        std::size_t capacity;
+        char* dst = writeBuffer(capacity);
+        const std::size_t n = std::min(capacity, len);
+        std::memcpy(dst, data, n);
+        commit(n);
+        data += n;
+        len -= n;
+    }
+    return m_found;
+}
+
+ScanStatus scanFile(const std::string& path, const ByteMatcher& matcher, const ScanOptions& options,
+                    StreamMatch* match)
+{
+    FdGuard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY));
+    if (fd.get() < 0)
+        return ScanStatus::Failed;
+
+    struct stat st;
+    if (::fstat(fd.get(), &st) != 0)
+        return ScanStatus::Failed;
+
+    // Small files get a buffer just large enough to be read in one call.
+    ScanOptions scanOptions = options;
+    if (S_ISREG(st.st_mode) && static_cast<std::uint64_t>(st.st_size) < options.bufferSize)
+        scanOptions.bufferSize = std::max<std::size_t>(static_cast<std::size_t>(st.st_size) + 1, 4096);
+    else
+        ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    StreamScanner scanner(matcher, scanOptions);
+    bool firstRead = true;
+
+    for (;;) {
+        if (options.pause)
+            options.pause->wait();
+        if (options.cancel && options.cancel->load(std::memory_order_relaxed))
+            return ScanStatus::NotFound;
+
+        std::size_t capacity;
+        char* dst = scanner.writeBuffer(capacity);
+        const ssize_t n = ::read(fd.get(), dst, capacity);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return ScanStatus::Failed;
+        }
+
+        if (firstRead) {
+            firstRead = false;
+            if (!options.rawBytes && hasWideBom(dst, static_cast<std::size_t>(n)))
+                return ScanStatus::NeedsDecoding;
+        }
+
+        if (scanner.commit(static_cast<std::size_t>(n))) {
+            if (match)
+                *match = scanner.match();
+            return ScanStatus::Found;
+        }
+        if (n == 0)
+            return ScanStatus::NotFound;
+    }
+}
+
+bool allZero(const char* data, std::size_t len)
+{
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 64 <= len; i += 64) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48));
+        const __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF)
+            return false;
+    }
+#else
+    for (; i + 64 <= len; i += 64) {
+        std::uint64_t words[8];
+        std::memcpy(words, data + i, sizeof(words));
+        if ((words[0] | words[1] | words[2] | words[3] | words[4] | words[5] | words[6] | words[7]) != 0)
+            return false;
+    }
+#endif
+    for (; i < len; ++i) {
+        if (data[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Read [offset, offset + len) through `buffer` (`capacity` bytes) and check
+// it is all zero; a short read (the file shrank) checks what was there.
+bool rangeIsZero(int fd, char* buffer, std::size_t capacity, std::uint64_t offset, std::uint64_t len,
+                 const std::atomic<bool>* cancel, const PauseGate* pause)
+{
+    while (len > 0) {
+        if (pause)
+            pause->wait();
+        if (cancel && cancel->load(std::memory_order_relaxed))
+            return false;
+        const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(len, capacity));
+        const ssize_t n = ::pread(fd, buffer, want, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (n == 0)
+            return true;
+        if (!allZero(buffer, static_cast<std::size_t>(n)))
+            return false;
+        offset += static_cast<std::uint64_t>(n);
+        len -= static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool isZeroFilledFile(const std::string& path, const std::atomic<bool>* cancel, const PauseGate* pause)
+{
+    FdGuard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY));
+    if (fd.get() < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(fd.get(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return false;
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+    // At least a sample: the file may have grown since fstat()
+    const auto capacity = static_cast<std::size_t>(
+        std::max<std::uint64_t>(std::min<std::uint64_t>(size, ZeroCheckBlock), ZeroSampleSize));
+    std::unique_ptr<char[]> buffer(new char[capacity]);
+
+    // Non-zero files usually show it anywhere: probe the first page, and in
+    // large files the end and a few points in between, before reading
+    // everything
+    if (!rangeIsZero(fd.get(), buffer.get(), capacity, 0, ZeroSampleSize, cancel, pause))
+        return false;
+    if (size >= ZeroSampleMinSize) {
+        for (std::uint64_t probe : {size / 4, size / 2, size / 4 * 3, size - ZeroSampleSize}) {
+            probe &= ~std::uint64_t(ZeroSampleSize - 1);
+            if (!rangeIsZero(fd.get(), buffer.get(), capacity, probe, ZeroSampleSize, cancel, pause))
+                return false;
+        }
+    }
+
+    ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Only the data extents need reading: holes are zero by definition.
+    // Filesystems without SEEK_DATA support report the whole file as data.
+    std::uint64_t offset = 0;
+    while (offset < size) {
+        off_t data = ::lseek(fd.get(), static_cast<off_t>(offset), SEEK_DATA);
+        if (data < 0) {
+            if (errno == ENXIO)
+                break;   // only a hole remains
+            data = static_cast<off_t>(offset);
+        }
+        off_t hole = ::lseek(fd.get(), data, SEEK_HOLE);
+        if (hole < 0 || static_cast<std::uint64_t>(hole) > size)
+            hole = static_cast<off_t>(size);
+        if (hole <= data)
+            break;
+        if (!rangeIsZero(fd.get(), buffer.get(), capacity, static_cast<std::uint64_t>(data),
+                         static_cast<std::uint64_t>(hole - data), cancel, pause))
+            return false;
+        offset = static_cast<std::uint64_t>(hole);
+    }
+    return !(cancel && cancel->load(std::memory_order_relaxed));
+}
+
+} // namespace search
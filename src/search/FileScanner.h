@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ByteMatcher.h"
+#include "ThreadControl.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace search {
+
+struct ScanOptions {
+    bool wholeWords = false;                       // match must be delimited by \b-style word boundaries
+    const std::atomic<bool>* cancel = nullptr;     // polled between reads
+    const PauseGate* pause = nullptr;              // waited on between reads
+    std::size_t bufferSize = 1024 * 1024;          // read size for large files
+    bool rawBytes = false;                         // binary patterns: never report NeedsDecoding
+
+    // Line mode: a hit only counts if this accepts the whole line containing
+    // it (without the "\n" or "\r\n" terminator). Lets a cheap literal
+    // prefilter be confirmed by a full regular expression, run on candidate
+    // lines only. Lines longer than 64 MiB are split.
+    std::function<bool(const char* line, std::size_t length)> verifyLine;
+};
+
+// A match, with its offset counted from the start of the stream.
+struct StreamMatch {
+    std::uint64_t offset = 0;
+    std::size_t length = 0;
+    int pattern = 0;
+};
+
+// Incremental matcher over a byte stream delivered in pieces.
+//
+// Data is written directly into the scanner's buffer (writeBuffer() +
+// commit()) so reads go straight from the kernel into the buffer being
+// searched. Between pieces the scanner keeps the last maxMatchLength() bytes,
+// plus one byte of context for word-boundary checks, so matches that
+// straddle two reads are still found. In line mode it keeps the unfinished
+// last line instead.
+class StreamScanner {
+public:
+    StreamScanner(const ByteMatcher& matcher, const ScanOptions& options);
+
+    // Free space to read the next piece into. Never less than options.bufferSize.
+    char* writeBuffer(std::size_t& capacity);
+
+    // Search the `n` bytes just written to writeBuffer(). Pass 0 at the end of
+    // the stream. Returns true once a match has been found.
+    bool commit(std::size_t n);
+
+    // Convenience wrapper copying `data` through writeBuffer()/commit().
+    bool feed(const char* data, std::size_t len);
+    bool finish() { return commit(0); }
+
+    bool found() const { return m_found; }
+    const StreamMatch& match() const { return m_match; }
+
+private:
+    bool search(bool atEnd, std::size_t& resume);
+    bool searchLines(bool atEnd, std::size_t& resume);
+
+    const ByteMatcher& m_matcher;
+    ScanOptions m_options;
+    std::unique_ptr<char[]> m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_have = 0;        // valid bytes in m_buffer
+    std::size_t m_from = 0;        // first position not searched yet
+    std::uint64_t m_base = 0;      // stream offset of m_buffer[0]
+    bool m_found = false;
+    StreamMatch m_match;
+};
+
+// True if `data`, the start of a file, begins with a UTF-16 or UTF-32 byte order mark.
+bool hasWideBom(const char* data, std::size_t len);
+
+enum class ScanStatus {
+    NotFound,
+    Found,
+    NeedsDecoding,   // file starts with a UTF-16/UTF-32 byte order mark
+    Failed           // could not be opened or read
+};
+
+// Search a file for the first match.
+//
+// The file is read sequentially in large blocks (posix_fadvise
+// SEQUENTIAL); small files take a single read. Bytes are matched as they are
+// - no decoding - which is exact for UTF-8 and any ASCII-compatible
+// encoding. Files with a UTF-16/32 byte order mark are reported as
+// NeedsDecoding so the caller can decode them, unless options.rawBytes is
+// set. A cancelled scan reports NotFound.
+//
+// The file is deliberately not mmap'd: a file truncated by another process
+// while mapped raises SIGBUS, which would bring down the whole application.
+ScanStatus scanFile(const std::string& path, const ByteMatcher& matcher, const ScanOptions& options,
+                    StreamMatch* match = nullptr);
+
+// True if all `len` bytes are zero. Compares 64 bytes per step (SSE2 where
+// available, 8-byte words otherwise) and stops at the first non-zero block.
+bool allZero(const char* data, std::size_t len);
+
+// True if the file is not empty and every byte of it reads as zero - a
+// failed write to a USB stick, an unwritten disk image. Holes, found with
+// SEEK_DATA/SEEK_HOLE, are skipped without reading them. The first page,
+// and in files of 16 MiB and more a few other offsets, are checked before
+// anything else, so most non-zero files are rejected after reading a few
+// KiB. Unreadable and cancelled files are not zero-filled. `pause` is waited
+// on between reads.
+bool isZeroFilledFile(const std::string& path, const std::atomic<bool>* cancel = nullptr,
+                      const PauseGate* pause = nullptr);
+
+} // namespace search
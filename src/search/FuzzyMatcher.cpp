@@ -0,0 +1,242 @@
+#include "FuzzyMatcher.h"
+#include "LiteralMatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace search {
+
+namespace {
+
+constexpr int ScoreMatch = 16;
+constexpr int PenaltyGapStart = 3;
+constexpr int PenaltyGapExtension = 1;
+constexpr int BonusPathSeparator = 10;   // after '/', or at the start
+constexpr int BonusBoundary = 8;         // after '_', '-', '.', ' '
+constexpr int BonusCamel = 7;            // lowercase or digit, then uppercase
+constexpr int BonusConsecutive = 4;
+constexpr int BonusFirstCharMultiplier = 2;
+constexpr int BonusBasename = 8;
+
+constexpr std::size_t MinChunk = 16 * 1024;
+
+int bonusAt(std::string_view s, std::size_t i)
+{
+    if (i == 0)
+        return BonusPathSeparator;
+    const char prev = s[i - 1];
+    const char c = s[i];
+    if (prev == '/')
+        return BonusPathSeparator;
+    if (prev == '_' || prev == '-' || prev == '.' || prev == ' ')
+        return BonusBoundary;
+    if (c >= 'A' && c <= 'Z' && ((prev >= 'a' && prev <= 'z') || (prev >= '0' && prev <= '9')))
+        return BonusCamel;
+    return 0;
+}
+
+// Ranking: higher score, then shorter path, then earlier candidate
+struct Better {
+    const FuzzyCandidates& candidates;
+
+    bool operator()(const FuzzyHit& a, const FuzzyHit& b) const
+    {
+        if (a.score != b.score)
+            return a.score > b.score;
+        const std::size_t la = candidates.at(a.index).size();
+        const std::size_t lb = candidates.at(b.index).size();
+        if (la != lb)
+            return la < lb;
+        return a.index < b.index;
+    }
+};
+
+} // anonymous namespace
+
+void FuzzyCandidates::reserve(std::size_t count, std::size_t bytes)
+{
+    m_text.reserve(bytes);
+    m_offsets.reserve(count + 1);
+    m_masks.reserve(count);
+}
+
+void FuzzyCandidates::add(std::string_view path)
+{
+    m_text.append(path);
+    m_offsets.push_back(m_text.size());
+    m_masks.push_back(maskOf(path));
+}
+
+std::uint64_t FuzzyCandidates::maskOf(std::string_view text)
+{
+    std::uint64_t mask = 0;
+    for (const char c : text)
+        mask |= std::uint64_t(1) << (foldAscii(static_cast<unsigned char>(c)) & 63);
+    return mask;
+}
+
+FuzzyMatcher::FuzzyMatcher(std::string_view query)
+    : m_query(query)
+{
+    m_caseSensitive = std::any_of(m_query.begin(), m_query.end(), [](char c) { return c >= 'A' && c <= 'Z'; });
+    m_pattern = m_query;
+    if (!m_caseSensitive) {
+        for (char& c : m_pattern)
+            c = static_cast<char>(foldAscii(static_cast<unsigned char>(c)));
+    }
+    m_mask = FuzzyCandidates::maskOf(m_query);
+}
+
+// Position of the first `q` at or after `from`, in either case if matching
+// case-insensitively
+std::size_t FuzzyMatcher::findChar(std::string_view s, std::size_t from, char q) const
+{
+    const char* data = s.data() + from;
+    const std::size_t len = s.size() - from;
+    const auto* hit = static_cast<const char*>(std::memchr(data, q, len));
+    if (!m_caseSensitive && q >= 'a' && q <= 'z') {
+        const std::size_t upperLen = hit ? static_cast<std::size_t>(hit - data) : len;
+        if (const auto* upper = static_cast<const char*>(std::memchr(data, q - ('a' - 'A'), upperLen)))
+            hit = upper;
+    }
+    return hit ? static_cast<std::size_t>(hit - s.data()) : std::string_view::npos;
+}
+
+bool FuzzyMatcher::equal(char c, char q) const
+{
+    return m_caseSensitive ? c == q : foldAscii(static_cast<unsigned char>(c)) == static_cast<unsigned char>(q);
+}
+
+int FuzzyMatcher::score(std::string_view s) const
+{
+    const std::string_view query = m_pattern;
+    if (query.empty())
+        return 0;
+
+    // Forward: where the first occurrence of the whole query ends, jumping
+    // from one query character to the next with memchr
+    std::size_t pos = 0;
+    for (const char q : query) {
+        pos = findChar(s, pos, q);
+        if (pos == std::string_view::npos)
+            return -1;
+        ++pos;
+    }
+    const std::size_t end = pos - 1;
+
+    // Backward from there: the latest start, i.e. the shortest window
+    std::size_t start = end;
+    std::size_t qi = query.size();
+    for (std::size_t i = end + 1; i-- > 0;) {
+        if (equal(s[i], query[qi - 1]) && --qi == 0) {
+            start = i;
+            break;
+        }
+    }
+
+    int score = 0;
+    int consecutive = 0;
+    int chunkBonus = 0;
+    bool inGap = false;
+    qi = 0;
+    for (std::size_t i = start; i <= end; ++i) {
+        if (qi < query.size() && equal(s[i], query[qi])) {
+            int bonus = bonusAt(s, i);
+            if (consecutive == 0) {
+                chunkBonus = bonus;
+            } else {
+                // A run keeps the bonus of its first character
+                if (bonus >= BonusBoundary && bonus > chunkBonus)
+                    chunkBonus = bonus;
+                bonus = std::max({bonus, chunkBonus, BonusConsecutive});
+            }
+            if (qi == 0)
+                bonus *= BonusFirstCharMultiplier;
+            score += ScoreMatch + bonus;
+            ++qi;
+            ++consecutive;
+            inGap = false;
+        } else {
+            score -= inGap ? PenaltyGapExtension : PenaltyGapStart;
+            inGap = true;
+            consecutive = 0;
+        }
+    }
+
+    const std::size_t lastSlash = s.rfind('/');
+    if (lastSlash == std::string_view::npos || start > lastSlash)
+        score += BonusBasename;
+    return std::max(score, 0);
+}
+
+FuzzyResults fuzzyFind(const FuzzyCandidates& candidates, const FuzzyMatcher& matcher, std::size_t limit,
+                       const std::vector<std::uint32_t>* within, unsigned threads)
+{
+    const std::size_t count = within ? within->size() : candidates.size();
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t chunks = std::max<std::size_t>(1, std::min<std::size_t>(threads, count / MinChunk));
+
+    const Better better{candidates};
+    struct Chunk {
+        std::vector<FuzzyHit> heap;            // worst of the best on top
+        std::vector<std::uint32_t> matched;
+    };
+    std::vector<Chunk> results(chunks);
+
+    auto scan = [&](std::size_t c) {
+        Chunk& chunk = results[c];
+        const std::size_t from = count * c / chunks;
+        const std::size_t to = count * (c + 1) / chunks;
+        const std::uint64_t mask = matcher.mask();
+        for (std::size_t k = from; k < to; ++k) {
+            const std::uint32_t i = within ? (*within)[k] : static_cast<std::uint32_t>(k);
+            if ((mask & ~candidates.mask(i)) != 0)
+                continue;
+            const int score = matcher.score(candidates.at(i));
+            if (score < 0)
+                continue;
+            chunk.matched.push_back(i);
+            if (limit == 0)
+                continue;
+            const FuzzyHit hit{i, score};
+            if (chunk.heap.size() < limit) {
+                chunk.heap.push_back(hit);
+                std::push_heap(chunk.heap.begin(), chunk.heap.end(), better);
+            } else if (better(hit, chunk.heap.front())) {
+                std::pop_heap(chunk.heap.begin(), chunk.heap.end(), better);
+                chunk.heap.back() = hit;
+                std::push_heap(chunk.heap.begin(), chunk.heap.end(), better);
+            }
+        }
+    };
+
+    if (chunks == 1) {
+        scan(0);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(chunks - 1);
+        for (std::size_t c = 1; c < chunks; ++c)
+            workers.emplace_back(scan, c);
+        scan(0);
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    FuzzyResults out;
+    std::size_t matched = 0;
+    for (const Chunk& chunk : results)
+        matched += chunk.matched.size();
+    out.matched.reserve(matched);
+    for (Chunk& chunk : results) {
+        out.matched.insert(out.matched.end(), chunk.matched.begin(), chunk.matched.end());
+        out.best.insert(out.best.end(), chunk.heap.begin(), chunk.heap.end());
+    }
+    std::sort(out.best.begin(), out.best.end(), better);
+    if (out.best.size() > limit)
+        out.best.resize(limit);
+    return out;
+}
+
+} // namespace search
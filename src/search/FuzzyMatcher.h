@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace search {
+
+// Paths to fuzzy-match, stored back to back in one buffer. Each path also
+// gets a 64-bit summary of the bytes it contains (one bit per byte value
+// modulo 64, ASCII letters folded), which rejects most non-matching paths
+// with a single AND before any of their bytes are looked at.
+class FuzzyCandidates {
+public:
+    void reserve(std::size_t count, std::size_t bytes);
+    void add(std::string_view path);
+
+    std::size_t size() const { return m_masks.size(); }
+    bool empty() const { return m_masks.empty(); }
+    std::string_view at(std::size_t i) const
+    {
+        return std::string_view(m_text.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+    std::uint64_t mask(std::size_t i) const { return m_masks[i]; }
+
+    static std::uint64_t maskOf(std::string_view text);
+
+private:
+    std::string m_text;
+    std::vector<std::size_t> m_offsets{0};   // path i is m_text[m_offsets[i], m_offsets[i + 1])
+    std::vector<std::uint64_t> m_masks;
+};
+
+// fzf-style fuzzy matcher: a path matches if it contains the characters of
+// the query in order, with anything in between. Smart case: the query is
+// matched case-insensitively (ASCII) unless it contains an uppercase letter.
+//
+// Scoring looks for the shortest window holding the query - found with one
+// forward scan (memchr from one query character to the next) and one
+// backward scan, so it is linear in the path length - and
+// rewards characters matched at the start of a path component or a word
+// ('/', '_', '-', '.', ' ', camelCase humps) and runs of consecutive
+// characters; gaps cost a little. Matches entirely in the last component
+// get a bonus, so "main" ranks src/main.cpp above main/src/x.cpp.
+class FuzzyMatcher {
+public:
+    explicit FuzzyMatcher(std::string_view query);
+
+    // Score of `candidate`, higher is better; -1 if it does not match. An
+    // empty query matches everything with score 0.
+    int score(std::string_view candidate) const;
+
+    // Bits every matching candidate's FuzzyCandidates::mask() has.
+    std::uint64_t mask() const { return m_mask; }
+
+    const std::string& query() const { return m_query; }
+
+private:
+    std::size_t findChar(std::string_view s, std::size_t from, char q) const;
+    bool equal(char c, char q) const;
+
+    std::string m_query;
+    std::string m_pattern;      // m_query, folded unless case-sensitive
+    std::uint64_t m_mask = 0;
+    bool m_caseSensitive = false;
+};
+
+struct FuzzyHit {
+    std::uint32_t index = 0;    // into FuzzyCandidates
+    int score = 0;
+};
+
+struct FuzzyResults {
+    std::vector<FuzzyHit> best;              // up to `limit` hits, best first
+    std::vector<std::uint32_t> matched;      // every matching candidate, ascending
+    std::size_t matchCount() const { return matched.size(); }
+};
+
+// Score the candidates - or only those listed in `within`, ascending, e.g.
+// the previous results when the query was extended - on up to `threads`
+// threads (0 = one per core). Each thread keeps its own top `limit` in a
+// heap; ties rank shorter paths first, then earlier candidates.
+FuzzyResults fuzzyFind(const FuzzyCandidates& candidates, const FuzzyMatcher& matcher, std::size_t limit,
+                       const std::vector<std::uint32_t>* within = nullptr, unsigned threads = 0);
+
+} // namespace search
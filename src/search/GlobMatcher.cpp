@@ -0,0 +1,378 @@
+#include "GlobMatcher.h"
+#include "LiteralMatcher.h"
+
+#include <algorithm>
+
+namespace search {
+
+namespace {
+
+bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// Decode the code point at `pos` and advance past it. Malformed sequences
+// yield their first byte as a code point of its own.
+char32_t nextCodePoint(std::string_view s, std::size_t& pos)
+{
+    const auto b0 = static_cast<unsigned char>(s[pos]);
+    std::size_t len = 0;
+    char32_t cp = 0;
+    if (b0 < 0x80) {
+        ++pos;
+        return b0;
+    }
+    if ((b0 & 0xE0) == 0xC0) {
+        len = 2;
+        cp = b0 & 0x1F;
+    } else if ((b0 & 0xF0) == 0xE0) {
+        len = 3;
+        cp = b0 & 0x0F;
+    } else if ((b0 & 0xF8) == 0xF0) {
+        len = 4;
+        cp = b0 & 0x07;
+    }
+    if (len == 0 || pos + len > s.size()) {
+        ++pos;
+        return b0;
+    }
+    for (std::size_t i = 1; i < len; ++i) {
+        const auto b = static_cast<unsigned char>(s[pos + i]);
+        if ((b & 0xC0) != 0x80) {
+            ++pos;
+            return b0;
+        }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    pos += len;
+    return cp;
+}
+
+char32_t otherCase(char32_t c)
+{
+    if (c >= 'a' && c <= 'z')
+        return c - ('a' - 'A');
+    if (c >= 'A' && c <= 'Z')
+        return c + ('a' - 'A');
+    return c;
+}
+
+// Position after the set starting at mask[pos] == '[', or npos if the
+// bracket is not closed (and therefore literal).
+std::size_t setEnd(std::string_view mask, std::size_t pos)
+{
+    std::size_t i = pos + 1;
+    if (i < mask.size() && (mask[i] == '!' || mask[i] == '^'))
+        ++i;
+    if (i < mask.size() && mask[i] == ']')   // "[]...]": a leading ']' is a member
+        ++i;
+    const std::size_t close = mask.find(']', i);
+    return close == std::string_view::npos ? close : close + 1;
+}
+
+// "*.ext" with a plain extension
+bool isExtensionMask(std::string_view mask, std::size_t maxLength)
+{
+    return mask.size() > 2 && mask.size() - 2 <= maxLength && mask[0] == '*' && mask[1] == '.' &&
+           mask.find_first_of("*?[.", 2) == std::string_view::npos;
+}
+
+} // anonymous namespace
+
+GlobMatcher::GlobMatcher(std::string_view masks, GlobOptions options)
+    : m_caseSensitive(options.caseSensitive)
+{
+    std::vector<std::string> list = split(masks);
+    std::vector<std::string> extensions;
+    for (std::string& mask : list) {
+        if (options.partOfName) {
+            if (mask.front() != '*')
+                mask.insert(mask.begin(), '*');
+            if (mask.back() != '*')
+                mask.push_back('*');
+        }
+        if (isExtensionMask(mask, MaxFoldedExtension))
+            extensions.push_back(mask.substr(2));
+    }
+
+    // A single extension is as cheap to test as a suffix
+    if (extensions.size() >= 2) {
+        for (std::string& ext : extensions) {
+            if (!m_caseSensitive)
+                std::transform(ext.begin(), ext.end(), ext.begin(),
+                               [](char c) { return static_cast<char>(foldAscii(static_cast<unsigned char>(c))); });
+            m_maxExtension = std::max(m_maxExtension, ext.size());
+            m_extensions.insert(std::move(ext));
+        }
+    }
+
+    for (const std::string& mask : list) {
+        if (!m_extensions.empty() && isExtensionMask(mask, MaxFoldedExtension))
+            continue;
+        compile(mask);
+    }
+
+    if (m_masks.size() == 1 && m_extensions.empty()) {
+        const Mask& mask = m_masks.front();
+        if (mask.kind != Kind::Glob) {
+            m_requiredLiteral = mask.text;
+        } else {
+            for (const Token& token : mask.tokens) {
+                if (token.type == Token::Literal && token.text.size() > m_requiredLiteral.size())
+                    m_requiredLiteral = token.text;
+            }
+        }
+    }
+}
+
+std::vector<std::string> GlobMatcher::split(std::string_view masks)
+{
+    std::vector<std::string> result;
+    std::size_t start = 0;
+    while (start <= masks.size()) {
+        std::size_t end = masks.find(';', start);
+        if (end == std::string_view::npos)
+            end = masks.size();
+        std::string_view mask = masks.substr(start, end - start);
+        while (!mask.empty() && isBlank(mask.front()))
+            mask.remove_prefix(1);
+        while (!mask.empty() && isBlank(mask.back()))
+            mask.remove_suffix(1);
+        if (!mask.empty())
+            result.emplace_back(mask);
+        start = end + 1;
+    }
+    return result;
+}
+
+bool GlobMatcher::supports(std::string_view masks, bool caseSensitive)
+{
+    return caseSensitive || LiteralMatcher::supports(masks, false);
+}
+
+void GlobMatcher::compile(const std::string& mask)
+{
+    Mask compiled;
+    std::string literal;
+
+    auto fold = [this](std::string text) {
+        if (!m_caseSensitive) {
+            for (char& c : text)
+                c = static_cast<char>(foldAscii(static_cast<unsigned char>(c)));
+        }
+        return text;
+    };
+    auto tokenOf = [](Token::Type type) {
+        Token token;
+        token.type = type;
+        return token;
+    };
+    auto flushLiteral = [&]() {
+        if (!literal.empty()) {
+            Token token;
+            token.text = fold(std::move(literal));
+            compiled.tokens.push_back(std::move(token));
+            literal.clear();
+        }
+    };
+
+    for (std::size_t i = 0; i < mask.size();) {
+        const char c = mask[i];
+        if (c == '*') {
+            flushLiteral();
+            if (compiled.tokens.empty() || compiled.tokens.back().type != Token::Star)
+                compiled.tokens.push_back(tokenOf(Token::Star));
+            ++i;
+        } else if (c == '?') {
+            flushLiteral();
+            compiled.tokens.push_back(tokenOf(Token::AnyChar));
+            ++i;
+        } else if (c == '[' && setEnd(mask, i) != std::string::npos) {
+            flushLiteral();
+            const std::size_t end = setEnd(mask, i) - 1;   // the closing ']'
+            Token token = tokenOf(Token::Set);
+            std::size_t j = i + 1;
+            if (mask[j] == '!' || mask[j] == '^') {
+                token.negated = true;
+                ++j;
+            }
+            while (j < end) {
+                const char32_t lo = nextCodePoint(mask, j);
+                char32_t hi = lo;
+                if (j + 1 < end && mask[j] == '-') {
+                    ++j;
+                    hi = nextCodePoint(mask, j);
+                }
+                token.ranges.emplace_back(lo, hi);
+            }
+            compiled.tokens.push_back(std::move(token));
+            i = end + 1;
+        } else {
+            literal.push_back(c);
+            ++i;
+        }
+    }
+    flushLiteral();
+
+    // Classify: a single literal with stars only around it needs no glob
+    const std::vector<Token>& t = compiled.tokens;
+    const bool leadingStar = !t.empty() && t.front().type == Token::Star;
+    const bool trailingStar = t.size() > 1 && t.back().type == Token::Star;
+    const std::size_t literals = static_cast<std::size_t>(
+        std::count_if(t.begin(), t.end(), [](const Token& token) { return token.type == Token::Literal; }));
+    const std::size_t stars = static_cast<std::size_t>(
+        std::count_if(t.begin(), t.end(), [](const Token& token) { return token.type == Token::Star; }));
+
+    if (literals + stars == t.size() && literals <= 1) {
+        if (literals == 0) {
+            compiled.kind = Kind::Any;
+        } else {
+            const std::size_t pos = leadingStar ? 1 : 0;
+            compiled.text = t[pos].text;
+            if (leadingStar && trailingStar)
+                compiled.kind = Kind::Contains;
+            else if (leadingStar)
+                compiled.kind = Kind::Suffix;
+            else if (trailingStar)
+                compiled.kind = Kind::Prefix;
+            else
+                compiled.kind = Kind::Exact;
+        }
+        compiled.tokens.clear();
+    } else {
+        compiled.kind = Kind::Glob;
+    }
+    m_masks.push_back(std::move(compiled));
+}
+
+bool GlobMatcher::equal(const char* name, std::string_view text) const
+{
+    if (m_caseSensitive)
+        return std::equal(text.begin(), text.end(), name);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (foldAscii(static_cast<unsigned char>(name[i])) != static_cast<unsigned char>(text[i]))
+            return false;
+    }
+    return true;
+}
+
+bool GlobMatcher::matchToken(const Token& token, std::string_view name, std::size_t& pos) const
+{
+    switch (token.type) {
+    case Token::Literal:
+        if (name.size() - pos < token.text.size() || !equal(name.data() + pos, token.text))
+            return false;
+        pos += token.text.size();
+        return true;
+    case Token::AnyChar:
+        nextCodePoint(name, pos);
+        return true;
+    case Token::Set: {
+        const char32_t c = nextCodePoint(name, pos);
+        const char32_t alt = m_caseSensitive ? c : otherCase(c);
+        bool inSet = false;
+        for (const auto& [lo, hi] : token.ranges) {
+            if ((c >= lo && c <= hi) || (alt >= lo && alt <= hi)) {
+                inSet = true;
+                break;
+            }
+        }
+        return inSet != token.negated;
+    }
+    case Token::Star:
+        break;
+    }
+    return false;
+}
+
+// Wildcard matching with backtracking to the last star only: when a later
+// token fails, the most recent star takes one more character and matching
+// resumes after it. Earlier stars never need to be revisited, which keeps
+// this linear in practice and O(n * m) at worst.
+bool GlobMatcher::matchGlob(const std::vector<Token>& tokens, std::string_view name) const
+{
+    std::size_t ti = 0;
+    std::size_t pos = 0;
+    std::size_t starToken = std::string::npos;
+    std::size_t starPos = 0;
+
+    while (ti < tokens.size() || pos < name.size()) {
+        if (ti < tokens.size()) {
+            const Token& token = tokens[ti];
+            if (token.type == Token::Star) {
+                starToken = ti++;
+                starPos = pos;
+                continue;
+            }
+            std::size_t next = pos;
+            if (pos < name.size() && matchToken(token, name, next)) {
+                pos = next;
+                ++ti;
+                continue;
+            }
+        }
+        if (starToken == std::string::npos || starPos >= name.size())
+            return false;
+        nextCodePoint(name, starPos);
+        ti = starToken + 1;
+        pos = starPos;
+    }
+    return true;
+}
+
+bool GlobMatcher::matches(std::string_view name) const
+{
+    if (!m_extensions.empty()) {
+        const std::size_t dot = name.rfind('.');
+        if (dot != std::string_view::npos && name.size() - dot - 1 <= m_maxExtension) {
+            std::string_view ext = name.substr(dot + 1);
+            char folded[MaxFoldedExtension];
+            if (!m_caseSensitive) {
+                for (std::size_t i = 0; i < ext.size(); ++i)
+                    folded[i] = static_cast<char>(foldAscii(static_cast<unsigned char>(ext[i])));
+                ext = std::string_view(folded, ext.size());
+            }
+            if (m_extensions.find(ext) != m_extensions.end())
+                return true;
+        }
+    }
+
+    for (const Mask& mask : m_masks) {
+        const std::size_t n = mask.text.size();
+        switch (mask.kind) {
+        case Kind::Any:
+            return true;
+        case Kind::Exact:
+            if (name.size() == n && equal(name.data(), mask.text))
+                return true;
+            break;
+        case Kind::Prefix:
+            if (name.size() >= n && equal(name.data(), mask.text))
+                return true;
+            break;
+        case Kind::Suffix:
+            if (name.size() >= n && equal(name.data() + name.size() - n, mask.text))
+                return true;
+            break;
+        case Kind::Contains:
+            if (m_caseSensitive) {
+                if (name.find(mask.text) != std::string_view::npos)
+                    return true;
+            } else {
+                for (std::size_t i = 0; i + n <= name.size(); ++i) {
+                    if (equal(name.data() + i, mask.text))
+                        return true;
+                }
+            }
+            break;
+        case Kind::Glob:
+            if (matchGlob(mask.tokens, name))
+                return true;
+            break;
+        }
+    }
+    return false;
+}
+
+} // namespace search
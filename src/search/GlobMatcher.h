@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace search {
+
+struct GlobOptions {
+    bool caseSensitive = false;
+    bool partOfName = false;     // masks not starting / ending with '*' get one added there
+};
+
+// Compiled file name mask: one or more wildcard patterns separated by ';'
+// ("*.cpp;*.h"), matched against whole names given as UTF-8 bytes.
+//
+// Wildcards: '*' matches any run of characters, '?' a single character and
+// [...] one character of a set ("[a-z]", "[!0-9]" or "[^0-9]"); everything
+// else, regex syntax included, is literal. Each mask is classified when
+// compiled, and the common forms avoid the general matcher altogether:
+// an exact name, "prefix*", "*suffix", "*part*", "*" and sets of plain
+// extensions ("*.c;*.h;*.cpp", one hash lookup on the name's extension).
+// Case-insensitive matching compares against the pre-folded mask through
+// the ASCII fold table; masks with non-ASCII characters need Unicode case
+// folding, which supports() reports so callers can fall back to a regex.
+class GlobMatcher {
+public:
+    GlobMatcher() = default;   // matches nothing
+    explicit GlobMatcher(std::string_view masks, GlobOptions options = {});
+
+    bool matches(std::string_view name) const;
+
+    // False if no mask was given (only separators and blanks).
+    bool empty() const { return m_masks.empty() && m_extensions.empty(); }
+
+    // A literal every matching name contains, or "" if there is none - e.g.
+    // with several masks. Useful to prefilter names in bulk.
+    const std::string& requiredLiteral() const { return m_requiredLiteral; }
+
+    // True if the masks can be matched exactly at the byte level.
+    static bool supports(std::string_view masks, bool caseSensitive);
+
+    // The masks of a ';'-separated list, trimmed, without empty ones.
+    static std::vector<std::string> split(std::string_view masks);
+
+private:
+    enum class Kind : std::uint8_t {
+        Any,         // "*"
+        Exact,
+        Prefix,      // "text*"
+        Suffix,      // "*text"
+        Contains,    // "*text*"
+        Glob         // anything else
+    };
+
+    struct Token {
+        enum Type : std::uint8_t { Literal, AnyChar, Star, Set };
+        Type type = Literal;
+        bool negated = false;                              // Set
+        std::string text;                                  // Literal, folded if case-insensitive
+        std::vector<std::pair<char32_t, char32_t>> ranges; // Set
+    };
+
+    struct Mask {
+        Kind kind;
+        std::string text;            // Exact/Prefix/Suffix/Contains, folded if case-insensitive
+        std::vector<Token> tokens;   // Glob
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    static constexpr std::size_t MaxFoldedExtension = 32;
+
+    void compile(const std::string& mask);
+    bool equal(const char* name, std::string_view text) const;
+    bool matchGlob(const std::vector<Token>& tokens, std::string_view name) const;
+    bool matchToken(const Token& token, std::string_view name, std::size_t& pos) const;
+
+    std::vector<Mask> m_masks;
+    std::unordered_set<std::string, StringHash, std::equal_to<>> m_extensions;   // "*.ext" masks, folded
+    std::size_t m_maxExtension = 0;
+    std::string m_requiredLiteral;
+    bool m_caseSensitive = false;
+};
+
+} // namespace search
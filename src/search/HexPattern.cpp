@@ -0,0 +1,144 @@
+#include "HexPattern.h"
+
+#include <algorithm>
+
+namespace search {
+
+namespace {
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // anonymous namespace
+
+std::vector<int> HexPatternMatcher::parse(std::string_view pattern)
+{
+    std::vector<int> bytes;
+    bool fixed = false;
+    std::size_t i = 0;
+    while (i < pattern.size()) {
+        if (isBlank(pattern[i])) {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= pattern.size())
+            return {};
+        const char hi = pattern[i];
+        const char lo = pattern[i + 1];
+        if (hi == '?' && lo == '?') {
+            bytes.push_back(-1);
+        } else if (hexDigit(hi) >= 0 && hexDigit(lo) >= 0) {
+            bytes.push_back(hexDigit(hi) * 16 + hexDigit(lo));
+            fixed = true;
+        } else {
+            return {};
+        }
+        i += 2;
+    }
+    if (!fixed)
+        return {};
+    return bytes;
+}
+
+bool HexPatternMatcher::isValid(std::string_view pattern)
+{
+    return !parse(pattern).empty();
+}
+
+HexPatternMatcher::HexPatternMatcher(const std::vector<std::string>& patterns)
+{
+    for (const std::string& text : patterns) {
+        Pattern pattern;
+        pattern.bytes = parse(text);
+
+        // Longest run of fixed bytes
+        std::size_t bestStart = 0;
+        std::size_t bestLength = 0;
+        for (std::size_t i = 0; i < pattern.bytes.size();) {
+            if (pattern.bytes[i] < 0) {
+                ++i;
+                continue;
+            }
+            std::size_t j = i;
+            while (j < pattern.bytes.size() && pattern.bytes[j] >= 0)
+                ++j;
+            if (j - i > bestLength) {
+                bestStart = i;
+                bestLength = j - i;
+            }
+            i = j;
+        }
+
+        // An invalid pattern stays in the list, so indices keep matching the
+        // caller's, but never matches
+        if (bestLength > 0) {
+            std::string anchor;
+            for (std::size_t i = bestStart; i < bestStart + bestLength; ++i)
+                anchor.push_back(static_cast<char>(pattern.bytes[i]));
+            pattern.anchorOffset = bestStart;
+            pattern.anchor = std::make_unique<LiteralMatcher>(anchor, true);
+        }
+        m_maxLength = std::max(m_maxLength, pattern.bytes.size());
+        m_patterns.push_back(std::move(pattern));
+    }
+}
+
+bool HexPatternMatcher::findPattern(const Pattern& pattern, const char* data, std::size_t len, std::size_t from,
+                                    std::size_t& offset) const
+{
+    const std::size_t n = pattern.bytes.size();
+    if (!pattern.anchor || len < n || from > len - n)
+        return false;
+
+    // The anchor must leave room for the bytes after it
+    const std::size_t anchorLength = pattern.anchor->maxMatchLength();
+    const std::size_t tail = n - pattern.anchorOffset - anchorLength;
+    std::size_t pos = from + pattern.anchorOffset;
+    Match m;
+    while (pattern.anchor->find(data, len - tail, pos, m)) {
+        const std::size_t start = m.offset - pattern.anchorOffset;
+        bool matched = true;
+        for (std::size_t i = 0; i < n && matched; ++i) {
+            const int b = pattern.bytes[i];
+            matched = b < 0 || static_cast<unsigned char>(data[start + i]) == b;
+        }
+        if (matched) {
+            offset = start;
+            return true;
+        }
+        pos = m.offset + 1;
+    }
+    return false;
+}
+
+bool HexPatternMatcher::find(const char* data, std::size_t len, std::size_t from, Match& out) const
+{
+    bool found = false;
+    for (std::size_t p = 0; p < m_patterns.size(); ++p) {
+        // Only the part before the best match so far is worth searching
+        const std::size_t limit = found ? std::min(len, out.offset + m_patterns[p].bytes.size()) : len;
+        std::size_t offset;
+        if (findPattern(m_patterns[p], data, limit, from, offset) && (!found || offset < out.offset)) {
+            out.offset = offset;
+            out.length = m_patterns[p].bytes.size();
+            out.pattern = static_cast<int>(p);
+            found = true;
+        }
+    }
+    return found;
+}
+
+} // namespace search
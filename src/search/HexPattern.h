@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ByteMatcher.h"
+#include "LiteralMatcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace search {
+
+// Binary signatures written in hex, with "??" for any byte: "7F 45 4C 46 ?? 01".
+// Blanks between bytes are optional. A file matches if it contains any of
+// the patterns; Match::pattern tells which.
+//
+// Each pattern is located through its longest run of fixed bytes, found
+// with LiteralMatcher (SSE2), and the remaining bytes are checked around
+// it. Bytes are compared exactly - there is no decoding and no case folding.
+class HexPatternMatcher : public ByteMatcher {
+public:
+    // Patterns that are not valid (see isValid()) never match.
+    explicit HexPatternMatcher(const std::vector<std::string>& patterns);
+
+    bool find(const char* data, std::size_t len, std::size_t from, Match& out) const override;
+    std::size_t maxMatchLength() const override { return m_maxLength; }
+
+    // True if `pattern` is a well-formed hex pattern with at least one fixed byte.
+    static bool isValid(std::string_view pattern);
+
+    // The bytes of `pattern`, -1 standing for "??". Empty if it is not valid.
+    static std::vector<int> parse(std::string_view pattern);
+
+private:
+    struct Pattern {
+        std::vector<int> bytes;                  // -1 = any byte
+        std::size_t anchorOffset = 0;            // where the anchor starts in `bytes`
+        std::unique_ptr<LiteralMatcher> anchor;  // longest run without wildcards
+    };
+
+    bool findPattern(const Pattern& pattern, const char* data, std::size_t len, std::size_t from,
+                     std::size_t& offset) const;
+
+    std::vector<Pattern> m_patterns;
+    std::size_t m_maxLength = 0;
+};
+
+} // namespace search
@@ -0,0 +1,234 @@
+#include "IgnoreRules.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace search {
+
+namespace {
+
+bool hasWildcard(std::string_view s)
+{
+    return s.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+// Matches the set starting at p[pi] == '[' against c, advancing pi past it.
+// Returns false with pi unchanged if the bracket is not closed.
+bool matchSet(std::string_view p, std::size_t& pi, char c, bool& inSet)
+{
+    std::size_t i = pi + 1;
+    bool negated = false;
+    if (i < p.size() && (p[i] == '!' || p[i] == '^')) {
+        negated = true;
+        ++i;
+    }
+    bool found = false;
+    bool first = true;
+    while (i < p.size() && (p[i] != ']' || first)) {
+        first = false;
+        char lo = p[i];
+        if (lo == '\\' && i + 1 < p.size())
+            lo = p[++i];
+        char hi = lo;
+        if (i + 2 < p.size() && p[i + 1] == '-' && p[i + 2] != ']') {
+            hi = p[i + 2];
+            i += 2;
+        }
+        if (c >= lo && c <= hi)
+            found = true;
+        ++i;
+    }
+    if (i >= p.size())
+        return false;
+    pi = i + 1;
+    inSet = found != negated;
+    return true;
+}
+
+// Wildcard match where '*', '?' and sets stop at '/', and "**" between
+// slashes (or at either end) spans any number of directories.
+bool matchPath(std::string_view p, std::string_view s)
+{
+    std::size_t pi = 0;
+    std::size_t si = 0;
+    while (pi < p.size()) {
+        char c = p[pi];
+        if (c == '*') {
+            const bool atStart = pi == 0 || p[pi - 1] == '/';
+            if (pi + 1 < p.size() && p[pi + 1] == '*' && atStart &&
+                (pi + 2 == p.size() || p[pi + 2] == '/')) {
+                if (pi + 2 == p.size())
+                    return true;
+                // "**/": try the rest at this and every following directory
+                const std::string_view rest = p.substr(pi + 3);
+                for (std::size_t k = si;;) {
+                    if (matchPath(rest, s.substr(k)))
+                        return true;
+                    k = s.find('/', k);
+                    if (k == std::string_view::npos)
+                        return false;
+                    ++k;
+                }
+            }
+            while (pi < p.size() && p[pi] == '*')
+                ++pi;
+            const std::string_view rest = p.substr(pi);
+            for (std::size_t k = si;; ++k) {
+                if (matchPath(rest, s.substr(k)))
+                    return true;
+                if (k == s.size() || s[k] == '/')
+                    return false;
+            }
+        }
+        if (si >= s.size())
+            return false;
+        if (c == '?') {
+            if (s[si] == '/')
+                return false;
+        } else if (c == '[') {
+            bool inSet = false;
+            if (matchSet(p, pi, s[si], inSet)) {
+                if (!inSet || s[si] == '/')
+                    return false;
+                ++si;
+                continue;
+            }
+            if (s[si] != c)
+                return false;
+        } else {
+            if (c == '\\' && pi + 1 < p.size())
+                c = p[++pi];
+            if (s[si] != c)
+                return false;
+        }
+        ++pi;
+        ++si;
+    }
+    return si == s.size();
+}
+
+} // anonymous namespace
+
+void IgnoreRules::parse(std::string_view text)
+{
+    while (!text.empty()) {
+        std::size_t end = text.find('\n');
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end < text.size() ? end + 1 : end);
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        // Trailing blanks are dropped unless escaped
+        while (!line.empty() && line.back() == ' ' && !(line.size() >= 2 && line[line.size() - 2] == '\\'))
+            line.remove_suffix(1);
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        Rule rule;
+        if (line.front() == '!') {
+            rule.negated = true;
+            line.remove_prefix(1);
+        }
+        if (!line.empty() && line.back() == '/') {
+            rule.dirOnly = true;
+            line.remove_suffix(1);
+        }
+        if (line.find('/') != std::string_view::npos) {
+            rule.anchored = true;
+            if (line.front() == '/')
+                line.remove_prefix(1);
+        }
+        if (line.empty())
+            continue;
+
+        if (!rule.anchored && !hasWildcard(line)) {
+            rule.kind = Kind::Exact;
+        } else if (!rule.anchored && line.size() > 1 && line.front() == '*' && !hasWildcard(line.substr(1))) {
+            rule.kind = Kind::Suffix;
+            line.remove_prefix(1);
+        }
+        rule.pattern = std::string(line);
+        m_anchored = m_anchored || rule.anchored;
+        m_rules.push_back(std::move(rule));
+    }
+}
+
+bool IgnoreRules::load(int dirFd, const char* fileName)
+{
+    const int fd = ::openat(dirFd, fileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    std::string text;
+    char buffer[16 * 1024];
+    for (;;) {
+        const ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            ::close(fd);
+            if (n < 0)
+                return false;
+            break;
+        }
+        text.append(buffer, static_cast<std::size_t>(n));
+    }
+    parse(text);
+    return true;
+}
+
+IgnoreRules::Verdict IgnoreRules::match(std::string_view relPath, std::string_view name, bool isDir) const
+{
+    for (auto it = m_rules.rbegin(); it != m_rules.rend(); ++it) {
+        const Rule& rule = *it;
+        if (rule.dirOnly && !isDir)
+            continue;
+        bool matched = false;
+        switch (rule.kind) {
+            case Kind::Exact:
+                matched = name == rule.pattern;
+                break;
+            case Kind::Suffix:
+                matched = name.size() >= rule.pattern.size() &&
+                          name.substr(name.size() - rule.pattern.size()) == rule.pattern;
+                break;
+            case Kind::Glob:
+                matched = matchPath(rule.pattern, rule.anchored ? relPath : name);
+                break;
+        }
+        if (matched)
+            return rule.negated ? Verdict::Include : Verdict::Ignore;
+    }
+    return Verdict::None;
+}
+
+bool IgnoreScope::ignores(std::string_view entryDir, std::string_view name, bool isDir) const
+{
+    std::string relPath;
+    for (const IgnoreScope* scope = this; scope; scope = scope->parent.get()) {
+        if (scope->rules.needsPath()) {
+            relPath = scope->prefix;
+            if (entryDir.size() > scope->dirPath.size()) {
+                std::string_view below = entryDir.substr(scope->dirPath.size());
+                if (below.front() == '/')
+                    below.remove_prefix(1);
+                if (!relPath.empty())
+                    relPath.push_back('/');
+                relPath.append(below);
+            }
+            if (!relPath.empty())
+                relPath.push_back('/');
+            relPath.append(name);
+        }
+        const IgnoreRules::Verdict verdict = scope->rules.match(relPath, name, isDir);
+        if (verdict != IgnoreRules::Verdict::None)
+            return verdict == IgnoreRules::Verdict::Ignore;
+    }
+    return false;
+}
+
+} // namespace search
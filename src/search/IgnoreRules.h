@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace search {
+
+// The rules of one .gitignore-style file.
+//
+// Follows gitignore(5): blank lines and '#' comments are skipped, '!'
+// re-includes, a trailing '/' restricts a rule to directories, and a rule
+// with a '/' anywhere else is anchored to the file's directory - otherwise it
+// is matched against the entry name at any depth. '*', '?' and [...] do not
+// match '/'; "**/", "/**/" and "/**" match across directories. Matching is
+// case-sensitive and byte-wise. The last rule that matches decides.
+class IgnoreRules {
+public:
+    enum class Verdict {
+        None,       // no rule matched
+        Ignore,
+        Include     // a '!' rule matched last
+    };
+
+    // Add the rules in `text` (one per line) after the existing ones.
+    void parse(std::string_view text);
+
+    // Read and parse `fileName` relative to the directory open as `dirFd`
+    // (AT_FDCWD for the current directory). False if it can't be read.
+    bool load(int dirFd, const char* fileName);
+
+    bool empty() const { return m_rules.empty(); }
+
+    // True if some rule must see the path and not just the name.
+    bool needsPath() const { return m_anchored; }
+
+    // `relPath` is the entry's path relative to the file's directory; it is
+    // only looked at if needsPath().
+    Verdict match(std::string_view relPath, std::string_view name, bool isDir) const;
+
+private:
+    enum class Kind : unsigned char {
+        Exact,      // no wildcards
+        Suffix,     // '*' followed by a plain suffix ("*.o")
+        Glob
+    };
+
+    struct Rule {
+        std::string pattern;     // Exact: the name, Suffix: the suffix
+        Kind kind = Kind::Glob;
+        bool negated = false;
+        bool dirOnly = false;
+        bool anchored = false;   // match relPath rather than the name
+    };
+
+    std::vector<Rule> m_rules;
+    bool m_anchored = false;
+};
+
+// The ignore files in effect in one directory of a walk: the rules read
+// there, then those of its ancestors. Scopes are shared by all directories
+// below them and only created where an ignore file was found.
+struct IgnoreScope {
+    std::string dirPath;    // walked path the rules' paths are relative to
+    std::string prefix;     // path from the rules' directory to dirPath, if
+                            // they were read above the walk root
+    IgnoreRules rules;
+    std::shared_ptr<const IgnoreScope> parent;
+
+    // True if entry `name` of directory `entryDir` (a path at or below
+    // dirPath) is ignored. Rules of deeper scopes take precedence.
+    bool ignores(std::string_view entryDir, std::string_view name, bool isDir) const;
+};
+
+} // namespace search
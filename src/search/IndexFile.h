@@ -0,0 +1,162 @@
+#pragma once
+
+// Helpers shared by the on-disk indexes (NameIndex, TrigramIndex).
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FdGuard.h"
+
+namespace search::detail {
+
+inline std::size_t align8(std::size_t n)
+{
+    return (n + 7) & ~std::size_t(7);
+}
+
+// Order in which every directory is directly followed by its subtree:
+// like a byte-wise comparison, but with '/' sorting before any other byte.
+inline bool pathLess(std::string_view a, std::string_view b)
+{
+    const std::size_t n = std::min(a.size(), b.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        if (a[i] == b[i])
+            continue;
+        if (a[i] == '/')
+            return true;
+        if (b[i] == '/')
+            return false;
+        return static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[i]);
+    }
+    return a.size() < b.size();
+}
+
+inline bool inSubtree(std::string_view path, std::string_view subtree)
+{
+    if (subtree.empty())
+        return true;
+    return path.size() >= subtree.size() && path.compare(0, subtree.size(), subtree) == 0 &&
+           (path.size() == subtree.size() || path[subtree.size()] == '/');
+}
+
+inline std::string joinPath(std::string_view dir, std::string_view name)
+{
+    std::string result;
+    result.reserve(dir.size() + 1 + name.size());
+    result.append(dir);
+    if (!result.empty())
+        result.push_back('/');
+    result.append(name);
+    return result;
+}
+
+inline std::string normalizedRoot(const std::string& root)
+{
+    std::string result = root;
+    while (result.size() > 1 && result.back() == '/')
+        result.pop_back();
+    return result;
+}
+
+inline std::int64_t mtimeOf(const struct stat& st)
+{
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+inline std::int64_t ctimeOf(const struct stat& st)
+{
+    return static_cast<std::int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+}
+
+inline unsigned resolveThreads(unsigned threads)
+{
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Call fn(begin, end) for up to `threads` slices of [0, count), each slice on
+// its own thread, the first one on the calling thread.
+template<typename Fn>
+void forEachSlice(std::size_t count, unsigned threads, std::size_t minSlice, const Fn& fn)
+{
+    const std::size_t slices = std::max<std::size_t>(1, std::min<std::size_t>(threads, count / minSlice));
+    if (slices == 1) {
+        fn(std::size_t(0), count);
+        return;
+    }
+    std::vector<std::thread> helpers;
+    helpers.reserve(slices - 1);
+    for (std::size_t s = 1; s < slices; ++s)
+        helpers.emplace_back([&fn, count, slices, s]() { fn(count * s / slices, count * (s + 1) / slices); });
+    fn(std::size_t(0), count / slices);
+    for (std::thread& t : helpers)
+        t.join();
+}
+
+inline bool stopRequested(const std::atomic<bool>& stop, const std::atomic<bool>* cancel)
+{
+    return stop.load(std::memory_order_relaxed) || (cancel && cancel->load(std::memory_order_relaxed));
+}
+
+// Buffered sequential writer on a file descriptor.
+class FileWriter {
+public:
+    explicit FileWriter(int fd) : m_fd(fd) { m_buffer.reserve(BufferSize); }
+
+    void write(const void* data, std::size_t len)
+    {
+        if (m_buffer.size() + len > BufferSize)
+            flush();
+        if (len > BufferSize)
+            writeAll(static_cast<const char*>(data), len);
+        else
+            m_buffer.append(static_cast<const char*>(data), len);
+        m_written += len;
+    }
+
+    void padTo8()
+    {
+        static const char zeros[8] = {};
+        write(zeros, align8(m_written) - m_written);
+    }
+
+    bool flush()
+    {
+        writeAll(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+        return m_ok;
+    }
+
+private:
+    static constexpr std::size_t BufferSize = 1024 * 1024;
+
+    void writeAll(const char* data, std::size_t len)
+    {
+        while (m_ok && len > 0) {
+            const ssize_t n = ::write(m_fd, data, len);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                m_ok = false;
+                return;
+            }
+            data += n;
+            len -= static_cast<std::size_t>(n);
+        }
+    }
+
+    int m_fd;
+    std::string m_buffer;
+    std::uint64_t m_written = 0;
+    bool m_ok = true;
+};
+
+} // namespace search::detail
@@ -0,0 +1,139 @@
+#include "LiteralMatcher.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace search {
+
+namespace {
+
+unsigned char upperAscii(unsigned char c)
+{
+    return c >= 'a' && c <= 'z' ? static_cast<unsigned char>(c - ('a' - 'A')) : c;
+}
+
+} // anonymous namespace
+
+bool isWordByte(unsigned char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+LiteralMatcher::LiteralMatcher(std::string_view needle, bool caseSensitive)
+    : m_needle(needle)
+    , m_caseSensitive(caseSensitive)
+{
+    if (!m_caseSensitive) {
+        for (char& c : m_needle)
+            c = static_cast<char>(foldAscii(static_cast<unsigned char>(c)));
+    }
+}
+
+bool LiteralMatcher::supports(std::string_view needle, bool caseSensitive)
+{
+    if (caseSensitive)
+        return true;
+    for (char c : needle) {
+        if (static_cast<unsigned char>(c) >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+bool LiteralMatcher::verify(const char* candidate) const
+{
+    const std::size_t n = m_needle.size();
+    if (m_caseSensitive)
+        return std::memcmp(candidate, m_needle.data(), n) == 0;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (foldAscii(static_cast<unsigned char>(candidate[i])) != static_cast<unsigned char>(m_needle[i]))
+            return false;
+    }
+    return true;
+}
+
+bool LiteralMatcher::findScalar(const char* data, std::size_t len, std::size_t from, std::size_t& pos) const
+{
+    const std::size_t n = m_needle.size();
+    if (len < n)
+        return false;
+    const std::size_t lastStart = len - n;
+    const unsigned char first = static_cast<unsigned char>(m_needle[0]);
+
+    if (m_caseSensitive) {
+        std::size_t i = from;
+        while (i <= lastStart) {
+            const void* hit = std::memchr(data + i, first, lastStart - i + 1);
+            if (!hit)
+                return false;
+            i = static_cast<std::size_t>(static_cast<const char*>(hit) - data);
+            if (verify(data + i)) {
+                pos = i;
+                return true;
+            }
+            ++i;
+        }
+        return false;
+    }
+
+    for (std::size_t i = from; i <= lastStart; ++i) {
+        if (foldAscii(static_cast<unsigned char>(data[i])) == first && verify(data + i)) {
+            pos = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LiteralMatcher::find(const char* data, std::size_t len, std::size_t from, Match& out) const
+{
+    const std::size_t n = m_needle.size();
+    if (n == 0) {
+        if (from > len)
+            return false;
+        out = Match{from, 0, 0};
+        return true;
+    }
+
+    std::size_t i = from;
+
+#ifdef __SSE2__
+    // Compare the first and the last needle byte against 16 candidate
+    // positions per iteration; only positions where both agree are verified.
+    const unsigned char first = static_cast<unsigned char>(m_needle[0]);
+    const unsigned char last = static_cast<unsigned char>(m_needle[n - 1]);
+    const __m128i firstLo = _mm_set1_epi8(static_cast<char>(first));
+    const __m128i firstUp = _mm_set1_epi8(static_cast<char>(m_caseSensitive ? first : upperAscii(first)));
+    const __m128i lastLo = _mm_set1_epi8(static_cast<char>(last));
+    const __m128i lastUp = _mm_set1_epi8(static_cast<char>(m_caseSensitive ? last : upperAscii(last)));
+
+    while (i + n - 1 + 16 <= len) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+        const __m128i eqFirst = _mm_or_si128(_mm_cmpeq_epi8(blockFirst, firstLo), _mm_cmpeq_epi8(blockFirst, firstUp));
+        const __m128i eqLast = _mm_or_si128(_mm_cmpeq_epi8(blockLast, lastLo), _mm_cmpeq_epi8(blockLast, lastUp));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(eqFirst, eqLast)));
+        while (mask) {
+            const std::size_t candidate = i + static_cast<std::size_t>(__builtin_ctz(mask));
+            if (verify(data + candidate)) {
+                out = Match{candidate, n, 0};
+                return true;
+            }
+            mask &= mask - 1;
+        }
+        i += 16;
+    }
+#endif
+
+    std::size_t pos;
+    if (!findScalar(data, len, i, pos))
+        return false;
+    out = Match{pos, n, 0};
+    return true;
+}
+
+} // namespace search
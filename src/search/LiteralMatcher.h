@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ByteMatcher.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace search {
+
+namespace detail {
+
+constexpr std::array<unsigned char, 256> makeAsciiFoldTable()
+{
+    std::array<unsigned char, 256> table{};
+    for (int c = 0; c < 256; ++c)
+        table[c] = static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    return table;
+}
+
+} // namespace detail
+
+// ASCII case folding table: maps 'A'-'Z' to 'a'-'z', every other byte to itself.
+inline constexpr std::array<unsigned char, 256> asciiFoldTable = detail::makeAsciiFoldTable();
+
+inline unsigned char foldAscii(unsigned char c)
+{
+    return asciiFoldTable[c];
+}
+
+// True if the byte is an ASCII word character ([A-Za-z0-9_]), i.e. what \w
+// matches in a QRegularExpression without UseUnicodePropertiesOption.
+bool isWordByte(unsigned char c);
+
+// Single fixed-string matcher.
+//
+// Candidates are located by comparing the first and the last byte of the
+// needle against 16 positions at a time (SSE2 where available, memchr
+// otherwise) and then verified with memcmp, or through the fold table when
+// matching case-insensitively. Case-insensitive matching only folds ASCII
+// letters; callers with non-ASCII needles must decode and compare themselves.
+class LiteralMatcher : public ByteMatcher {
+public:
+    LiteralMatcher(std::string_view needle, bool caseSensitive);
+
+    bool find(const char* data, std::size_t len, std::size_t from, Match& out) const override;
+    std::size_t maxMatchLength() const override { return m_needle.size(); }
+
+    // True if the needle can be matched correctly at the byte level.
+    static bool supports(std::string_view needle, bool caseSensitive);
+
+private:
+    bool verify(const char* candidate) const;
+    bool findScalar(const char* data, std::size_t len, std::size_t from, std::size_t& pos) const;
+
+    std::string m_needle;       // folded when case-insensitive
+    bool m_caseSensitive;
+};
+
+} // namespace search
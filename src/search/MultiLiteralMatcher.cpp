@@ -0,0 +1,154 @@
+#include "MultiLiteralMatcher.h"
+#include "LiteralMatcher.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+namespace search {
+
+namespace {
+
+constexpr std::uint32_t NoState = std::numeric_limits<std::uint32_t>::max();
+
+} // anonymous namespace
+
+MultiLiteralMatcher::MultiLiteralMatcher(const std::vector<std::string>& patterns, bool caseSensitive)
+    : m_caseSensitive(caseSensitive)
+{
+    build(patterns);
+}
+
+void MultiLiteralMatcher::build(const std::vector<std::string>& patterns)
+{
+    const auto fold = [this](unsigned char c) { return m_caseSensitive ? c : foldAscii(c); };
+
+    // Byte classes: one per distinct (folded) byte used by a pattern, class 0
+    // for everything else. Upper-case letters share the class of their
+    // lower-case form when matching case-insensitively.
+    for (const std::string& p : patterns) {
+        for (char ch : p) {
+            const unsigned char c = fold(static_cast<unsigned char>(ch));
+            if (m_classOf[c] == 0)
+                m_classOf[c] = static_cast<std::uint16_t>(m_classCount++);
+        }
+    }
+    if (!m_caseSensitive) {
+        for (int c = 'A'; c <= 'Z'; ++c)
+            m_classOf[c] = m_classOf[foldAscii(static_cast<unsigned char>(c))];
+    }
+
+    // Trie
+    auto addState = [this]() {
+        m_next.resize(m_next.size() + m_classCount, NoState);
+        m_bestLength.push_back(0);
+        m_bestPattern.push_back(-1);
+        return static_cast<std::uint32_t>(m_bestLength.size() - 1);
+    };
+    addState();   // root
+
+    for (std::size_t i = 0; i < patterns.size(); ++i) {
+        const std::string& p = patterns[i];
+        if (p.empty())
+            continue;
+        std::uint32_t state = 0;
+        for (char ch : p) {
+            const std::size_t slot = state * m_classCount + m_classOf[static_cast<unsigned char>(ch)];
+            if (m_next[slot] == NoState) {
+                const std::uint32_t created = addState();
+                m_next[slot] = created;   // m_next may have been reallocated by addState()
+            }
+            state = m_next[slot];
+        }
+        if (m_bestLength[state] == 0) {   // duplicates keep the first index
+            m_bestLength[state] = static_cast<std::uint32_t>(p.size());
+            m_bestPattern[state] = static_cast<std::int32_t>(i);
+        }
+        m_maxLength = std::max(m_maxLength, p.size());
+    }
+
+    // Failure links, breadth first, folded straight into the transition table
+    std::vector<std::uint32_t> fail(m_bestLength.size(), 0);
+    std::deque<std::uint32_t> queue;
+    for (std::size_t c = 0; c < m_classCount; ++c) {
+        std::uint32_t& t = m_next[c];
+        if (t == NoState) {
+            t = 0;
+        } else {
+            queue.push_back(t);
+        }
+    }
+    while (!queue.empty()) {
+        const std::uint32_t s = queue.front();
+        queue.pop_front();
+        for (std::size_t c = 0; c < m_classCount; ++c) {
+            const std::uint32_t viaFail = m_next[fail[s] * m_classCount + c];
+            std::uint32_t& t = m_next[s * m_classCount + c];
+            if (t == NoState) {
+                t = viaFail;
+                continue;
+            }
+            fail[t] = viaFail;
+            // A pattern ending here is longer than any that ends in the
+            // failure state (a proper suffix), so only inherit when there is none.
+            if (m_bestLength[t] == 0) {
+                m_bestLength[t] = m_bestLength[viaFail];
+                m_bestPattern[t] = m_bestPattern[viaFail];
+            }
+            queue.push_back(t);
+        }
+    }
+
+    for (int b = 0; b < 256; ++b)
+        m_startByte[b] = m_next[m_classOf[b]] != 0;
+}
+
+bool MultiLiteralMatcher::find(const char* data, std::size_t len, std::size_t from, Match& out) const
+{
+    if (m_maxLength == 0)
+        return false;
+
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    std::uint32_t state = 0;
+    std::size_t bestStart = std::numeric_limits<std::size_t>::max();
+    std::size_t bestLength = 0;
+    int bestPattern = -1;
+
+    std::size_t i = from;
+    while (i < len) {
+        if (state == 0) {
+            // No partial match in flight: nothing found so far can be
+            // improved on, and bytes that start no pattern can be skipped.
+            if (bestPattern >= 0)
+                break;
+            while (i < len && !m_startByte[bytes[i]])
+                ++i;
+            if (i == len)
+                break;
+        }
+
+        state = m_next[state * m_classCount + m_classOf[bytes[i]]];
+        ++i;
+
+        const std::size_t length = m_bestLength[state];
+        if (length != 0) {
+            const std::size_t start = i - length;
+            if (start < bestStart || (start == bestStart && length > bestLength)) {
+                bestStart = start;
+                bestLength = length;
+                bestPattern = m_bestPattern[state];
+            }
+        }
+        // Any match starting earlier, or longer at the same start, would
+        // have to be longer than the longest pattern.
+        if (bestPattern >= 0 && i >= bestStart + m_maxLength)
+            break;
+    }
+
+    if (bestPattern < 0)
+        return false;
+    out = Match{bestStart, bestLength, bestPattern};
+    return true;
+}
+
+} // namespace search
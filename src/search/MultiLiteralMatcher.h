@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ByteMatcher.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace search {
+
+// Matches any of a set of fixed strings in one pass (Aho-Corasick).
+//
+// The trie is compiled into a dense DFA over byte equivalence classes: bytes
+// that occur in no pattern share one class, so the transition table stays
+// small even for hundreds of terms. find() returns the leftmost match and,
+// among matches starting at the same offset, the longest one; Match::pattern
+// is the index of that term in the constructor's list.
+//
+// Case-insensitive matching folds ASCII letters only (see LiteralMatcher).
+class MultiLiteralMatcher : public ByteMatcher {
+public:
+    MultiLiteralMatcher(const std::vector<std::string>& patterns, bool caseSensitive);
+
+    bool find(const char* data, std::size_t len, std::size_t from, Match& out) const override;
+    std::size_t maxMatchLength() const override { return m_maxLength; }
+
+    std::size_t stateCount() const { return m_bestLength.size(); }
+
+private:
+    void build(const std::vector<std::string>& patterns);
+
+    std::array<std::uint16_t, 256> m_classOf{};     // byte -> equivalence class
+    std::size_t m_classCount = 1;
+    std::vector<std::uint32_t> m_next;              // state * m_classCount + class -> state
+    std::vector<std::uint32_t> m_bestLength;        // longest pattern ending in state, 0 = none
+    std::vector<std::int32_t> m_bestPattern;        // index of that pattern
+    std::array<bool, 256> m_startByte{};            // bytes that can begin a match
+    std::size_t m_maxLength = 0;
+    bool m_caseSensitive;
+};
+
+} // namespace search
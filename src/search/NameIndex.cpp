@@ -0,0 +1,723 @@
+#include "NameIndex.h"
+#include "IndexFile.h"
+#include "LiteralMatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace search {
+
+using namespace detail;
+
+namespace {
+
+constexpr char Magic[8] = {'G', 'C', 'N', 'I', 'D', 'X', '1', '\0'};
+constexpr std::uint32_t FormatVersion = 1;
+
+// Below this many entries per thread a query is not worth splitting.
+constexpr std::size_t MinEntriesPerThread = 64 * 1024;
+constexpr std::size_t MinDirsPerThread = 1024;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t rootLength;
+    std::uint64_t dirCount;
+    std::uint64_t entryCount;
+    std::uint64_t dirPathsSize;
+    std::uint64_t namesSize;
+    std::int64_t builtAt;          // nanoseconds since the epoch
+    std::uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct DirRecord {
+    std::uint64_t pathOffset;      // into the directory paths blob
+    std::uint32_t pathLength;
+    std::uint32_t firstEntry;      // entries of a directory are contiguous
+    std::int64_t mtimeNs;
+};
+static_assert(sizeof(DirRecord) == 24);
+
+struct EntryRecord {
+    std::uint64_t size;
+    std::int64_t mtimeNs;
+    std::uint32_t dir;
+    std::uint32_t nameOffset;      // into the names blob
+    std::uint32_t mode;
+    std::uint16_t nameLength;
+    std::uint8_t type;
+    std::uint8_t reserved;
+};
+static_assert(sizeof(EntryRecord) == 32);
+
+// `path` relative to `root`; both without trailing '/'.
+std::string_view relativeTo(std::string_view root, std::string_view path)
+{
+    if (path.size() <= root.size())
+        return {};
+    path.remove_prefix(root.size());
+    if (path.front() == '/')
+        path.remove_prefix(1);
+    return path;
+}
+
+EntryType typeFromMode(mode_t mode)
+{
+    if (S_ISREG(mode)) return EntryType::File;
+    if (S_ISDIR(mode)) return EntryType::Directory;
+    if (S_ISLNK(mode)) return EntryType::Symlink;
+    return EntryType::Other;
+}
+
+std::unique_ptr<LiteralMatcher> nameMatcher(const IndexQuery& q)
+{
+    if (q.literal.empty() || q.literal.find('\0') != std::string_view::npos ||
+        !LiteralMatcher::supports(q.literal, q.caseSensitive))
+        return nullptr;
+    return std::make_unique<LiteralMatcher>(q.literal, q.caseSensitive);
+}
+
+// Entry collected during a build.
+struct RawEntry {
+    std::uint32_t localDir;        // into BuildShard::dirs
+    std::string name;
+    std::uint64_t size;
+    std::int64_t mtimeNs;
+    std::uint32_t mode;
+    EntryType type;
+    bool indexed;                  // a directory whose contents are indexed too
+};
+
+// Entries collected by the walker threads. A thread reads a whole directory
+// before moving on, so consecutive entries of a shard mostly share their
+// directory and the path is stored once per run.
+struct BuildShard {
+    std::mutex mutex;
+    std::vector<std::string> dirs;
+    std::vector<RawEntry> entries;
+};
+
+} // anonymous namespace
+
+// --- NameIndex ---------------------------------------------------------------
+
+NameIndex::~NameIndex()
+{
+    if (m_map)
+        ::munmap(m_map, m_mapSize);
+}
+
+std::shared_ptr<const NameIndex> NameIndex::open(const std::string& indexFile)
+{
+    std::shared_ptr<NameIndex> index(new NameIndex());
+    if (!index->mapFile(indexFile))
+        return nullptr;
+    return index;
+}
+
+bool NameIndex::mapFile(const std::string& indexFile)
+{
+    FdGuard fd(::open(indexFile.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0)
+        return false;
+    struct stat st;
+    if (::fstat(fd.get(), &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FileHeader))
+        return false;
+
+    m_mapSize = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, m_mapSize, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (map == MAP_FAILED)
+        return false;
+    m_map = map;
+
+    const auto* base = static_cast<const char*>(m_map);
+    const auto* header = reinterpret_cast<const FileHeader*>(base);
+    if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != FormatVersion ||
+        header->dirCount == 0 || header->dirCount > 0xFFFFFFFFu || header->entryCount > 0xFFFFFFFFu ||
+        header->namesSize > 0xFFFFFFFFu || header->dirPathsSize > m_mapSize)
+        return false;
+
+    std::size_t offset = sizeof(FileHeader);
+    const std::size_t rootOffset = offset;
+    offset = align8(offset + header->rootLength);
+    const std::size_t dirsOffset = offset;
+    offset += header->dirCount * sizeof(DirRecord);
+    const std::size_t entriesOffset = offset;
+    offset += header->entryCount * sizeof(EntryRecord);
+    const std::size_t dirPathsOffset = offset;
+    offset = align8(offset + header->dirPathsSize);
+    const std::size_t namesOffset = offset;
+    offset += header->namesSize;
+    if (offset != m_mapSize)
+        return false;
+
+    m_header = header;
+    m_root.assign(base + rootOffset, header->rootLength);
+    m_dirs = base + dirsOffset;
+    m_entries = base + entriesOffset;
+    m_dirPaths = base + dirPathsOffset;
+    m_names = base + namesOffset;
+    m_namesSize = header->namesSize;
+    return true;
+}
+
+std::int64_t NameIndex::builtAt() const
+{
+    return static_cast<const FileHeader*>(m_header)->builtAt;
+}
+
+std::size_t NameIndex::entryCount() const
+{
+    return static_cast<const FileHeader*>(m_header)->entryCount;
+}
+
+std::size_t NameIndex::dirCount() const
+{
+    return static_cast<const FileHeader*>(m_header)->dirCount;
+}
+
+std::string_view NameIndex::dirPath(std::uint32_t dir) const
+{
+    const DirRecord& d = static_cast<const DirRecord*>(m_dirs)[dir];
+    return std::string_view(m_dirPaths + d.pathOffset, d.pathLength);
+}
+
+std::int64_t NameIndex::dirMtime(std::uint32_t dir) const
+{
+    return static_cast<const DirRecord*>(m_dirs)[dir].mtimeNs;
+}
+
+std::int64_t NameIndex::findDir(std::string_view relPath) const
+{
+    std::uint32_t first;
+    std::uint32_t last;
+    subtreeRange(relPath, first, last);
+    return first < last ? static_cast<std::int64_t>(first) : -1;
+}
+
+void NameIndex::subtreeRange(std::string_view relPath, std::uint32_t& first, std::uint32_t& last) const
+{
+    const auto count = static_cast<std::uint32_t>(dirCount());
+    std::uint32_t lo = 0;
+    std::uint32_t hi = count;
+    while (lo < hi) {
+        const std::uint32_t mid = lo + (hi - lo) / 2;
+        if (pathLess(dirPath(mid), relPath))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    first = lo;
+    if (first == count || dirPath(first) != relPath) {
+        last = first;
+        return;
+    }
+    hi = count;
+    lo = first + 1;
+    while (lo < hi) {
+        const std::uint32_t mid = lo + (hi - lo) / 2;
+        if (inSubtree(dirPath(mid), relPath))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    last = lo;
+}
+
+IndexEntry NameIndex::entry(std::size_t i) const
+{
+    const EntryRecord& r = static_cast<const EntryRecord*>(m_entries)[i];
+    return IndexEntry{dirPath(r.dir), std::string_view(m_names + r.nameOffset, r.nameLength),
+                      static_cast<EntryType>(r.type), r.mode, r.size, r.mtimeNs, r.dir};
+}
+
+void NameIndex::entryRange(std::uint32_t dir, std::size_t& first, std::size_t& last) const
+{
+    const auto* dirs = static_cast<const DirRecord*>(m_dirs);
+    first = dirs[dir].firstEntry;
+    last = dir + 1 < dirCount() ? dirs[dir + 1].firstEntry : entryCount();
+}
+
+void NameIndex::query(const IndexQuery& q, const IndexVisitor& visitor) const
+{
+    std::uint32_t firstDir;
+    std::uint32_t lastDir;
+    subtreeRange(q.subtree, firstDir, lastDir);
+    if (firstDir == lastDir)
+        return;
+
+    std::size_t firstEntry;
+    std::size_t unused;
+    std::size_t lastEntry;
+    entryRange(firstDir, firstEntry, unused);
+    entryRange(lastDir - 1, unused, lastEntry);
+    if (firstEntry == lastEntry)
+        return;
+
+    const auto* entries = static_cast<const EntryRecord*>(m_entries);
+    const auto nameEnd = [this, entries](std::size_t i) {
+        return i + 1 < entryCount() ? std::size_t(entries[i + 1].nameOffset) : m_namesSize;
+    };
+
+    const std::unique_ptr<LiteralMatcher> matcher = nameMatcher(q);
+    std::atomic<bool> stop{false};
+
+    forEachSlice(lastEntry - firstEntry, resolveThreads(q.threads), MinEntriesPerThread,
+                 [&](std::size_t begin, std::size_t end) {
+        begin += firstEntry;
+        end += firstEntry;
+
+        if (!matcher) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if ((i & 1023) == 0 && stopRequested(stop, q.cancel))
+                    return;
+                if (!visitor(entry(i))) {
+                    stop.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            return;
+        }
+
+        // Search this slice of the names blob in one go. Names are separated
+        // by NULs, which the literal cannot contain, so a hit always lies
+        // inside a single name.
+        const std::size_t blobEnd = nameEnd(end - 1);
+        std::size_t pos = entries[begin].nameOffset;
+        Match m;
+        while (pos < blobEnd && !stopRequested(stop, q.cancel) && matcher->find(m_names, blobEnd, pos, m)) {
+            const EntryRecord* hit = std::upper_bound(entries + begin, entries + end, m.offset,
+                                                      [](std::size_t offset, const EntryRecord& r) {
+                                                          return offset < r.nameOffset;
+                                                      }) - 1;
+            const auto i = static_cast<std::size_t>(hit - entries);
+            if (!visitor(entry(i))) {
+                stop.store(true, std::memory_order_relaxed);
+                return;
+            }
+            pos = nameEnd(i);   // one report per name
+        }
+    });
+}
+
+std::vector<std::string> NameIndex::changedDirectories(const std::atomic<bool>* cancel) const
+{
+    FdGuard rootFd(::open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (rootFd.get() < 0)
+        return {std::string()};
+
+    std::mutex mutex;
+    std::vector<std::string> changed;
+    const std::atomic<bool> noStop{false};
+
+    forEachSlice(dirCount(), resolveThreads(0), MinDirsPerThread, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::string> local;
+        std::string path;
+        for (std::size_t d = begin; d < end; ++d) {
+            if ((d & 255) == 0 && stopRequested(noStop, cancel))
+                return;
+            const std::string_view rel = dirPath(static_cast<std::uint32_t>(d));
+            path.assign(rel.empty() ? std::string_view(".") : rel);
+            struct stat st;
+            if (::fstatat(rootFd.get(), path.c_str(), &st, rel.empty() ? 0 : AT_SYMLINK_NOFOLLOW) != 0 ||
+                !S_ISDIR(st.st_mode) || mtimeOf(st) != dirMtime(static_cast<std::uint32_t>(d)))
+                local.emplace_back(rel);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.insert(changed.end(), local.begin(), local.end());
+    });
+
+    std::sort(changed.begin(), changed.end(), pathLess);
+    return changed;
+}
+
+bool NameIndex::build(const std::string& rootPath, const std::string& indexFile, unsigned threads,
+                      const std::atomic<bool>* cancel)
+{
+    const std::string root = normalizedRoot(rootPath);
+    struct stat rootStat;
+    if (::stat(root.c_str(), &rootStat) != 0 || !S_ISDIR(rootStat.st_mode))
+        return false;
+    const auto builtAt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::system_clock::now().time_since_epoch()).count();
+
+    WalkOptions walkOptions;
+    walkOptions.threads = threads;
+    walkOptions.cancel = cancel;
+    ParallelWalker walker(walkOptions);
+
+    const unsigned shardCount = walker.threadCount() * 4;
+    std::vector<std::unique_ptr<BuildShard>> shards;
+    for (unsigned i = 0; i < shardCount; ++i)
+        shards.push_back(std::make_unique<BuildShard>());
+
+    const auto visitor = [&](const WalkEntry& e) {
+        // The name comes straight from the dirent and is NUL-terminated.
+        struct stat st;
+        if (::fstatat(e.dirFd, e.name.data(), &st, AT_SYMLINK_NOFOLLOW) != 0)
+            return VisitResult::SkipDirectory;
+        const bool indexed = S_ISDIR(st.st_mode) && st.st_dev == rootStat.st_dev;
+        const std::string_view dir = relativeTo(root, e.dirPath);
+
+        BuildShard& shard = *shards[std::hash<std::thread::id>{}(std::this_thread::get_id()) % shardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.dirs.empty() || shard.dirs.back() != dir)
+            shard.dirs.emplace_back(dir);
+        shard.entries.push_back(RawEntry{static_cast<std::uint32_t>(shard.dirs.size() - 1), std::string(e.name),
+                                         static_cast<std::uint64_t>(st.st_size), mtimeOf(st),
+                                         static_cast<std::uint32_t>(st.st_mode), typeFromMode(st.st_mode),
+                                         indexed});
+        return indexed ? VisitResult::Continue : VisitResult::SkipDirectory;
+    };
+    if (!walker.run(root, visitor) || (cancel && cancel->load()))
+        return false;
+
+    // Directory table: the root plus every directory that was descended into.
+    struct DirInfo {
+        std::string path;
+        std::int64_t mtimeNs;
+    };
+    std::vector<DirInfo> dirs;
+    dirs.push_back(DirInfo{std::string(), mtimeOf(rootStat)});
+    for (const auto& shard : shards)
+        for (const RawEntry& e : shard->entries)
+            if (e.indexed)
+                dirs.push_back(DirInfo{joinPath(shard->dirs[e.localDir], e.name), e.mtimeNs});
+    std::sort(dirs.begin(), dirs.end(), [](const DirInfo& a, const DirInfo& b) { return pathLess(a.path, b.path); });
+    if (dirs.size() > 0xFFFFFFFFu)
+        return false;
+
+    std::unordered_map<std::string_view, std::uint32_t> dirIndex;
+    dirIndex.reserve(dirs.size());
+    for (std::size_t i = 0; i < dirs.size(); ++i)
+        dirIndex.emplace(dirs[i].path, static_cast<std::uint32_t>(i));
+
+    // Entries grouped by directory, sorted by name within it.
+    struct Flat {
+        std::uint32_t dir;
+        const RawEntry* raw;
+    };
+    std::vector<Flat> flat;
+    for (const auto& shard : shards) {
+        std::vector<std::int64_t> localToGlobal(shard->dirs.size(), -1);
+        for (std::size_t d = 0; d < shard->dirs.size(); ++d)
+            if (auto it = dirIndex.find(shard->dirs[d]); it != dirIndex.end())
+                localToGlobal[d] = it->second;
+        for (const RawEntry& e : shard->entries)
+            if (localToGlobal[e.localDir] >= 0)
+                flat.push_back(Flat{static_cast<std::uint32_t>(localToGlobal[e.localDir]), &e});
+    }
+    std::sort(flat.begin(), flat.end(), [](const Flat& a, const Flat& b) {
+        return a.dir != b.dir ? a.dir < b.dir : a.raw->name < b.raw->name;
+    });
+    if (flat.size() > 0xFFFFFFFFu)
+        return false;
+
+    std::vector<DirRecord> dirRecords(dirs.size());
+    std::uint64_t dirPathsSize = 0;
+    for (std::size_t i = 0; i < dirs.size(); ++i) {
+        dirRecords[i] = DirRecord{dirPathsSize, static_cast<std::uint32_t>(dirs[i].path.size()), 0, dirs[i].mtimeNs};
+        dirPathsSize += dirs[i].path.size();
+    }
+    std::vector<EntryRecord> entryRecords(flat.size());
+    std::uint64_t namesSize = 0;
+    for (std::size_t d = 0, next = 0; d < dirs.size(); ++d) {
+        while (next < flat.size() && flat[next].dir < d)
+            ++next;
+        dirRecords[d].firstEntry = static_cast<std::uint32_t>(next);
+    }
+    for (std::size_t i = 0; i < flat.size(); ++i) {
+        const RawEntry& e = *flat[i].raw;
+        entryRecords[i] = EntryRecord{e.size, e.mtimeNs, flat[i].dir, static_cast<std::uint32_t>(namesSize),
+                                      e.mode, static_cast<std::uint16_t>(e.name.size()),
+                                      static_cast<std::uint8_t>(e.type), 0};
+        namesSize += e.name.size() + 1;
+        if (namesSize > 0xFFFFFFFFu)
+            return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.rootLength = static_cast<std::uint32_t>(root.size());
+    header.dirCount = dirs.size();
+    header.entryCount = flat.size();
+    header.dirPathsSize = dirPathsSize;
+    header.namesSize = namesSize;
+    header.builtAt = builtAt;
+
+    // Write next to the target and rename over it: readers that still map the
+    // old file keep seeing consistent data.
+    std::string tmpPath = indexFile + ".XXXXXX";
+    FdGuard fd(::mkstemp(tmpPath.data()));
+    if (fd.get() < 0)
+        return false;
+
+    FileWriter out(fd.get());
+    out.write(&header, sizeof(header));
+    out.write(root.data(), root.size());
+    out.padTo8();
+    out.write(dirRecords.data(), dirRecords.size() * sizeof(DirRecord));
+    out.write(entryRecords.data(), entryRecords.size() * sizeof(EntryRecord));
+    for (const DirInfo& d : dirs)
+        out.write(d.path.data(), d.path.size());
+    out.padTo8();
+    for (const Flat& f : flat)
+        out.write(f.raw->name.c_str(), f.raw->name.size() + 1);
+
+    if (!out.flush() || (cancel && cancel->load()) || ::rename(tmpPath.c_str(), indexFile.c_str()) != 0) {
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// --- LiveNameIndex -----------------------------------------------------------
+
+LiveNameIndex::LiveNameIndex(std::shared_ptr<const NameIndex> base)
+    : m_root(base->root())
+    , m_base(std::move(base))
+    , m_baseDirOverridden(m_base->dirCount(), false)
+{
+    struct stat st;
+    if (::stat(m_root.c_str(), &st) == 0)
+        m_rootDevice = st.st_dev;
+}
+
+std::shared_ptr<const NameIndex> LiveNameIndex::base() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_base;
+}
+
+void LiveNameIndex::reset(std::shared_ptr<const NameIndex> base)
+{
+    std::lock_guard<std::mutex> update(m_updateMutex);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_base = std::move(base);
+    m_baseDirOverridden.assign(m_base->dirCount(), false);
+    m_overrides.clear();
+}
+
+std::size_t LiveNameIndex::overrideCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_overrides.size();
+}
+
+std::vector<std::string> LiveNameIndex::directories() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<std::string> result;
+    result.reserve(m_base->dirCount() + m_overrides.size());
+    for (std::uint32_t d = 0; d < m_base->dirCount(); ++d)
+        if (!m_baseDirOverridden[d])
+            result.emplace_back(m_base->dirPath(d));
+    for (const auto& entry : m_overrides)
+        result.push_back(entry.first);   // replaced base directories are flagged above
+    return result;
+}
+
+bool LiveNameIndex::hasDirectory(const std::string& relPath) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return knownLocked(relPath);
+}
+
+bool LiveNameIndex::readListing(const std::string& relPath, Listing& listing) const
+{
+    const std::string path = relPath.empty() ? m_root : joinPath(m_root == "/" ? "" : m_root, relPath);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | (relPath.empty() ? 0 : O_NOFOLLOW));
+    if (fd < 0)
+        return errno != ENOENT && errno != ENOTDIR && errno != ELOOP;   // unreadable, but still there
+    DIR* dir = ::fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        return true;
+    }
+    while (const dirent* de = ::readdir(dir)) {
+        const char* name = de->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+        struct stat st;
+        if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+        listing.push_back(OwnedEntry{name, typeFromMode(st.st_mode), static_cast<std::uint32_t>(st.st_mode),
+                                     static_cast<std::uint64_t>(st.st_size), mtimeOf(st),
+                                     S_ISDIR(st.st_mode) && st.st_dev == m_rootDevice});
+    }
+    ::closedir(dir);
+    return true;
+}
+
+bool LiveNameIndex::knownLocked(const std::string& relPath) const
+{
+    if (m_overrides.count(relPath))
+        return true;
+    const std::int64_t d = m_base->findDir(relPath);
+    return d >= 0 && !m_baseDirOverridden[static_cast<std::size_t>(d)];
+}
+
+std::vector<std::string> LiveNameIndex::childDirectoriesLocked(const std::string& relPath) const
+{
+    std::vector<std::string> children;
+    if (auto it = m_overrides.find(relPath); it != m_overrides.end()) {
+        for (const OwnedEntry& e : it->second)
+            if (e.indexed)
+                children.push_back(joinPath(relPath, e.name));
+        return children;
+    }
+    const std::int64_t d = m_base->findDir(relPath);
+    if (d < 0 || m_baseDirOverridden[static_cast<std::size_t>(d)])
+        return children;
+    std::size_t first;
+    std::size_t last;
+    m_base->entryRange(static_cast<std::uint32_t>(d), first, last);
+    for (std::size_t i = first; i < last; ++i) {
+        const IndexEntry e = m_base->entry(i);
+        if (e.type == EntryType::Directory) {
+            std::string child = joinPath(relPath, e.name);
+            if (m_base->findDir(child) >= 0)
+                children.push_back(std::move(child));
+        }
+    }
+    return children;
+}
+
+void LiveNameIndex::removeLocked(const std::string& relPath)
+{
+    std::uint32_t first;
+    std::uint32_t last;
+    m_base->subtreeRange(relPath, first, last);
+    for (std::uint32_t d = first; d < last; ++d)
+        m_baseDirOverridden[d] = true;
+    for (auto it = m_overrides.begin(); it != m_overrides.end();) {
+        if (inSubtree(it->first, relPath))
+            it = m_overrides.erase(it);
+        else
+            ++it;
+    }
+}
+
+std::vector<std::string> LiveNameIndex::refreshDirectory(const std::string& relPath)
+{
+    std::lock_guard<std::mutex> update(m_updateMutex);
+
+    // Only this thread modifies the state, so it can be read without m_mutex;
+    // the disk is read before taking m_mutex for the swap.
+    std::vector<std::pair<std::string, Listing>> listings;
+    std::vector<std::string> removed;
+    std::vector<std::string> pending{relPath};
+    while (!pending.empty()) {
+        std::string dir = std::move(pending.back());
+        pending.pop_back();
+        Listing listing;
+        if (!readListing(dir, listing)) {
+            removed.push_back(std::move(dir));
+            continue;
+        }
+        for (const OwnedEntry& e : listing) {
+            if (e.indexed) {
+                std::string child = joinPath(dir, e.name);
+                if (!knownLocked(child))
+                    pending.push_back(std::move(child));
+            }
+        }
+        listings.emplace_back(std::move(dir), std::move(listing));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const std::string& dir : removed)
+        removeLocked(dir);
+    for (auto& [dir, listing] : listings) {
+        // Subdirectories gone from the listing take their subtrees with them
+        for (const std::string& child : childDirectoriesLocked(dir)) {
+            const std::string_view name = std::string_view(child).substr(dir.empty() ? 0 : dir.size() + 1);
+            const bool stillThere = std::any_of(listing.begin(), listing.end(), [name](const OwnedEntry& e) {
+                return e.indexed && e.name == name;
+            });
+            if (!stillThere)
+                removeLocked(child);
+        }
+        if (const std::int64_t d = m_base->findDir(dir); d >= 0)
+            m_baseDirOverridden[static_cast<std::size_t>(d)] = true;
+        m_overrides[dir] = std::move(listing);
+    }
+
+    std::vector<std::string> read;
+    read.reserve(listings.size());
+    for (auto& entry : listings)
+        read.push_back(std::move(entry.first));
+    return read;
+}
+
+// The visitor may take long - it stats and reads files, and a paused search
+// parks in it - so it never runs under m_mutex: the query takes a snapshot
+// (the base is immutable and shared, the matching override entries are
+// copied) and visits that after unlocking.
+void LiveNameIndex::query(const IndexQuery& q, const IndexVisitor& visitor) const
+{
+    struct OverrideHit {
+        std::size_t dir;    // in overrideDirs
+        OwnedEntry entry;
+    };
+    std::shared_ptr<const NameIndex> base;
+    std::vector<bool> baseDirOverridden;
+    std::vector<std::string> overrideDirs;
+    std::vector<OverrideHit> overrideHits;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        base = m_base;
+        baseDirOverridden = m_baseDirOverridden;
+
+        const std::unique_ptr<LiteralMatcher> matcher = nameMatcher(q);
+        for (const auto& [dir, listing] : m_overrides) {
+            if (!inSubtree(dir, q.subtree))
+                continue;
+            if (q.cancel && q.cancel->load(std::memory_order_relaxed))
+                return;
+            for (const OwnedEntry& e : listing) {
+                Match m;
+                if (matcher && !matcher->find(e.name.data(), e.name.size(), 0, m))
+                    continue;
+                if (overrideDirs.empty() || overrideDirs.back() != dir)
+                    overrideDirs.push_back(dir);
+                overrideHits.push_back({overrideDirs.size() - 1, e});
+            }
+        }
+    }
+
+    std::atomic<bool> stopped{false};
+    base->query(q, [&](const IndexEntry& e) {
+        if (baseDirOverridden[e.dirIndex])
+            return true;
+        if (!visitor(e)) {
+            stopped.store(true, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    });
+    if (stopped.load())
+        return;
+
+    for (const OverrideHit& hit : overrideHits) {
+        if (q.cancel && q.cancel->load(std::memory_order_relaxed))
+            return;
+        const OwnedEntry& e = hit.entry;
+        if (!visitor(IndexEntry{overrideDirs[hit.dir], e.name, e.type, e.mode, e.size, e.mtimeNs, NoDirIndex}))
+            return;
+    }
+}
+
+} // namespace search
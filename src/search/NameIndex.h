@@ -0,0 +1,173 @@
+#pragma once
+
+#include "ParallelWalker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace search {
+
+// One entry of a filename index. Paths are relative to the index root
+// ("" is the root itself); views stay valid while the index is alive.
+struct IndexEntry {
+    std::string_view dirPath;
+    std::string_view name;
+    EntryType type;
+    std::uint32_t mode;        // st_mode
+    std::uint64_t size;
+    std::int64_t mtimeNs;
+    std::uint32_t dirIndex;    // NameIndex directory of the entry, NoDirIndex if it came from elsewhere
+};
+
+inline constexpr std::uint32_t NoDirIndex = 0xFFFFFFFFu;
+
+// Visitor for index queries. May be called concurrently from several
+// threads; return false to stop the query.
+using IndexVisitor = std::function<bool(const IndexEntry&)>;
+
+struct IndexQuery {
+    std::string_view subtree;              // relative directory to restrict to, "" = whole index
+    std::string_view literal;              // prefilter: only names containing this, "" = all names
+    bool caseSensitive = true;             // for `literal`, see LiteralMatcher::supports()
+    unsigned threads = 0;                  // 0 = hardware concurrency
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+// Immutable, memory-mapped filename index of one directory tree.
+//
+// File layout: header, root path, directory table, entry table, a blob of
+// directory paths and a blob of NUL-terminated names in entry order.
+// Directories are sorted by relative path with '/' ordered before every
+// other byte, so any subtree is a contiguous run of directories; entries are
+// grouped by directory in the same order, so a subtree is also a contiguous
+// run of entries and of the names blob. A query scans that slice of the
+// blob - split between threads - with LiteralMatcher and maps each hit back
+// to its entry by binary search on the name offset: tens of millions of
+// names are a few hundred MB scanned at memory speed.
+//
+// Index files are written to a temporary file and renamed into place, never
+// modified, so a mapping cannot be truncated underneath its readers.
+class NameIndex {
+public:
+    ~NameIndex();
+    NameIndex(const NameIndex&) = delete;
+    NameIndex& operator=(const NameIndex&) = delete;
+
+    // Map an index file. Returns null if it is missing or malformed.
+    static std::shared_ptr<const NameIndex> open(const std::string& indexFile);
+
+    // Walk `root` and write its index to `indexFile`. Stays on the root's
+    // filesystem. Returns false on failure or cancellation.
+    static bool build(const std::string& root, const std::string& indexFile, unsigned threads = 0,
+                      const std::atomic<bool>* cancel = nullptr);
+
+    const std::string& root() const { return m_root; }
+    std::int64_t builtAt() const;
+    std::size_t entryCount() const;
+    std::size_t dirCount() const;
+
+    std::string_view dirPath(std::uint32_t dir) const;
+    std::int64_t dirMtime(std::uint32_t dir) const;
+    // Index of a directory by relative path, or -1.
+    std::int64_t findDir(std::string_view relPath) const;
+    // Directories [first, last) forming the subtree of `relPath` (itself included).
+    void subtreeRange(std::string_view relPath, std::uint32_t& first, std::uint32_t& last) const;
+
+    IndexEntry entry(std::size_t i) const;
+    // Entries [first, last) listed directly in directory `dir`.
+    void entryRange(std::uint32_t dir, std::size_t& first, std::size_t& last) const;
+
+    // Visit entries matching the query. Directories are reported as entries
+    // of their parent directory, like in a listing; the root itself is not
+    // reported. A literal that LiteralMatcher::supports() rejects does not
+    // filter - callers always apply their full name pattern afterwards.
+    void query(const IndexQuery& q, const IndexVisitor& visitor) const;
+
+    // Relative paths of directories whose mtime changed, or that vanished,
+    // since the index was built - i.e. whose listing is out of date.
+    std::vector<std::string> changedDirectories(const std::atomic<bool>* cancel = nullptr) const;
+
+private:
+    NameIndex() = default;
+    bool mapFile(const std::string& indexFile);
+
+    void* m_map = nullptr;
+    std::size_t m_mapSize = 0;
+    std::string m_root;
+    const void* m_header = nullptr;
+    const void* m_dirs = nullptr;
+    const void* m_entries = nullptr;
+    const char* m_dirPaths = nullptr;
+    const char* m_names = nullptr;
+    std::size_t m_namesSize = 0;
+};
+
+// A NameIndex plus the changes seen since it was built.
+//
+// Directories known to have changed are re-listed from disk and their
+// current listing replaces whatever the base index recorded for them; new
+// subtrees are scanned completely. Queries merge both. Safe to query from
+// several threads while another thread applies updates.
+class LiveNameIndex {
+public:
+    explicit LiveNameIndex(std::shared_ptr<const NameIndex> base);
+
+    const std::string& root() const { return m_root; }
+    std::shared_ptr<const NameIndex> base() const;
+
+    // Re-read one directory (relative path). Subdirectories the index has
+    // never seen are read completely; a directory that no longer exists drops
+    // out together with its whole subtree. Updates are serialized; queries
+    // only wait while the new listings are swapped in, and updates only
+    // while running queries take their snapshot. Returns the relative paths
+    // of the directories that were read.
+    std::vector<std::string> refreshDirectory(const std::string& relPath);
+
+    // Replace the base, e.g. after a rebuild; clears all overrides.
+    void reset(std::shared_ptr<const NameIndex> base);
+
+    // Number of directories currently overriding the base.
+    std::size_t overrideCount() const;
+
+    // Relative paths of all directories the index knows about.
+    std::vector<std::string> directories() const;
+    bool hasDirectory(const std::string& relPath) const;
+
+    // The visitor runs on a snapshot taken when the query starts, without
+    // holding any lock: updates made meanwhile are not seen.
+    void query(const IndexQuery& q, const IndexVisitor& visitor) const;
+
+private:
+    struct OwnedEntry {
+        std::string name;
+        EntryType type;
+        std::uint32_t mode;
+        std::uint64_t size;
+        std::int64_t mtimeNs;
+        bool indexed;    // a directory on the root's filesystem, listed in the index too
+    };
+    using Listing = std::vector<OwnedEntry>;
+
+    bool readListing(const std::string& relPath, Listing& listing) const;
+    bool knownLocked(const std::string& relPath) const;
+    void removeLocked(const std::string& relPath);
+    std::vector<std::string> childDirectoriesLocked(const std::string& relPath) const;
+
+    std::string m_root;
+    std::uint64_t m_rootDevice = 0;
+    std::mutex m_updateMutex;                              // serializes writers
+    mutable std::shared_mutex m_mutex;                     // guards the state below
+    std::shared_ptr<const NameIndex> m_base;
+    std::vector<bool> m_baseDirOverridden;                 // by base directory index
+    std::unordered_map<std::string, Listing> m_overrides;  // by relative directory path
+};
+
+} // namespace search
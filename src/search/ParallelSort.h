@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace search {
+
+// Sort [first, last) with up to `threads` threads (0 = one per core): the
+// range is cut into slices that are sorted concurrently and then merged
+// pairwise, each round of merges running concurrently too. Ranges too
+// small to be worth a thread are sorted with std::sort. Not stable.
+template<typename RandomIt, typename Compare>
+void parallelSort(RandomIt first, RandomIt last, Compare comp, unsigned threads = 0)
+{
+    constexpr std::size_t MinSlice = 32 * 1024;
+
+    const auto count = static_cast<std::size_t>(std::distance(first, last));
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t slices = std::min<std::size_t>(threads, count / MinSlice);
+    if (slices <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<RandomIt> bounds;
+    bounds.reserve(slices + 1);
+    for (std::size_t s = 0; s <= slices; ++s)
+        bounds.push_back(first + static_cast<std::ptrdiff_t>(count * s / slices));
+
+    auto runAll = [](std::vector<std::thread>& workers) {
+        for (std::thread& t : workers)
+            t.join();
+        workers.clear();
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t s = 0; s < slices; ++s)
+        workers.emplace_back([&bounds, &comp, s]() { std::sort(bounds[s], bounds[s + 1], comp); });
+    runAll(workers);
+
+    for (std::size_t width = 1; width < slices; width *= 2) {
+        for (std::size_t s = 0; s + width < slices; s += 2 * width) {
+            const std::size_t end = std::min(s + 2 * width, slices);
+            workers.emplace_back([&bounds, &comp, s, width, end]() {
+                std::inplace_merge(bounds[s], bounds[s + width], bounds[end], comp);
+            });
+        }
+        runAll(workers);
+    }
+}
+
+} // namespace search
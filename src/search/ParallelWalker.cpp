@@ -0,0 +1,388 @@
+#include "ParallelWalker.h"
+#include "IgnoreRules.h"
+#include "ThreadControl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <climits>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace search {
+
+std::string WalkEntry::path() const
+{
+    std::string result;
+    result.reserve(dirPath.size() + 1 + name.size());
+    result.append(dirPath);
+    if (result.empty() || result.back() != '/')
+        result.push_back('/');
+    result.append(name);
+    return result;
+}
+
+namespace {
+
+struct DirItem {
+    std::string path;
+    bool isRoot = false;
+    std::shared_ptr<const IgnoreScope> ignore;   // rules in effect, null if none
+};
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<DirItem> items;
+};
+
+EntryType typeFromDirent(unsigned char dtype)
+{
+    switch (dtype) {
+        case DT_REG: return EntryType::File;
+        case DT_DIR: return EntryType::Directory;
+        case DT_LNK: return EntryType::Symlink;
+        default: return EntryType::Other;
+    }
+}
+
+EntryType typeFromMode(mode_t mode)
+{
+    if (S_ISREG(mode)) return EntryType::File;
+    if (S_ISDIR(mode)) return EntryType::Directory;
+    if (S_ISLNK(mode)) return EntryType::Symlink;
+    return EntryType::Other;
+}
+
+// The scope for a directory: `parent` extended by the directory's own
+// ignore files, if it has any. .ignore comes last so it wins over .gitignore.
+std::shared_ptr<const IgnoreScope> loadIgnoreFiles(int dirFd, const std::string& dirPath,
+                                                   std::shared_ptr<const IgnoreScope> parent)
+{
+    IgnoreRules rules;
+    rules.load(dirFd, ".gitignore");
+    rules.load(dirFd, ".ignore");
+    if (rules.empty())
+        return parent;
+    auto scope = std::make_shared<IgnoreScope>();
+    scope->dirPath = dirPath;
+    scope->rules = std::move(rules);
+    scope->parent = std::move(parent);
+    return scope;
+}
+
+// Ignore files above the root, when the root lies inside a git work tree:
+// those of every directory from the top of the work tree (the one holding
+// .git) down to the root's parent. Their paths are relative to where they
+// were read, so each scope records the way from there to the root.
+std::shared_ptr<const IgnoreScope> loadParentIgnoreFiles(const std::string& root)
+{
+    char resolved[PATH_MAX];
+    if (!::realpath(root.c_str(), resolved))
+        return nullptr;
+    const std::string real(resolved);
+
+    std::vector<std::string> ancestors;   // nearest first
+    std::string dir = real;
+    bool inWorkTree = ::faccessat(AT_FDCWD, (dir + "/.git").c_str(), F_OK, 0) == 0;
+    while (!inWorkTree && dir.size() > 1) {
+        const std::size_t slash = dir.rfind('/');
+        dir = slash == 0 ? std::string("/") : dir.substr(0, slash);
+        ancestors.push_back(dir);
+        const std::string gitDir = dir.size() > 1 ? dir + "/.git" : std::string("/.git");
+        inWorkTree = ::faccessat(AT_FDCWD, gitDir.c_str(), F_OK, 0) == 0;
+    }
+    if (!inWorkTree)
+        return nullptr;
+
+    std::shared_ptr<const IgnoreScope> scope;
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+        const int fd = ::open(it->c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+        IgnoreRules rules;
+        rules.load(fd, ".gitignore");
+        rules.load(fd, ".ignore");
+        ::close(fd);
+        if (rules.empty())
+            continue;
+        auto next = std::make_shared<IgnoreScope>();
+        next->dirPath = root;
+        next->prefix = real.substr(it->size() > 1 ? it->size() + 1 : 1);
+        next->rules = std::move(rules);
+        next->parent = std::move(scope);
+        scope = std::move(next);
+    }
+    return scope;
+}
+
+} // anonymous namespace
+
+bool statEntry(const WalkEntry& entry, unsigned fields, EntryStat& out)
+{
+    const std::string name(entry.name);
+#ifdef STATX_BASIC_STATS
+    unsigned mask = 0;
+    if (fields & (StatType | StatMode))
+        mask |= STATX_TYPE | STATX_MODE;
+    if (fields & StatSize)
+        mask |= STATX_SIZE;
+    if (fields & StatMtime)
+        mask |= STATX_MTIME;
+    if (fields & StatIdentity)
+        mask |= STATX_INO;
+
+    struct statx stx;
+    if (::statx(entry.dirFd, name.c_str(), AT_NO_AUTOMOUNT, mask, &stx) == 0) {
+        out.type = typeFromMode(stx.stx_mode);
+        out.mode = stx.stx_mode;
+        out.size = stx.stx_size;
+        out.mtimeNs = static_cast<std::int64_t>(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+        out.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+        out.inode = stx.stx_ino;
+        return true;
+    }
+    if (errno != ENOSYS)
+        return false;
+#endif
+    (void)fields;
+    struct stat st;
+    if (::fstatat(entry.dirFd, name.c_str(), &st, 0) != 0)
+        return false;
+    out.type = typeFromMode(st.st_mode);
+    out.mode = st.st_mode;
+    out.size = static_cast<std::uint64_t>(st.st_size);
+    out.mtimeNs = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    out.device = st.st_dev;
+    out.inode = st.st_ino;
+    return true;
+}
+
+namespace {
+
+class WalkState {
+public:
+    WalkState(unsigned threads, const WalkVisitor& visitor, const WalkOptions& options, dev_t rootDevice)
+        : m_visitor(visitor)
+        , m_cancel(options.cancel)
+        , m_pause(options.pause)
+        , m_oneFileSystem(options.oneFileSystem)
+        , m_ignoreFiles(options.ignoreFiles)
+        , m_rootDevice(rootDevice)
+    {
+        m_queues.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i)
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    void push(unsigned self, DirItem item)
+    {
+        // Count the item before it becomes visible, so "pending == 0" can
+        // only be observed once every directory has really been processed.
+        m_pending.fetch_add(1, std::memory_order_acq_rel);
+        {
+            std::lock_guard<std::mutex> lock(m_queues[self]->mutex);
+            m_queues[self]->items.push_back(std::move(item));
+        }
+        if (m_sleeping.load(std::memory_order_acquire) > 0)
+            m_idleCv.notify_one();
+    }
+
+    void workerLoop(unsigned self)
+    {
+        DirItem item;
+        while (!cancelled()) {
+            waitWhilePaused();
+            if (pop(self, item)) {
+                readDirectory(self, item);
+                if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    // That was the last directory: release everyone waiting.
+                    std::lock_guard<std::mutex> lock(m_idleMutex);
+                    m_idleCv.notify_all();
+                    return;
+                }
+                continue;
+            }
+            if (m_pending.load(std::memory_order_acquire) == 0)
+                return;
+
+            // Nothing to steal right now, but other workers are still reading
+            // directories that may produce more work. Sleep briefly; push()
+            // wakes us up early.
+            std::unique_lock<std::mutex> lock(m_idleMutex);
+            m_sleeping.fetch_add(1, std::memory_order_acq_rel);
+            m_idleCv.wait_for(lock, std::chrono::milliseconds(2));
+            m_sleeping.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+private:
+    bool cancelled() const
+    {
+        return m_cancel && m_cancel->load(std::memory_order_relaxed);
+    }
+
+    // Parked workers keep their queues, so the walk resumes where it stopped
+    void waitWhilePaused() const
+    {
+        if (m_pause)
+            m_pause->wait();
+    }
+
+    bool pop(unsigned self, DirItem& out)
+    {
+        {
+            WorkerQueue& own = *m_queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty()) {
+                out = std::move(own.items.back());
+                own.items.pop_back();
+                return true;
+            }
+        }
+        const unsigned n = static_cast<unsigned>(m_queues.size());
+        for (unsigned i = 1; i < n; ++i) {
+            WorkerQueue& victim = *m_queues[(self + i) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                out = std::move(victim.items.front());
+                victim.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void readDirectory(unsigned self, const DirItem& item)
+    {
+        // The root may legitimately be a symlink to a directory; anything
+        // below it is only entered when readdir reported a real directory.
+        int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+        if (!item.isRoot)
+            flags |= O_NOFOLLOW;
+
+        const int fd = ::open(item.path.c_str(), flags);
+        if (fd < 0)
+            return;
+        if (m_oneFileSystem) {
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_dev != m_rootDevice) {
+                ::close(fd);
+                return;
+            }
+        }
+
+        std::shared_ptr<const IgnoreScope> ignore = item.ignore;
+        if (m_ignoreFiles)
+            ignore = loadIgnoreFiles(fd, item.path, std::move(ignore));
+
+        DIR* dir = ::fdopendir(fd);
+        if (!dir) {
+            ::close(fd);
+            return;
+        }
+
+        for (;;) {
+            waitWhilePaused();
+            if (cancelled())
+                break;
+            const dirent* de = ::readdir(dir);
+            if (!de)
+                break;
+
+            const char* name = de->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                continue;
+
+            EntryType type;
+            if (de->d_type != DT_UNKNOWN) {
+                type = typeFromDirent(de->d_type);
+            } else {
+                struct stat st;
+                if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                    continue;
+                type = typeFromMode(st.st_mode);
+            }
+
+            if (m_ignoreFiles) {
+                const bool isDir = type == EntryType::Directory;
+                if (isDir && std::strcmp(name, ".git") == 0)
+                    continue;
+                if (ignore && ignore->ignores(item.path, name, isDir))
+                    continue;
+            }
+
+            const WalkEntry entry{fd, item.path, name, type};
+            const VisitResult result = m_visitor(entry);
+
+            if (type == EntryType::Directory && result == VisitResult::Continue)
+                push(self, DirItem{entry.path(), false, ignore});
+        }
+
+        ::closedir(dir);
+    }
+
+    const WalkVisitor& m_visitor;
+    const std::atomic<bool>* m_cancel;
+    const PauseGate* m_pause;
+    const bool m_oneFileSystem;
+    const bool m_ignoreFiles;
+    const dev_t m_rootDevice;
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::atomic<std::size_t> m_pending{0};   // queued + being read
+    std::atomic<unsigned> m_sleeping{0};
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCv;
+};
+
+} // anonymous namespace
+
+ParallelWalker::ParallelWalker(WalkOptions options)
+    : m_options(options)
+{
+    m_threads = m_options.threads;
+    if (m_threads == 0)
+        m_threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool ParallelWalker::run(const std::string& rootPath, const WalkVisitor& visitor)
+{
+    std::string root = rootPath;
+    while (root.size() > 1 && root.back() == '/')
+        root.pop_back();
+
+    struct stat st;
+    if (::stat(root.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+
+    WalkState state(m_threads, visitor, m_options, st.st_dev);
+    DirItem rootItem{root, true, nullptr};
+    if (m_options.ignoreFiles)
+        rootItem.ignore = loadParentIgnoreFiles(root);
+    state.push(0, std::move(rootItem));
+
+    std::vector<std::thread> helpers;
+    helpers.reserve(m_threads - 1);
+    for (unsigned i = 1; i < m_threads; ++i)
+        helpers.emplace_back([&state, i]() { state.workerLoop(i); });
+
+    // The calling thread is worker 0.
+    state.workerLoop(0);
+
+    for (std::thread& t : helpers)
+        t.join();
+    return true;
+}
+
+} // namespace search
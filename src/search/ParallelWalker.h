@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace search {
+
+class PauseGate;
+
+// Type of a directory entry. Taken from readdir()'s d_type; the walker falls
+// back to fstatat() only on filesystems that report DT_UNKNOWN.
+enum class EntryType : std::uint8_t {
+    File,
+    Directory,
+    Symlink,
+    Other      // devices, fifos, sockets
+};
+
+// One entry produced by ParallelWalker.
+// Valid only for the duration of the visitor call.
+struct WalkEntry {
+    int dirFd;                     // open descriptor of the containing directory
+    const std::string& dirPath;    // path of the containing directory, no trailing '/'
+    std::string_view name;         // entry name (raw bytes from readdir)
+    EntryType type;
+
+    // Full path of the entry (dirPath + '/' + name).
+    std::string path() const;
+};
+
+// Fields statEntry() is asked for; others may be left unset.
+enum StatField : unsigned {
+    StatType = 1,
+    StatMode = 2,     // permission bits
+    StatSize = 4,
+    StatMtime = 8,
+    StatIdentity = 16   // device and inode
+};
+
+struct EntryStat {
+    EntryType type = EntryType::Other;
+    std::uint32_t mode = 0;       // st_mode: type and permission bits
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    std::uint64_t device = 0;     // st_dev
+    std::uint64_t inode = 0;
+};
+
+// Stat an entry relative to its directory descriptor, following symlinks.
+// Uses statx() where available and requests only `fields` (a StatField
+// mask), which spares filesystems that compute the rest - network ones in
+// particular - from doing so. Returns false if the entry is gone or is a
+// dangling link.
+bool statEntry(const WalkEntry& entry, unsigned fields, EntryStat& out);
+
+enum class VisitResult {
+    Continue,       // keep going (descend if the entry is a directory)
+    SkipDirectory   // do not descend into this directory
+};
+
+// Called concurrently from all worker threads.
+using WalkVisitor = std::function<VisitResult(const WalkEntry&)>;
+
+struct WalkOptions {
+    unsigned threads = 0;                          // 0 = hardware concurrency
+    const std::atomic<bool>* cancel = nullptr;     // polled between entries
+    const PauseGate* pause = nullptr;              // waited on between entries and directories
+
+    // Do not descend into directories on another filesystem than the root's.
+    // Mount points are still reported, like find -xdev.
+    bool oneFileSystem = false;
+
+    // Skip what .gitignore and .ignore files exclude, and .git directories.
+    // Ignore files are read in every directory as it is walked, and above
+    // the root up to the top of the enclosing git work tree.
+    bool ignoreFiles = false;
+};
+
+// Multi-threaded directory tree walker.
+//
+// Each worker owns a deque of pending directories. A worker pushes the
+// subdirectories it discovers to the back of its own deque and pops from the
+// back (depth-first, keeps the dentry/inode caches warm); idle workers steal
+// from the front of other workers' deques, which hands them the oldest - and
+// usually largest - unexplored subtrees. Directories are opened with
+// O_DIRECTORY | O_NOFOLLOW and read through fdopendir(), and the open
+// descriptor is passed to the visitor so per-entry calls can be made with
+// *at() syscalls relative to it.
+//
+// Entries are reported in no particular order. Symbolic links are reported
+// but never followed. The root itself is not reported. Entries pruned by
+// the options (ignored ones, what lies on other filesystems) are neither
+// reported nor entered.
+class ParallelWalker {
+public:
+    explicit ParallelWalker(WalkOptions options = {});
+
+    // Walk the tree below rootPath, blocking until every directory has been
+    // read or the walk was cancelled. Returns false if rootPath can't be opened.
+    bool run(const std::string& rootPath, const WalkVisitor& visitor);
+
+    // Number of worker threads run() will use.
+    unsigned threadCount() const { return m_threads; }
+
+private:
+    WalkOptions m_options;
+    unsigned m_threads;
+};
+
+} // namespace search
@@ -0,0 +1,433 @@
+#include "RegexLiterals.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace search {
+
+namespace {
+
+using Literals = std::vector<std::string>;   // alternatives, empty = no requirement
+
+std::size_t shortest(const Literals& set)
+{
+    std::size_t result = std::numeric_limits<std::size_t>::max();
+    for (const std::string& s : set)
+        result = std::min(result, s.size());
+    return result;
+}
+
+// Prefer the set whose weakest alternative is longest, then the smaller set.
+bool better(const Literals& candidate, const Literals& current)
+{
+    if (candidate.empty())
+        return false;
+    if (current.empty())
+        return true;
+    const std::size_t a = shortest(candidate);
+    const std::size_t b = shortest(current);
+    if (a != b)
+        return a > b;
+    return candidate.size() < current.size();
+}
+
+bool isHex(char c)
+{
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+unsigned hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return static_cast<unsigned>(c - '0');
+    return static_cast<unsigned>(std::tolower(static_cast<unsigned char>(c)) - 'a' + 10);
+}
+
+std::size_t utf8Length(unsigned char lead)
+{
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+struct Atom {
+    enum Kind { Literal, Group, Other, Nothing } kind = Other;
+    std::string prefix;   // \Q..\E: literal text preceding the quantifiable last character
+    std::string text;     // Literal: one (UTF-8) character
+    Literals group;       // Group: what the group requires
+};
+
+struct Quantifier {
+    bool present = false;
+    unsigned min = 1;
+};
+
+class Parser {
+public:
+    explicit Parser(std::string_view pattern) : m_p(pattern) {}
+
+    Literals parse()
+    {
+        Literals result = parseAlternation();
+        if (m_failed || m_i != m_p.size())
+            return {};
+        return result;
+    }
+
+private:
+    bool more() const { return m_i < m_p.size(); }
+    char peek(std::size_t ahead = 0) const { return m_i + ahead < m_p.size() ? m_p[m_i + ahead] : '\0'; }
+
+    Literals parseAlternation()
+    {
+        Literals result;
+        bool branchWithoutLiterals = false;
+        for (;;) {
+            Literals branch = parseSequence();
+            if (branch.empty())
+                branchWithoutLiterals = true;
+            result.insert(result.end(), branch.begin(), branch.end());
+            if (peek() != '|')
+                break;
+            ++m_i;
+        }
+        if (branchWithoutLiterals)
+            return {};
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    Literals parseSequence()
+    {
+        Literals best;
+        std::string run;
+        auto flush = [&]() {
+            if (!run.empty() && better(Literals{run}, best))
+                best = Literals{run};
+            run.clear();
+        };
+
+        while (more() && peek() != '|' && peek() != ')') {
+            Atom atom = parseAtom();
+            if (m_failed)
+                return {};
+            const Quantifier q = parseQuantifier();
+
+            switch (atom.kind) {
+                case Atom::Literal:
+                    run += atom.prefix;
+                    if (q.present && q.min == 0) {
+                        flush();
+                    } else {
+                        run += atom.text;
+                        if (q.present)   // repeated: only one copy is certain, and nothing after it is adjacent
+                            flush();
+                    }
+                    break;
+                case Atom::Group:
+                    flush();
+                    if (!(q.present && q.min == 0) && better(atom.group, best))
+                        best = atom.group;
+                    break;
+                case Atom::Other:
+                    flush();
+                    break;
+                case Atom::Nothing:
+                    break;
+            }
+        }
+        flush();
+        return best;
+    }
+
+    Atom parseAtom()
+    {
+        Atom atom;
+        const char c = peek();
+        switch (c) {
+            case '(':
+                return parseGroup();
+            case '[':
+                skipClass();
+                return atom;
+            case '.':
+            case '^':
+            case '$':
+                ++m_i;
+                return atom;
+            case '\\':
+                return parseEscape();
+            case '*':
+            case '+':
+            case '?':
+                m_failed = true;   // quantifier without an atom
+                return atom;
+            case '\n':
+                ++m_i;
+                return atom;
+            default: {
+                const std::size_t len = std::min(utf8Length(static_cast<unsigned char>(c)), m_p.size() - m_i);
+                atom.kind = Atom::Literal;
+                atom.text = std::string(m_p.substr(m_i, len));
+                m_i += len;
+                return atom;
+            }
+        }
+    }
+
+    Atom parseGroup()
+    {
+        Atom atom;
+        ++m_i;   // '('
+        bool zeroWidth = false;
+        if (peek() == '?') {
+            const char k = peek(1);
+            if (k == ':' || k == '>' || k == '|') {
+                m_i += 2;
+            } else if (k == '=' || k == '!') {
+                m_i += 2;
+                zeroWidth = true;
+            } else if (k == '<' && (peek(2) == '=' || peek(2) == '!')) {
+                m_i += 3;
+                zeroWidth = true;
+            } else if (k == '<' || k == '\'' || (k == 'P' && peek(2) == '<')) {
+                const char close = k == '\'' ? '\'' : '>';
+                m_i += k == 'P' ? 3 : 2;
+                while (more() && peek() != close)
+                    ++m_i;
+                if (!more()) {
+                    m_failed = true;
+                    return atom;
+                }
+                ++m_i;
+            } else {
+                // Inline options, conditionals, recursion, callouts, comments...
+                m_failed = true;
+                return atom;
+            }
+        } else if (peek() == '*') {
+            m_failed = true;   // (*VERB)
+            return atom;
+        }
+
+        Literals inner = parseAlternation();
+        if (m_failed || peek() != ')') {
+            m_failed = true;
+            return atom;
+        }
+        ++m_i;
+
+        if (!zeroWidth) {
+            atom.kind = Atom::Group;
+            atom.group = std::move(inner);
+        }
+        return atom;
+    }
+
+    void skipClass()
+    {
+        ++m_i;   // '['
+        if (peek() == '^')
+            ++m_i;
+        if (peek() == ']')
+            ++m_i;
+        while (more()) {
+            const char c = peek();
+            if (c == '\\') {
+                m_i += 2;
+            } else if (c == '[' && peek(1) == ':') {
+                const std::size_t end = m_p.find(":]", m_i + 2);
+                m_i = end == std::string_view::npos ? m_p.size() : end + 2;
+            } else if (c == ']') {
+                ++m_i;
+                return;
+            } else {
+                ++m_i;
+            }
+        }
+        m_failed = true;   // unterminated
+    }
+
+    Atom parseEscape()
+    {
+        Atom atom;
+        ++m_i;   // '\\'
+        if (!more()) {
+            m_failed = true;
+            return atom;
+        }
+        const char e = m_p[m_i++];
+
+        auto literal = [&atom](char ch) {
+            atom.kind = Atom::Literal;
+            atom.text = std::string(1, ch);
+            return atom;
+        };
+        auto skipBraced = [this](char open, char close) {
+            if (peek() == open) {
+                while (more() && peek() != close)
+                    ++m_i;
+                if (more())
+                    ++m_i;
+            }
+        };
+
+        switch (e) {
+            case 'Q': {
+                const std::size_t end = m_p.find("\\E", m_i);
+                std::string text(m_p.substr(m_i, end == std::string_view::npos ? std::string_view::npos : end - m_i));
+                m_i = end == std::string_view::npos ? m_p.size() : end + 2;
+                if (text.empty() || text.find('\n') != std::string::npos) {
+                    atom.kind = text.empty() ? Atom::Nothing : Atom::Other;
+                    return atom;
+                }
+                // A quantifier after \E applies to the last character only
+                std::size_t last = text.size() - 1;
+                while (last > 0 && (static_cast<unsigned char>(text[last]) & 0xC0) == 0x80)
+                    --last;
+                atom.kind = Atom::Literal;
+                atom.prefix = text.substr(0, last);
+                atom.text = text.substr(last);
+                return atom;
+            }
+            case 'E':
+                atom.kind = Atom::Nothing;
+                return atom;
+            case 't': return literal('\t');
+            case 'r': return literal('\r');
+            case 'f': return literal('\f');
+            case 'e': return literal('\x1b');
+            case 'a': return literal('\a');
+            case 'x': {
+                unsigned value = 0;
+                int digits = 0;
+                if (peek() == '{') {
+                    ++m_i;
+                    while (more() && isHex(peek()) && digits < 8) {
+                        value = value * 16 + hexValue(peek());
+                        ++m_i;
+                        ++digits;
+                    }
+                    if (peek() != '}') {
+                        m_failed = true;
+                        return atom;
+                    }
+                    ++m_i;
+                } else {
+                    while (digits < 2 && isHex(peek())) {
+                        value = value * 16 + hexValue(peek());
+                        ++m_i;
+                        ++digits;
+                    }
+                }
+                // Only plain ASCII maps to a single byte; '\n' never occurs inside a line
+                if (value < 0x80 && value != '\n')
+                    return literal(static_cast<char>(value));
+                return atom;
+            }
+            case 'p':
+            case 'P':
+                if (peek() == '{')
+                    skipBraced('{', '}');
+                else if (more())
+                    ++m_i;
+                return atom;
+            case 'g':
+            case 'k':
+                if (peek() == '{')
+                    skipBraced('{', '}');
+                else if (peek() == '<')
+                    skipBraced('<', '>');
+                else if (peek() == '\'')
+                    skipBraced('\'', '\'');
+                else
+                    while (more() && (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '-'))
+                        ++m_i;
+                return atom;
+            case 'c':
+                if (more())
+                    ++m_i;
+                return atom;
+            default:
+                break;
+        }
+
+        if (std::isalnum(static_cast<unsigned char>(e))) {
+            // Classes (\d \w \s ...), assertions (\b \A \z ...), back references
+            while (std::isdigit(static_cast<unsigned char>(e)) && std::isdigit(static_cast<unsigned char>(peek())))
+                ++m_i;
+            return atom;
+        }
+
+        // Escaped punctuation or non-ASCII character stands for itself
+        const std::size_t len = std::min(utf8Length(static_cast<unsigned char>(e)), m_p.size() - m_i + 1);
+        atom.kind = Atom::Literal;
+        atom.text = std::string(m_p.substr(m_i - 1, len));
+        m_i += len - 1;
+        return atom;
+    }
+
+    Quantifier parseQuantifier()
+    {
+        Quantifier q;
+        switch (peek()) {
+            case '*':
+                q = {true, 0};
+                ++m_i;
+                break;
+            case '+':
+                q = {true, 1};
+                ++m_i;
+                break;
+            case '?':
+                q = {true, 0};
+                ++m_i;
+                break;
+            case '{': {
+                // {n}, {n,}, {n,m} and {,m}; anything else is a literal '{'
+                std::size_t j = m_i + 1;
+                unsigned min = 0;
+                bool haveMin = false;
+                while (j < m_p.size() && std::isdigit(static_cast<unsigned char>(m_p[j]))) {
+                    min = std::min(min * 10 + static_cast<unsigned>(m_p[j] - '0'), 65535u);
+                    haveMin = true;
+                    ++j;
+                }
+                bool haveComma = false;
+                if (j < m_p.size() && m_p[j] == ',') {
+                    haveComma = true;
+                    ++j;
+                    while (j < m_p.size() && std::isdigit(static_cast<unsigned char>(m_p[j])))
+                        ++j;
+                }
+                if (j < m_p.size() && m_p[j] == '}' && (haveMin || haveComma)) {
+                    q = {true, haveMin ? min : 0};
+                    m_i = j + 1;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        // Lazy / possessive suffix
+        if (q.present && (peek() == '?' || peek() == '+'))
+            ++m_i;
+        return q;
+    }
+
+    std::string_view m_p;
+    std::size_t m_i = 0;
+    bool m_failed = false;
+};
+
+} // anonymous namespace
+
+std::vector<std::string> requiredLiterals(std::string_view pattern)
+{
+    return Parser(pattern).parse();
+}
+
+} // namespace search
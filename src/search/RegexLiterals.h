@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace search {
+
+// Extract literal fragments that every match of a PCRE pattern must contain.
+//
+// Returns a set of alternatives: any string the pattern matches contains at
+// least one of them, so a file (or line) that contains none of them cannot
+// match. For a plain sequence that is the longest mandatory literal run; for
+// an alternation it is one fragment per branch. Returns an empty vector when
+// no such set can be derived (a branch without literals, inline option
+// settings such as (?i) or (?x), ...) - the caller must then run the regex on
+// everything.
+//
+// The analysis is conservative and ignores case: the returned fragments are
+// exact substrings of the pattern's literal text, to be matched with the same
+// case sensitivity as the regex. A fragment never contains a newline.
+std::vector<std::string> requiredLiterals(std::string_view pattern);
+
+} // namespace search
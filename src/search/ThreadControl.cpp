@@ -0,0 +1,63 @@
+#include "ThreadControl.h"
+
+#include <algorithm>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace search {
+
+namespace {
+
+// From linux/ioprio.h, which glibc does not wrap
+constexpr int IoprioWhoProcess = 1;
+constexpr int IoprioClassShift = 13;
+constexpr int IoprioClassBestEffort = 2;
+constexpr int IoprioClassIdle = 3;
+
+} // anonymous namespace
+
+bool applyToCurrentThread(const ThreadPriority& priority)
+{
+    bool ok = true;
+
+    if (priority.ioClass != IoClass::Default) {
+        const int ioClass = priority.ioClass == IoClass::Idle ? IoprioClassIdle : IoprioClassBestEffort;
+        const int level = priority.ioClass == IoClass::Idle ? 0 : std::clamp(priority.ioLevel, 0, 7);
+        // Who 0 is the calling thread, not the whole process
+        ok = ::syscall(SYS_ioprio_set, IoprioWhoProcess, 0, (ioClass << IoprioClassShift) | level) == 0;
+    }
+
+    if (priority.nice > 0) {
+        const auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+        ok = ::setpriority(PRIO_PROCESS, tid, std::min(priority.nice, 19)) == 0 && ok;
+    }
+
+    return ok;
+}
+
+void PauseGate::pause()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused.store(true, std::memory_order_relaxed);
+}
+
+void PauseGate::resume()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_paused.store(false, std::memory_order_relaxed);
+    }
+    m_resumed.notify_all();
+}
+
+void PauseGate::wait() const
+{
+    if (!m_paused.load(std::memory_order_relaxed))
+        return;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_resumed.wait(lock, [this]() { return !m_paused.load(std::memory_order_relaxed); });
+}
+
+} // namespace search
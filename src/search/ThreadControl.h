@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace search {
+
+// I/O scheduling class of a thread, see ioprio_set(2).
+enum class IoClass : std::uint8_t {
+    Default,      // inherited, normally best-effort derived from the nice level
+    BestEffort,   // with ThreadPriority::ioLevel
+    Idle          // only gets the disk when nobody else wants it
+};
+
+// How much of the machine background work may take.
+struct ThreadPriority {
+    IoClass ioClass = IoClass::Default;
+    int ioLevel = 4;       // best-effort level, 0 (highest) .. 7 (lowest)
+    int nice = 0;          // CPU nice level, 0 (unchanged) .. 19
+
+    bool isDefault() const { return ioClass == IoClass::Default && nice == 0; }
+};
+
+// Apply `priority` to the calling thread only - on Linux both the I/O
+// priority and the nice level are per thread. Raising the nice level cannot
+// be undone without privileges, so this is meant for threads that end with
+// the work they do. Returns false if the kernel refused either setting.
+bool applyToCurrentThread(const ThreadPriority& priority);
+
+// Lets a controller park worker threads at points where they hold no locks
+// and lose no state: workers call wait() between units of work, and it
+// blocks while the gate is paused. Costs an atomic load when it is not.
+class PauseGate {
+public:
+    void pause();
+    void resume();
+    bool isPaused() const { return m_paused.load(std::memory_order_relaxed); }
+
+    void wait() const;
+
+private:
+    std::atomic<bool> m_paused{false};
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_resumed;
+};
+
+} // namespace search
@@ -0,0 +1,141 @@
+#include "TopKReport.h"
+#include "ParallelWalker.h"
+
+#include <memory>
+#include <mutex>
+
+namespace search {
+
+namespace {
+
+struct LargerFirst {
+    bool operator()(const ReportEntry& a, const ReportEntry& b) const
+    {
+        return a.size != b.size ? a.size > b.size : a.path < b.path;
+    }
+};
+
+struct OlderFirst {
+    bool operator()(const ReportEntry& a, const ReportEntry& b) const
+    {
+        return a.mtimeNs != b.mtimeNs ? a.mtimeNs < b.mtimeNs : a.path < b.path;
+    }
+};
+
+// What one walker thread has seen
+struct Collector {
+    explicit Collector(std::size_t count)
+        : largestFiles(count)
+        , oldestFiles(count)
+        , largestDirs(count)
+    {
+    }
+
+    // The directory whose files are being summed
+    void closeDirectory()
+    {
+        if (dirSize > 0) {
+            ReportEntry dir{dirPath, dirSize, 0};
+            largestDirs.offer(std::move(dir));
+        }
+        dirPath.clear();
+        dirSize = 0;
+    }
+
+    BoundedTopK<ReportEntry, LargerFirst> largestFiles;
+    BoundedTopK<ReportEntry, OlderFirst> oldestFiles;
+    BoundedTopK<ReportEntry, LargerFirst> largestDirs;
+    std::string dirPath;
+    std::uint64_t dirSize = 0;
+    std::uint64_t files = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Tells the collectors of one findTopK() call from those of earlier calls,
+// which may have run on a thread with the same identity
+std::atomic<std::uint64_t> g_scanGeneration{0};
+
+} // anonymous namespace
+
+TopKReport findTopK(const std::string& root, const TopKOptions& options)
+{
+    const std::uint64_t generation = ++g_scanGeneration;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Collector>> collectors;
+
+    // Every thread finds its collector through a thread_local and only
+    // takes the lock the first time
+    auto collectorForThread = [&]() -> Collector& {
+        thread_local std::uint64_t ownGeneration = 0;
+        thread_local Collector* own = nullptr;
+        if (ownGeneration != generation) {
+            auto collector = std::make_unique<Collector>(options.count);
+            own = collector.get();
+            ownGeneration = generation;
+            std::lock_guard<std::mutex> lock(mutex);
+            collectors.push_back(std::move(collector));
+        }
+        return *own;
+    };
+
+    WalkOptions walkOptions;
+    walkOptions.threads = options.walkThreads;
+    walkOptions.cancel = options.cancel;
+    walkOptions.pause = options.pause;
+    walkOptions.oneFileSystem = options.oneFileSystem;
+    ParallelWalker walker(walkOptions);
+    walker.run(root, [&](const WalkEntry& entry) {
+        if (entry.type != EntryType::File)
+            return VisitResult::Continue;
+        EntryStat st;
+        if (!statEntry(entry, StatSize | StatMtime, st))
+            return VisitResult::Continue;
+
+        Collector& c = collectorForThread();
+        ++c.files;
+        c.bytes += st.size;
+        if (options.scanned)
+            options.scanned->fetch_add(1, std::memory_order_relaxed);
+
+        if (c.dirPath != entry.dirPath) {
+            c.closeDirectory();
+            c.dirPath = entry.dirPath;
+        }
+        c.dirSize += st.size;
+
+        // Paths are only built for files that make it into a heap
+        ReportEntry file{std::string(), st.size, st.mtimeNs};
+        const bool large = c.largestFiles.wants(file);
+        const bool old = c.oldestFiles.wants(file);
+        if (large || old) {
+            file.path = entry.path();
+            if (large && old)
+                c.largestFiles.offer(file);
+            else if (large)
+                c.largestFiles.offer(std::move(file));
+            if (old)
+                c.oldestFiles.offer(std::move(file));
+        }
+        return VisitResult::Continue;
+    });
+
+    Collector total(options.count);
+    for (const std::unique_ptr<Collector>& c : collectors) {
+        c->closeDirectory();
+        total.largestFiles.merge(c->largestFiles);
+        total.oldestFiles.merge(c->oldestFiles);
+        total.largestDirs.merge(c->largestDirs);
+        total.files += c->files;
+        total.bytes += c->bytes;
+    }
+
+    TopKReport report;
+    report.largestFiles = total.largestFiles.take();
+    report.oldestFiles = total.oldestFiles.take();
+    report.largestDirs = total.largestDirs.take();
+    report.files = total.files;
+    report.bytes = total.bytes;
+    return report;
+}
+
+} // namespace search
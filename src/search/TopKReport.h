@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace search {
+
+class PauseGate;
+
+// Keeps the `capacity` best items offered to it, best meaning first by
+// `Better`. A min-heap on the worst kept item, so memory stays bounded and
+// most offers are rejected with a single comparison.
+template <typename T, typename Better>
+class BoundedTopK {
+public:
+    explicit BoundedTopK(std::size_t capacity, Better better = Better())
+        : m_capacity(capacity)
+        , m_better(better)
+    {
+        m_items.reserve(capacity);
+    }
+
+    // True if `item` would be kept; lets the caller skip building it otherwise.
+    bool wants(const T& item) const
+    {
+        return m_items.size() < m_capacity || (m_capacity > 0 && m_better(item, m_items.front()));
+    }
+
+    void offer(T item)
+    {
+        if (!wants(item))
+            return;
+        if (m_items.size() == m_capacity) {
+            std::pop_heap(m_items.begin(), m_items.end(), m_better);
+            m_items.back() = std::move(item);
+        } else {
+            m_items.push_back(std::move(item));
+        }
+        std::push_heap(m_items.begin(), m_items.end(), m_better);
+    }
+
+    void merge(BoundedTopK& other)
+    {
+        for (T& item : other.m_items)
+            offer(std::move(item));
+        other.m_items.clear();
+    }
+
+    // The kept items, best first. Leaves the heap empty.
+    std::vector<T> take()
+    {
+        std::sort(m_items.begin(), m_items.end(), m_better);
+        return std::move(m_items);
+    }
+
+    std::size_t size() const { return m_items.size(); }
+
+private:
+    std::size_t m_capacity;
+    Better m_better;
+    std::vector<T> m_items;   // heap with the worst kept item in front
+};
+
+struct ReportEntry {
+    std::string path;
+    std::uint64_t size = 0;       // of a file, or of the files directly in a directory
+    std::int64_t mtimeNs = 0;     // files only
+};
+
+struct TopKReport {
+    std::vector<ReportEntry> largestFiles;   // largest first
+    std::vector<ReportEntry> oldestFiles;    // oldest first
+    std::vector<ReportEntry> largestDirs;    // largest first
+    std::uint64_t files = 0;                 // regular files scanned
+    std::uint64_t bytes = 0;                 // and their total size
+};
+
+struct TopKOptions {
+    std::size_t count = 100;                       // K, per list
+    unsigned walkThreads = 0;                      // 0 = hardware concurrency
+    bool oneFileSystem = false;
+    const std::atomic<bool>* cancel = nullptr;
+    const PauseGate* pause = nullptr;
+    std::atomic<std::uint64_t>* scanned = nullptr; // files so far, for a progress display
+};
+
+// Walk `root` with ParallelWalker and report its K largest files, K oldest
+// files and K largest directories. Every walker thread fills its own
+// BoundedTopK heaps, merged once the walk is done, so memory depends on K
+// and the thread count, not on the size of the tree.
+//
+// A directory's size is that of the files directly in it (like du -S):
+// totals over whole subtrees would have to keep every directory until the
+// walk ends. A directory's files are all read by one thread, one after
+// another, which is what lets each thread sum them on the fly. Symbolic
+// links are not followed. A cancelled scan returns what was seen so far.
+TopKReport findTopK(const std::string& root, const TopKOptions& options = {});
+
+} // namespace search
@@ -0,0 +1,697 @@
+#include "TrigramIndex.h"
+#include "FileScanner.h"
+#include "IndexFile.h"
+#include "LiteralMatcher.h"
+#include "NameIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace search {
+
+using namespace detail;
+
+namespace {
+
+constexpr char Magic[8] = {'G', 'C', 'T', 'I', 'D', 'X', '1', '\0'};
+constexpr std::uint32_t FormatVersion = 1;
+
+// Larger files contain nearly every trigram anyway, and reading them would
+// dominate the build; they are always read by the search itself.
+constexpr std::uint64_t MaxIndexedSize = 256ull * 1024 * 1024;
+// Files with more distinct trigrams - mostly large binaries - would match
+// nearly any literal while bloating every posting list; they are not indexed.
+constexpr std::size_t MaxTrigramsPerFile = 256 * 1024;
+// Files read before their trigrams are merged into the posting lists.
+constexpr std::size_t BuildBatchSize = 4096;
+// Posting lists intersected per literal. The rarest trigrams narrow the
+// result most; the others rarely remove more than a few files.
+constexpr std::size_t MaxListsPerLiteral = 6;
+constexpr std::size_t ReadSize = 1024 * 1024;
+constexpr std::size_t TrigramSpace = std::size_t(1) << 24;
+constexpr std::uint32_t NoList = 0xFFFFFFFFu;
+
+enum FileFlags : std::uint32_t {
+    NotIndexed = 1
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t rootLength;
+    std::uint64_t fileCount;
+    std::uint64_t trigramCount;
+    std::uint64_t pathsSize;
+    std::uint64_t postingsSize;
+    std::int64_t builtAt;          // nanoseconds since the epoch
+    std::uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct FileRecord {
+    std::uint64_t pathOffset;      // into the paths blob
+    std::uint32_t pathLength;
+    std::uint32_t flags;
+    std::uint64_t size;
+    std::int64_t mtimeNs;
+    std::int64_t ctimeNs;
+    std::uint64_t inode;
+};
+static_assert(sizeof(FileRecord) == 48);
+
+struct TrigramRecord {
+    std::uint32_t trigram;
+    std::uint32_t count;           // files in the posting list
+    std::uint64_t postingsOffset;  // into the postings blob
+};
+static_assert(sizeof(TrigramRecord) == 16);
+
+// Trigrams are three ASCII-folded bytes packed big-endian into 24 bits.
+inline std::uint32_t pushByte(std::uint32_t window, unsigned char c)
+{
+    return ((window << 8) | foldAscii(c)) & 0xFFFFFFu;
+}
+
+// Distinct trigrams of a literal, sorted. Empty for literals shorter than three bytes.
+std::vector<std::uint32_t> literalTrigrams(std::string_view literal)
+{
+    std::vector<std::uint32_t> trigrams;
+    std::uint32_t window = 0;
+    for (std::size_t i = 0; i < literal.size(); ++i) {
+        window = pushByte(window, static_cast<unsigned char>(literal[i]));
+        if (i >= 2)
+            trigrams.push_back(window);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+// Trigrams seen in one file: a bitmap over all 2^24 trigrams plus the list
+// of members, so that it can be cleared again without touching all of it.
+class TrigramSet {
+public:
+    TrigramSet() : m_bits(TrigramSpace / 64) {}
+
+    void add(std::uint32_t trigram)
+    {
+        std::uint64_t& word = m_bits[trigram >> 6];
+        const std::uint64_t bit = std::uint64_t(1) << (trigram & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            m_members.push_back(trigram);
+        }
+    }
+
+    std::size_t size() const { return m_members.size(); }
+
+    // The members, sorted; leaves the set empty.
+    std::vector<std::uint32_t> take()
+    {
+        std::vector<std::uint32_t> members;
+        members.swap(m_members);
+        for (std::uint32_t trigram : members)
+            m_bits[trigram >> 6] = 0;
+        std::sort(members.begin(), members.end());
+        return members;
+    }
+
+private:
+    std::vector<std::uint64_t> m_bits;
+    std::vector<std::uint32_t> m_members;
+};
+
+struct ScannedFile {
+    FileStamp stamp;
+    bool regular = false;          // exists and is a regular file
+    bool indexed = false;          // `trigrams` is complete
+    std::vector<std::uint32_t> trigrams;
+};
+
+ScannedFile readTrigrams(int rootFd, const std::string& relPath, TrigramSet& set, std::vector<char>& buffer,
+                         const std::atomic<bool>* cancel)
+{
+    ScannedFile result;
+    // O_NONBLOCK: the path may have been replaced by a FIFO since it was listed
+    FdGuard fd(::openat(rootFd, relPath.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NOFOLLOW | O_NONBLOCK));
+    if (fd.get() < 0)
+        return result;
+    struct stat st;
+    if (::fstat(fd.get(), &st) != 0 || !S_ISREG(st.st_mode))
+        return result;
+    result.regular = true;
+    result.stamp = FileStamp::of(st);
+    if (static_cast<std::uint64_t>(st.st_size) > MaxIndexedSize)
+        return result;
+    ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::uint32_t window = 0;
+    std::uint64_t total = 0;
+    for (;;) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            set.take();
+            return result;
+        }
+        const ssize_t n = ::read(fd.get(), buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR)
+            continue;
+        // Files with a UTF-16/32 byte order mark are searched decoded, so
+        // their raw bytes say nothing about what matches
+        if (n < 0 || (total == 0 && hasWideBom(buffer.data(), static_cast<std::size_t>(n)))) {
+            set.take();
+            return result;
+        }
+        if (n == 0)
+            break;
+        const auto* data = reinterpret_cast<const unsigned char*>(buffer.data());
+        std::size_t i = 0;
+        for (; i < static_cast<std::size_t>(n) && total + i < 2; ++i)
+            window = pushByte(window, data[i]);
+        for (; i < static_cast<std::size_t>(n); ++i) {
+            window = pushByte(window, data[i]);
+            set.add(window);
+        }
+        total += static_cast<std::uint64_t>(n);
+        if (set.size() > MaxTrigramsPerFile) {
+            set.take();
+            return result;
+        }
+    }
+    result.indexed = true;
+    result.trigrams = set.take();
+    return result;
+}
+
+void putVarint(std::string& out, std::uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Posting list under construction: ascending file numbers, each stored as
+// the varint of its distance to the previous one.
+struct PostingList {
+    std::string bytes;
+    std::uint32_t last = 0;
+    std::uint32_t count = 0;
+
+    void add(std::uint32_t file)
+    {
+        putVarint(bytes, count ? file - last : file);
+        last = file;
+        ++count;
+    }
+};
+
+// Run fn(t) for t in [0, threads), each on its own thread, t = 0 on the calling one.
+template<typename Fn>
+void runOnThreads(unsigned threads, const Fn& fn)
+{
+    std::vector<std::thread> helpers;
+    helpers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        helpers.emplace_back([&fn, t]() { fn(t); });
+    fn(0u);
+    for (std::thread& helper : helpers)
+        helper.join();
+}
+
+bool cancelled(const std::atomic<bool>* cancel)
+{
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+FileStamp FileStamp::of(const struct stat& st)
+{
+    return FileStamp{static_cast<std::uint64_t>(st.st_size), mtimeOf(st), ctimeOf(st),
+                     static_cast<std::uint64_t>(st.st_ino)};
+}
+
+// --- TrigramFilter -----------------------------------------------------------
+
+bool TrigramFilter::mayContain(std::string_view relPath, const struct stat& st) const
+{
+    const FileStamp stamp = FileStamp::of(st);
+    if (auto it = m_overrides.find(std::string(relPath)); it != m_overrides.end())
+        return it->second.candidate || !(it->second.stamp == stamp);
+
+    const std::int64_t file = m_base->findFile(relPath);
+    if (file < 0)
+        return true;
+    const auto f = static_cast<std::uint32_t>(file);
+    if (!m_base->fileIndexed(f) || !(m_base->fileStamp(f) == stamp))
+        return true;
+    return (m_candidates[f >> 6] >> (f & 63)) & 1;
+}
+
+// --- TrigramIndex ------------------------------------------------------------
+
+TrigramIndex::~TrigramIndex()
+{
+    if (m_map)
+        ::munmap(m_map, m_mapSize);
+}
+
+std::shared_ptr<const TrigramIndex> TrigramIndex::open(const std::string& indexFile)
+{
+    std::shared_ptr<TrigramIndex> index(new TrigramIndex());
+    if (!index->mapFile(indexFile))
+        return nullptr;
+    return index;
+}
+
+bool TrigramIndex::mapFile(const std::string& indexFile)
+{
+    FdGuard fd(::open(indexFile.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0)
+        return false;
+    struct stat st;
+    if (::fstat(fd.get(), &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FileHeader))
+        return false;
+
+    m_mapSize = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, m_mapSize, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (map == MAP_FAILED)
+        return false;
+    m_map = map;
+
+    const auto* base = static_cast<const char*>(m_map);
+    const auto* header = reinterpret_cast<const FileHeader*>(base);
+    if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != FormatVersion ||
+        header->fileCount > 0xFFFFFFFFu || header->trigramCount > TrigramSpace || header->pathsSize > m_mapSize ||
+        header->postingsSize > m_mapSize)
+        return false;
+
+    std::size_t offset = sizeof(FileHeader);
+    const std::size_t rootOffset = offset;
+    offset = align8(offset + header->rootLength);
+    const std::size_t filesOffset = offset;
+    offset += header->fileCount * sizeof(FileRecord);
+    const std::size_t trigramsOffset = offset;
+    offset += header->trigramCount * sizeof(TrigramRecord);
+    const std::size_t pathsOffset = offset;
+    offset = align8(offset + header->pathsSize);
+    const std::size_t postingsOffset = offset;
+    offset += header->postingsSize;
+    if (offset != m_mapSize)
+        return false;
+
+    m_header = header;
+    m_root.assign(base + rootOffset, header->rootLength);
+    m_files = base + filesOffset;
+    m_trigrams = base + trigramsOffset;
+    m_paths = base + pathsOffset;
+    m_postings = reinterpret_cast<const unsigned char*>(base + postingsOffset);
+    m_postingsSize = header->postingsSize;
+    return true;
+}
+
+std::int64_t TrigramIndex::builtAt() const
+{
+    return static_cast<const FileHeader*>(m_header)->builtAt;
+}
+
+std::size_t TrigramIndex::fileCount() const
+{
+    return static_cast<const FileHeader*>(m_header)->fileCount;
+}
+
+std::size_t TrigramIndex::trigramCount() const
+{
+    return static_cast<const FileHeader*>(m_header)->trigramCount;
+}
+
+std::string_view TrigramIndex::filePath(std::uint32_t file) const
+{
+    const FileRecord& r = static_cast<const FileRecord*>(m_files)[file];
+    return std::string_view(m_paths + r.pathOffset, r.pathLength);
+}
+
+FileStamp TrigramIndex::fileStamp(std::uint32_t file) const
+{
+    const FileRecord& r = static_cast<const FileRecord*>(m_files)[file];
+    return FileStamp{r.size, r.mtimeNs, r.ctimeNs, r.inode};
+}
+
+bool TrigramIndex::fileIndexed(std::uint32_t file) const
+{
+    return !(static_cast<const FileRecord*>(m_files)[file].flags & NotIndexed);
+}
+
+std::int64_t TrigramIndex::findFile(std::string_view relPath) const
+{
+    std::uint32_t lo = 0;
+    std::uint32_t hi = static_cast<std::uint32_t>(fileCount());
+    while (lo < hi) {
+        const std::uint32_t mid = lo + (hi - lo) / 2;
+        if (pathLess(filePath(mid), relPath))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < fileCount() && filePath(lo) == relPath ? static_cast<std::int64_t>(lo) : -1;
+}
+
+std::vector<std::uint32_t> TrigramIndex::filesContaining(std::string_view literal) const
+{
+    const auto* records = static_cast<const TrigramRecord*>(m_trigrams);
+    const auto* recordsEnd = records + trigramCount();
+
+    std::vector<const TrigramRecord*> lists;
+    for (std::uint32_t trigram : literalTrigrams(literal)) {
+        const TrigramRecord* r = std::lower_bound(records, recordsEnd, trigram,
+                                                  [](const TrigramRecord& rec, std::uint32_t t) {
+                                                      return rec.trigram < t;
+                                                  });
+        if (r == recordsEnd || r->trigram != trigram)
+            return {};   // no file has this trigram
+        lists.push_back(r);
+    }
+    std::sort(lists.begin(), lists.end(), [](const TrigramRecord* a, const TrigramRecord* b) {
+        return a->count < b->count;
+    });
+    if (lists.size() > MaxListsPerLiteral)
+        lists.resize(MaxListsPerLiteral);
+
+    const auto decode = [&](const TrigramRecord* r) {
+        std::vector<std::uint32_t> files;
+        files.reserve(r->count);
+        const unsigned char* p = m_postings + r->postingsOffset;
+        const unsigned char* end = r + 1 < recordsEnd ? m_postings + r[1].postingsOffset : m_postings + m_postingsSize;
+        std::uint32_t file = 0;
+        while (p < end && files.size() < r->count) {
+            std::uint32_t value = 0;
+            for (int shift = 0; p < end; shift += 7) {
+                const unsigned char b = *p++;
+                value |= static_cast<std::uint32_t>(b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    break;
+            }
+            file = files.empty() ? value : file + value;
+            if (file >= fileCount())
+                break;   // malformed
+            files.push_back(file);
+        }
+        return files;
+    };
+
+    std::vector<std::uint32_t> result = decode(lists.front());
+    for (std::size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        const std::vector<std::uint32_t> other = decode(lists[i]);
+        std::vector<std::uint32_t> both;
+        std::set_intersection(result.begin(), result.end(), other.begin(), other.end(), std::back_inserter(both));
+        result.swap(both);
+    }
+    return result;
+}
+
+void TrigramIndex::candidates(const std::vector<std::string>& literals, std::vector<std::uint64_t>& bits) const
+{
+    bits.assign((fileCount() + 63) / 64, 0);
+    for (const std::string& literal : literals) {
+        if (literal.size() < 3) {
+            std::fill(bits.begin(), bits.end(), ~std::uint64_t(0));
+            return;
+        }
+        for (std::uint32_t file : filesContaining(literal))
+            bits[file >> 6] |= std::uint64_t(1) << (file & 63);
+    }
+}
+
+bool TrigramIndex::build(const LiveNameIndex& names, const std::string& indexFile, unsigned threads,
+                         const std::atomic<bool>* cancel)
+{
+    const std::string root = names.root();
+    FdGuard rootFd(::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (rootFd.get() < 0)
+        return false;
+    const auto builtAt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Every regular file, in path order
+    std::mutex mutex;
+    std::vector<std::string> paths;
+    IndexQuery all;
+    all.threads = threads;
+    all.cancel = cancel;
+    names.query(all, [&](const IndexEntry& e) {
+        if (e.type == EntryType::File) {
+            std::string path = joinPath(e.dirPath, e.name);
+            std::lock_guard<std::mutex> lock(mutex);
+            paths.push_back(std::move(path));
+        }
+        return true;
+    });
+    if (cancelled(cancel))
+        return false;
+    std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) { return pathLess(a, b); });
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    if (paths.size() > 0xFFFFFFFFu)
+        return false;
+
+    // Files are read in batches; the posting lists are sharded by trigram so
+    // that every thread appends to its own lists when a batch is merged. A
+    // dense table maps each trigram to its list in the owning shard.
+    const unsigned threadCount = resolveThreads(threads);
+    const auto shardOf = [threadCount](std::uint32_t trigram) {
+        return static_cast<unsigned>((static_cast<std::uint64_t>(trigram * 2654435761u) * threadCount) >> 32);
+    };
+    std::vector<std::vector<PostingList>> shards(threadCount);
+    std::vector<std::uint32_t> listOf(TrigramSpace, NoList);
+    std::vector<std::unique_ptr<TrigramSet>> sets;
+    std::vector<std::vector<char>> buffers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        sets.push_back(std::make_unique<TrigramSet>());
+        buffers.emplace_back(ReadSize);
+    }
+
+    std::vector<FileRecord> files(paths.size());
+    std::vector<ScannedFile> batch;
+    for (std::size_t first = 0; first < paths.size(); first += BuildBatchSize) {
+        const std::size_t count = std::min(BuildBatchSize, paths.size() - first);
+        batch.assign(count, ScannedFile{});
+
+        // File sizes vary wildly, so threads take one file at a time
+        std::atomic<std::size_t> next{0};
+        runOnThreads(threadCount, [&](unsigned t) {
+            for (std::size_t i; !cancelled(cancel) && (i = next.fetch_add(1)) < count;)
+                batch[i] = readTrigrams(rootFd.get(), paths[first + i], *sets[t], buffers[t], cancel);
+        });
+        if (cancelled(cancel))
+            return false;
+
+        runOnThreads(threadCount, [&](unsigned shard) {
+            std::vector<PostingList>& lists = shards[shard];
+            for (std::size_t i = 0; i < count; ++i) {
+                for (std::uint32_t trigram : batch[i].trigrams) {
+                    if (threadCount > 1 && shardOf(trigram) != shard)
+                        continue;
+                    std::uint32_t& list = listOf[trigram];
+                    if (list == NoList) {
+                        list = static_cast<std::uint32_t>(lists.size());
+                        lists.emplace_back();
+                    }
+                    lists[list].add(static_cast<std::uint32_t>(first + i));
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const ScannedFile& scanned = batch[i];
+            files[first + i] = FileRecord{0, 0, scanned.indexed ? 0u : NotIndexed, scanned.stamp.size,
+                                          scanned.stamp.mtimeNs, scanned.stamp.ctimeNs, scanned.stamp.inode};
+        }
+    }
+
+    std::uint64_t pathsSize = 0;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        files[i].pathOffset = pathsSize;
+        files[i].pathLength = static_cast<std::uint32_t>(paths[i].size());
+        pathsSize += paths[i].size();
+    }
+
+    std::vector<std::pair<std::uint32_t, const PostingList*>> lists;
+    for (std::uint32_t trigram = 0; trigram < TrigramSpace; ++trigram)
+        if (listOf[trigram] != NoList)
+            lists.emplace_back(trigram, &shards[threadCount > 1 ? shardOf(trigram) : 0][listOf[trigram]]);
+    listOf = std::vector<std::uint32_t>();
+
+    std::vector<TrigramRecord> trigramRecords(lists.size());
+    std::uint64_t postingsSize = 0;
+    for (std::size_t i = 0; i < lists.size(); ++i) {
+        trigramRecords[i] = TrigramRecord{lists[i].first, lists[i].second->count, postingsSize};
+        postingsSize += lists[i].second->bytes.size();
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.rootLength = static_cast<std::uint32_t>(root.size());
+    header.fileCount = files.size();
+    header.trigramCount = trigramRecords.size();
+    header.pathsSize = pathsSize;
+    header.postingsSize = postingsSize;
+    header.builtAt = builtAt;
+
+    std::string tmpPath = indexFile + ".XXXXXX";
+    FdGuard fd(::mkstemp(tmpPath.data()));
+    if (fd.get() < 0)
+        return false;
+
+    FileWriter out(fd.get());
+    out.write(&header, sizeof(header));
+    out.write(root.data(), root.size());
+    out.padTo8();
+    out.write(files.data(), files.size() * sizeof(FileRecord));
+    out.write(trigramRecords.data(), trigramRecords.size() * sizeof(TrigramRecord));
+    for (const std::string& path : paths)
+        out.write(path.data(), path.size());
+    out.padTo8();
+    for (const auto& entry : lists)
+        out.write(entry.second->bytes.data(), entry.second->bytes.size());
+
+    if (!out.flush() || cancelled(cancel) || ::rename(tmpPath.c_str(), indexFile.c_str()) != 0) {
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// --- LiveTrigramIndex --------------------------------------------------------
+
+LiveTrigramIndex::LiveTrigramIndex(std::shared_ptr<const TrigramIndex> base)
+    : m_root(base->root())
+    , m_base(std::move(base))
+{
+}
+
+std::shared_ptr<const TrigramIndex> LiveTrigramIndex::base() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_base;
+}
+
+void LiveTrigramIndex::reset(std::shared_ptr<const TrigramIndex> base)
+{
+    std::lock_guard<std::mutex> update(m_updateMutex);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_base = std::move(base);
+    m_overrides.clear();
+}
+
+std::size_t LiveTrigramIndex::overrideCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_overrides.size();
+}
+
+void LiveTrigramIndex::refreshFiles(const std::vector<std::string>& relPaths, const std::atomic<bool>* cancel)
+{
+    std::lock_guard<std::mutex> update(m_updateMutex);
+    FdGuard rootFd(::open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (rootFd.get() < 0)
+        return;
+
+    TrigramSet set;
+    std::vector<char> buffer(ReadSize);
+    for (const std::string& relPath : relPaths) {
+        if (cancelled(cancel))
+            return;
+        ScannedFile scanned = readTrigrams(rootFd.get(), relPath, set, buffer, cancel);
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (scanned.regular)
+            m_overrides[relPath] = OwnedFile{scanned.stamp, scanned.indexed, std::move(scanned.trigrams)};
+        else
+            m_overrides.erase(relPath);
+    }
+}
+
+std::vector<std::string> LiveTrigramIndex::staleFiles(const LiveNameIndex& names,
+                                                      const std::atomic<bool>* cancel) const
+{
+    FdGuard rootFd(::open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (rootFd.get() < 0)
+        return {};
+
+    // Compared against a snapshot, so that refreshes need not wait for the
+    // whole tree to be stat'ed
+    std::shared_ptr<const TrigramIndex> base;
+    std::unordered_map<std::string, FileStamp> overridden;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        base = m_base;
+        for (const auto& [path, file] : m_overrides)
+            overridden.emplace(path, file.stamp);
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> stale;
+    IndexQuery all;
+    all.cancel = cancel;
+    names.query(all, [&](const IndexEntry& e) {
+        if (e.type != EntryType::File)
+            return true;
+        std::string path = joinPath(e.dirPath, e.name);
+        struct stat st;
+        if (::fstatat(rootFd.get(), path.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode))
+            return true;
+        const FileStamp stamp = FileStamp::of(st);
+
+        bool current;
+        if (auto it = overridden.find(path); it != overridden.end()) {
+            current = it->second == stamp;
+        } else {
+            const std::int64_t file = base->findFile(path);
+            current = file >= 0 && base->fileStamp(static_cast<std::uint32_t>(file)) == stamp;
+        }
+        if (!current) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stale.push_back(std::move(path));
+        }
+        return true;
+    });
+
+    std::sort(stale.begin(), stale.end(), [](const std::string& a, const std::string& b) { return pathLess(a, b); });
+    return stale;
+}
+
+std::shared_ptr<const TrigramFilter> LiveTrigramIndex::filter(const std::vector<std::string>& literals) const
+{
+    if (literals.empty())
+        return nullptr;
+    std::vector<std::vector<std::uint32_t>> literalSets;
+    for (const std::string& literal : literals) {
+        if (literal.size() < 3)
+            return nullptr;
+        literalSets.push_back(literalTrigrams(literal));
+    }
+
+    auto result = std::make_shared<TrigramFilter>();
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        result->m_base = m_base;
+        for (const auto& [path, file] : m_overrides) {
+            const bool candidate = !file.indexed ||
+                std::any_of(literalSets.begin(), literalSets.end(), [&file](const std::vector<std::uint32_t>& set) {
+                    return std::includes(file.trigrams.begin(), file.trigrams.end(), set.begin(), set.end());
+                });
+            result->m_overrides.emplace(path, TrigramFilter::Override{file.stamp, candidate});
+        }
+    }
+    result->m_base->candidates(literals, result->m_candidates);
+    return result;
+}
+
+} // namespace search
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace search {
+
+class LiveNameIndex;
+class TrigramIndex;
+
+// What identifies one version of a file's contents. ctime and the inode
+// number catch rewrites that keep size and mtime (rsync, cp -p, tar).
+struct FileStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    std::int64_t ctimeNs = 0;
+    std::uint64_t inode = 0;
+
+    static FileStamp of(const struct stat& st);
+    bool operator==(const FileStamp& other) const = default;
+};
+
+// Which files of an indexed tree may contain a match. Taken from a
+// LiveTrigramIndex for one search; immutable and safe to share between
+// threads.
+class TrigramFilter {
+public:
+    // False only if the file, as identified by `st`, was indexed and cannot
+    // contain any of the literals. Unknown, unindexed and changed files are
+    // always candidates.
+    bool mayContain(std::string_view relPath, const struct stat& st) const;
+
+private:
+    friend class LiveTrigramIndex;
+
+    struct Override {
+        FileStamp stamp;
+        bool candidate;
+    };
+
+    std::shared_ptr<const TrigramIndex> m_base;
+    std::vector<std::uint64_t> m_candidates;                  // bit per base file
+    std::unordered_map<std::string, Override> m_overrides;    // by relative path
+};
+
+// Immutable, memory-mapped trigram index of the regular files of a tree.
+//
+// For every distinct sequence of three bytes (after ASCII case folding) the
+// index lists the files containing it. A file can only contain a literal if
+// it contains all of the literal's trigrams, so intersecting a few posting
+// lists - picking the rarest trigrams - yields a small superset of the files
+// worth reading. Each file also records its FileStamp; a file whose stamp no
+// longer matches is a candidate until it is indexed again.
+//
+// File layout: header, root path, file table (sorted like NameIndex
+// directories), trigram table (sorted by trigram), a blob of file paths and
+// the posting lists, delta- and varint-encoded. Like NameIndex, files are
+// written once and renamed into place.
+class TrigramIndex {
+public:
+    ~TrigramIndex();
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    // Map an index file. Returns null if it is missing or malformed.
+    static std::shared_ptr<const TrigramIndex> open(const std::string& indexFile);
+
+    // Read every regular file `names` lists and write the index of their
+    // contents to `indexFile`. Returns false on failure or cancellation.
+    static bool build(const LiveNameIndex& names, const std::string& indexFile, unsigned threads = 0,
+                      const std::atomic<bool>* cancel = nullptr);
+
+    const std::string& root() const { return m_root; }
+    std::int64_t builtAt() const;
+    std::size_t fileCount() const;
+    std::size_t trigramCount() const;
+
+    std::string_view filePath(std::uint32_t file) const;
+    FileStamp fileStamp(std::uint32_t file) const;
+    // False for files whose contents were not indexed (too large, UTF-16/32,
+    // unreadable); those are always candidates.
+    bool fileIndexed(std::uint32_t file) const;
+    // Index of a file by relative path, or -1.
+    std::int64_t findFile(std::string_view relPath) const;
+
+    // Set the bit of every file that may contain at least one of `literals`
+    // (see LiveTrigramIndex::filter()). `bits` is resized to fileCount().
+    void candidates(const std::vector<std::string>& literals, std::vector<std::uint64_t>& bits) const;
+
+private:
+    TrigramIndex() = default;
+    bool mapFile(const std::string& indexFile);
+    std::vector<std::uint32_t> filesContaining(std::string_view literal) const;
+
+    void* m_map = nullptr;
+    std::size_t m_mapSize = 0;
+    std::string m_root;
+    const void* m_header = nullptr;
+    const void* m_files = nullptr;
+    const void* m_trigrams = nullptr;
+    const char* m_paths = nullptr;
+    const unsigned char* m_postings = nullptr;
+    std::size_t m_postingsSize = 0;
+};
+
+// A TrigramIndex plus the files re-read since it was built.
+//
+// Safe to use from several threads while another one refreshes files.
+class LiveTrigramIndex {
+public:
+    explicit LiveTrigramIndex(std::shared_ptr<const TrigramIndex> base);
+
+    const std::string& root() const { return m_root; }
+    std::shared_ptr<const TrigramIndex> base() const;
+
+    // Re-read files (relative paths). A file that is gone, or no longer a
+    // regular file, is forgotten. Updates are serialized; queries only wait
+    // while a new entry is swapped in.
+    void refreshFiles(const std::vector<std::string>& relPaths, const std::atomic<bool>* cancel = nullptr);
+
+    // Replace the base, e.g. after a rebuild; clears all overrides.
+    void reset(std::shared_ptr<const TrigramIndex> base);
+
+    // Number of files currently overriding the base.
+    std::size_t overrideCount() const;
+
+    // Relative paths of the regular files `names` lists that are not indexed
+    // in their current version: new ones and ones changed since.
+    std::vector<std::string> staleFiles(const LiveNameIndex& names, const std::atomic<bool>* cancel = nullptr) const;
+
+    // Filter for a search in which every match contains at least one of
+    // `literals`, matched as bytes (case-sensitively or with ASCII folding).
+    // Null if the literals cannot narrow the search: one of them is shorter
+    // than three bytes.
+    std::shared_ptr<const TrigramFilter> filter(const std::vector<std::string>& literals) const;
+
+private:
+    struct OwnedFile {
+        FileStamp stamp;
+        bool indexed;
+        std::vector<std::uint32_t> trigrams;   // sorted
+    };
+
+    std::string m_root;
+    std::mutex m_updateMutex;                                // serializes writers
+    mutable std::shared_mutex m_mutex;                       // guards the state below
+    std::shared_ptr<const TrigramIndex> m_base;
+    std::unordered_map<std::string, OwnedFile> m_overrides;  // by relative path
+};
+
+} // namespace search
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "ChunkPipeline.h"
+
+namespace {
+
+std::string pattern(std::size_t size)
+{
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i)
+        data[i] = static_cast<char>('a' + (i * 7) % 26);
+    return data;
+}
+
+} // anonymous namespace
+
+TEST(ChunkPipelineTest, CopiesAndHashesInOrder)
+{
+    const std::string source = pattern(10 * 4096 + 123);
+    ChunkPipeline::Options options;
+    options.chunkSize = 4096;
+    options.chunks = 3;
+    ChunkPipeline pipeline(options);
+
+    std::size_t offset = 0;
+    std::string hashed;
+    std::string written;
+    std::uint64_t lastPoll = 0;
+    const ChunkPipeline::Result result = pipeline.run(
+        [&](char* buffer, std::size_t capacity) -> std::int64_t {
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buffer) % 4096, 0u);
+            const std::size_t n = std::min(capacity, source.size() - offset);
+            source.copy(buffer, n, offset);
+            offset += n;
+            return static_cast<std::int64_t>(n);
+        },
+        [&](const char* data, std::size_t length) { hashed.append(data, length); },
+        [&](const char* data, std::size_t length) {
+            written.append(data, length);
+            return true;
+        },
+        [&](std::uint64_t total) {
+            lastPoll = total;
+            return true;
+        });
+
+    EXPECT_EQ(result, ChunkPipeline::Result::Done);
+    EXPECT_EQ(hashed, source);
+    EXPECT_EQ(written, source);
+    EXPECT_EQ(lastPoll, source.size());
+}
+
+TEST(ChunkPipelineTest, ReportsFailuresAndCancel)
+{
+    ChunkPipeline::Options options;
+    options.chunkSize = 100;    // rounded up to the alignment
+    options.pollMs = 1;
+    ChunkPipeline pipeline(options);
+    EXPECT_EQ(pipeline.chunkSize(), 4096u);
+
+    auto endless = [](char* buffer, std::size_t capacity) -> std::int64_t {
+        std::fill_n(buffer, capacity, 'x');
+        return static_cast<std::int64_t>(capacity);
+    };
+    auto sink = [](const char*, std::size_t) { return true; };
+
+    int chunks = 0;
+    EXPECT_EQ(pipeline.run([&](char*, std::size_t) -> std::int64_t { return ++chunks < 5 ? 10 : -1; }, {}, sink, {}),
+              ChunkPipeline::Result::ReadFailed);
+
+    chunks = 0;
+    EXPECT_EQ(pipeline.run(endless, {}, [&](const char*, std::size_t) { return ++chunks < 5; }, {}),
+              ChunkPipeline::Result::WriteFailed);
+
+    EXPECT_EQ(pipeline.run(endless, {}, sink, [](std::uint64_t total) { return total < 1000000; }),
+              ChunkPipeline::Result::Cancelled);
+
+    // Empty input
+    EXPECT_EQ(pipeline.run([](char*, std::size_t) -> std::int64_t { return 0; }, {}, sink, {}),
+              ChunkPipeline::Result::Done);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "search/DuplicateFinder.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void writeFile(const fs::path& path, const std::string& content)
+{
+    std::ofstream(path, std::ios::binary) << content;
+}
+
+} // anonymous namespace
+
+TEST(DuplicateFinderTest, GroupsIdenticalContentOnly)
+{
+    const fs::path root = fs::temp_directory_path() / ("dupes_test_" + std::to_string(::getpid()));
+    fs::remove_all(root);
+    fs::create_directories(root / "a");
+    fs::create_directories(root / "b");
+
+    const std::string big(100000, 'x');
+    std::string bigMiddle = big;          // same size, same ends, other middle
+    bigMiddle[50000] = 'y';
+    std::string bigEnd = big;             // same size, other last byte
+    bigEnd.back() = 'z';
+
+    writeFile(root / "a" / "big1", big);
+    writeFile(root / "b" / "big2", big);
+    writeFile(root / "b" / "big3", big);
+    writeFile(root / "a" / "middle", bigMiddle);
+    writeFile(root / "a" / "end", bigEnd);
+    writeFile(root / "a" / "small1", "hello");
+    writeFile(root / "b" / "small2", "hello");
+    writeFile(root / "b" / "other", "world");   // same size as the small ones
+    writeFile(root / "a" / "empty1", "");
+    writeFile(root / "b" / "empty2", "");
+    fs::create_hard_link(root / "a" / "big1", root / "a" / "big1link");
+    writeFile(root / "a" / "lonely", "only one copy, but linked");
+    fs::create_hard_link(root / "a" / "lonely", root / "b" / "lonelylink");
+
+    search::DuplicateOptions options;
+    options.sampleBytes = 1024;
+    search::DuplicateProgress progress;
+    options.progress = &progress;
+    const std::vector<search::DuplicateGroup> groups = search::findDuplicates(root.string(), options);
+
+    ASSERT_EQ(groups.size(), 2u);
+
+    // Largest waste first: three copies of `big`, one of them with two links
+    EXPECT_EQ(groups[0].size, big.size());
+    EXPECT_EQ(groups[0].copies, 3u);
+    EXPECT_EQ(groups[0].wastedBytes(), 2 * big.size());
+    std::vector<std::string> names;
+    for (const search::DuplicateFile& file : groups[0].files)
+        names.push_back(fs::path(file.path).filename().string());
+    EXPECT_EQ(names, (std::vector<std::string>{"big1", "big1link", "big2", "big3"}));
+    EXPECT_EQ(groups[0].files[0].inode, groups[0].files[1].inode);
+
+    EXPECT_EQ(groups[1].size, 5u);
+    EXPECT_EQ(groups[1].copies, 2u);
+    EXPECT_EQ(groups[1].files.size(), 2u);
+
+    EXPECT_EQ(progress.stage.load(), search::DuplicateStage::Done);
+
+    fs::remove_all(root);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "search/FuzzyMatcher.h"
+
+TEST(FuzzyMatcherTest, MatchesSubsequences)
+{
+    search::FuzzyMatcher matcher("fmcpp");
+    EXPECT_GE(matcher.score("src/search/FuzzyMatcher.cpp"), 0);
+    EXPECT_GE(matcher.score("FMCPP"), 0);
+    EXPECT_EQ(matcher.score("src/search/FuzzyMatcher.h"), -1);
+    EXPECT_EQ(matcher.score("ppcmf"), -1);
+    EXPECT_EQ(search::FuzzyMatcher("").score("anything"), 0);
+
+    // Smart case: an uppercase letter makes the query case-sensitive
+    search::FuzzyMatcher upper("Main");
+    EXPECT_GE(upper.score("src/MainWindow.cpp"), 0);
+    EXPECT_EQ(upper.score("src/main.cpp"), -1);
+}
+
+TEST(FuzzyMatcherTest, RanksBoundariesAndRuns)
+{
+    search::FuzzyMatcher matcher("main");
+    EXPECT_GT(matcher.score("src/main.cpp"), matcher.score("src/domain.cpp"));
+    EXPECT_GT(matcher.score("src/main.cpp"), matcher.score("main/src/x.cpp"));
+    EXPECT_GT(matcher.score("src/main.cpp"), matcher.score("src/m_a_i_n.cpp"));
+
+    search::FuzzyMatcher camel("fpw");
+    EXPECT_GT(camel.score("src/FilePaneWidget.cpp"), camel.score("src/fopwx.cpp"));
+}
+
+TEST(FuzzyMatcherTest, FindAgreesWithScoringEveryCandidate)
+{
+    std::mt19937 rng(7);
+    const std::string alphabet = "abcdefgh/._-ABC";
+    search::FuzzyCandidates candidates;
+    for (int i = 0; i < 100000; ++i) {
+        std::string path;
+        const int length = 5 + static_cast<int>(rng() % 40);
+        for (int k = 0; k < length; ++k)
+            path.push_back(alphabet[rng() % alphabet.size()]);
+        candidates.add(path);
+    }
+
+    search::FuzzyMatcher matcher("abc");
+    std::vector<std::uint32_t> expected;
+    int bestScore = -1;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        const int score = matcher.score(candidates.at(i));
+        if (score >= 0)
+            expected.push_back(static_cast<std::uint32_t>(i));
+        bestScore = std::max(bestScore, score);
+    }
+
+    for (unsigned threads : {1u, 4u}) {
+        const search::FuzzyResults results = search::fuzzyFind(candidates, matcher, 50, nullptr, threads);
+        EXPECT_EQ(results.matched, expected);
+        ASSERT_EQ(results.best.size(), 50u);
+        EXPECT_EQ(results.best.front().score, bestScore);
+        for (std::size_t i = 1; i < results.best.size(); ++i)
+            EXPECT_GE(results.best[i - 1].score, results.best[i].score);
+    }
+
+    // Narrowing: a longer query only needs the previous matches
+    search::FuzzyMatcher longer("abcd");
+    const search::FuzzyResults all = search::fuzzyFind(candidates, longer, 20, nullptr, 4);
+    const search::FuzzyResults narrowed = search::fuzzyFind(candidates, longer, 20, &expected, 4);
+    EXPECT_EQ(all.matched, narrowed.matched);
+    ASSERT_EQ(all.best.size(), narrowed.best.size());
+    for (std::size_t i = 0; i < all.best.size(); ++i)
+        EXPECT_EQ(all.best[i].index, narrowed.best[i].index);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+#include "search/GlobMatcher.h"
+
+namespace {
+
+bool matches(const std::string& masks, const std::string& name, bool caseSensitive = false, bool partOfName = false)
+{
+    search::GlobOptions options;
+    options.caseSensitive = caseSensitive;
+    options.partOfName = partOfName;
+    return search::GlobMatcher(masks, options).matches(name);
+}
+
+// Reference: exhaustive recursion over an ASCII mask of '*', '?' and literals
+bool naiveGlob(const char* mask, const char* name)
+{
+    if (*mask == '\0')
+        return *name == '\0';
+    if (*mask == '*')
+        return naiveGlob(mask + 1, name) || (*name != '\0' && naiveGlob(mask, name + 1));
+    if (*name == '\0')
+        return false;
+    return (*mask == '?' || *mask == *name) && naiveGlob(mask + 1, name + 1);
+}
+
+} // anonymous namespace
+
+TEST(GlobMatcherTest, SimpleMasks)
+{
+    EXPECT_TRUE(matches("*", "anything"));
+    EXPECT_TRUE(matches("*", ""));
+    EXPECT_TRUE(matches("Makefile", "makefile"));
+    EXPECT_FALSE(matches("Makefile", "makefile", true));
+    EXPECT_FALSE(matches("Makefile", "Makefile.am"));
+    EXPECT_TRUE(matches("read*", "README.md"));
+    EXPECT_TRUE(matches("*.TXT", "notes.txt"));
+    EXPECT_FALSE(matches("*.txt", "notes.txt.bak"));
+    EXPECT_TRUE(matches("*core*", "libcore.so"));
+    EXPECT_FALSE(matches("*core*", "libcor.so"));
+
+    // Regex syntax is literal
+    EXPECT_TRUE(matches("a+b (1).c", "a+b (1).c"));
+    EXPECT_FALSE(matches("a.c", "abc"));
+    EXPECT_TRUE(matches("x\\y", "x\\y"));
+    EXPECT_TRUE(matches("[ab", "[ab"));
+}
+
+TEST(GlobMatcherTest, MultipleMasksAndExtensionSets)
+{
+    const search::GlobMatcher matcher(" *.cpp ; *.H;*.hpp;; Makefile ;*.tar.gz");
+    EXPECT_TRUE(matcher.matches("main.cpp"));
+    EXPECT_TRUE(matcher.matches("MAIN.CPP"));
+    EXPECT_TRUE(matcher.matches("util.h"));
+    EXPECT_TRUE(matcher.matches(".hpp"));
+    EXPECT_TRUE(matcher.matches("Makefile"));
+    EXPECT_TRUE(matcher.matches("src.tar.gz"));
+    EXPECT_FALSE(matcher.matches("main.c"));
+    EXPECT_FALSE(matcher.matches("cpp"));
+    EXPECT_FALSE(matcher.matches("main.cpp.orig"));
+    EXPECT_TRUE(matcher.requiredLiteral().empty());
+
+    EXPECT_TRUE(search::GlobMatcher(" ; ").empty());
+    EXPECT_FALSE(search::GlobMatcher(" ; ").matches("x"));
+    EXPECT_EQ(search::GlobMatcher::split("a; b ;;c"), (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(GlobMatcherTest, WildcardsAndSets)
+{
+    EXPECT_TRUE(matches("file?.log", "file1.log"));
+    EXPECT_FALSE(matches("file?.log", "file.log"));
+    EXPECT_TRUE(matches("?.txt", "\xC3\xA9.txt"));        // '?' is one character, not one byte
+    EXPECT_TRUE(matches("img[0-9][0-9].png", "img42.png"));
+    EXPECT_FALSE(matches("img[0-9][0-9].png", "img4x.png"));
+    EXPECT_TRUE(matches("[!.]*", "visible"));
+    EXPECT_FALSE(matches("[!.]*", ".hidden"));
+    EXPECT_TRUE(matches("[^.]*", "visible"));
+    EXPECT_TRUE(matches("[]x]", "]"));
+    EXPECT_TRUE(matches("[A-C]*", "bravo"));
+    EXPECT_FALSE(matches("[A-C]*", "bravo", true));
+    EXPECT_TRUE(matches("*a*b*c*", "xxaxxbxxcxx"));
+    EXPECT_FALSE(matches("*a*b*c*", "xxcxxbxxaxx"));
+}
+
+TEST(GlobMatcherTest, PartOfNameAndRequiredLiteral)
+{
+    EXPECT_TRUE(matches("port", "report.pdf", false, true));
+    EXPECT_TRUE(matches("*.pdf", "report.pdf.part", false, true));
+    EXPECT_FALSE(matches("port", "report.pdf", false, false));
+
+    search::GlobOptions options;
+    options.partOfName = true;
+    EXPECT_EQ(search::GlobMatcher("Report", options).requiredLiteral(), "report");
+    EXPECT_EQ(search::GlobMatcher("ab?cdef*g").requiredLiteral(), "cdef");
+    EXPECT_EQ(search::GlobMatcher("*").requiredLiteral(), "");
+
+    EXPECT_TRUE(search::GlobMatcher::supports("*.txt", false));
+    EXPECT_TRUE(search::GlobMatcher::supports("\xC3\x89t\xC3\xA9*", true));
+    EXPECT_FALSE(search::GlobMatcher::supports("\xC3\x89t\xC3\xA9*", false));
+}
+
+TEST(GlobMatcherTest, AgreesWithNaiveMatcher)
+{
+    std::mt19937 rng(7);
+    const std::string maskAlphabet = "ab*?";
+    const std::string nameAlphabet = "ab";
+    for (int round = 0; round < 20000; ++round) {
+        std::string mask;
+        std::string name;
+        for (std::size_t i = rng() % 7; i > 0; --i)
+            mask += maskAlphabet[rng() % maskAlphabet.size()];
+        for (std::size_t i = rng() % 9; i > 0; --i)
+            name += nameAlphabet[rng() % nameAlphabet.size()];
+        if (mask.empty())
+            continue;
+        EXPECT_EQ(matches(mask, name, true), naiveGlob(mask.c_str(), name.c_str())) << mask << " / " << name;
+    }
+}
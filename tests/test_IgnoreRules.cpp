@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "search/IgnoreRules.h"
+
+namespace {
+
+using Verdict = search::IgnoreRules::Verdict;
+
+Verdict check(const std::string& rules, const std::string& relPath, bool isDir = false)
+{
+    search::IgnoreRules parsed;
+    parsed.parse(rules);
+    const std::size_t slash = relPath.rfind('/');
+    const std::string name = slash == std::string::npos ? relPath : relPath.substr(slash + 1);
+    return parsed.match(relPath, name, isDir);
+}
+
+} // anonymous namespace
+
+TEST(IgnoreRulesTest, NamesMatchAtAnyDepth)
+{
+    EXPECT_EQ(check("node_modules\n", "node_modules", true), Verdict::Ignore);
+    EXPECT_EQ(check("node_modules\n", "web/app/node_modules", true), Verdict::Ignore);
+    EXPECT_EQ(check("*.o\n", "src/main.o"), Verdict::Ignore);
+    EXPECT_EQ(check("*.o\n", "src/main.c"), Verdict::None);
+    EXPECT_EQ(check("build/\n", "build"), Verdict::None);          // directories only
+    EXPECT_EQ(check("build/\n", "sub/build", true), Verdict::Ignore);
+    EXPECT_EQ(check("# comment\n\n   \n", "comment"), Verdict::None);
+    EXPECT_EQ(check("\\#hash\n", "#hash"), Verdict::Ignore);
+    EXPECT_EQ(check("file?.t[xy]t\r\n", "file1.txt"), Verdict::Ignore);
+    EXPECT_EQ(check("file?.t[!xy]t\n", "file1.txt"), Verdict::None);
+}
+
+TEST(IgnoreRulesTest, SlashesAnchorToTheFile)
+{
+    EXPECT_EQ(check("/build\n", "build", true), Verdict::Ignore);
+    EXPECT_EQ(check("/build\n", "src/build", true), Verdict::None);
+    EXPECT_EQ(check("doc/*.html\n", "doc/index.html"), Verdict::Ignore);
+    EXPECT_EQ(check("doc/*.html\n", "doc/api/index.html"), Verdict::None);   // '*' stops at '/'
+    EXPECT_EQ(check("**/logs\n", "logs", true), Verdict::Ignore);
+    EXPECT_EQ(check("**/logs\n", "a/b/logs", true), Verdict::Ignore);
+    EXPECT_EQ(check("a/**/b\n", "a/b"), Verdict::Ignore);
+    EXPECT_EQ(check("a/**/b\n", "a/x/y/b"), Verdict::Ignore);
+    EXPECT_EQ(check("out/**\n", "out/x/y"), Verdict::Ignore);
+    EXPECT_EQ(check("out/**\n", "out", true), Verdict::None);
+}
+
+TEST(IgnoreRulesTest, LastMatchingRuleWins)
+{
+    EXPECT_EQ(check("*.log\n!keep.log\n", "keep.log"), Verdict::Include);
+    EXPECT_EQ(check("*.log\n!keep.log\n", "drop.log"), Verdict::Ignore);
+    EXPECT_EQ(check("!keep.log\n*.log\n", "keep.log"), Verdict::Ignore);
+}
+
+TEST(IgnoreRulesTest, DeeperScopesTakePrecedence)
+{
+    auto top = std::make_shared<search::IgnoreScope>();
+    top->dirPath = "/r";
+    top->rules.parse("*.tmp\n/sub/pinned\n");
+    auto sub = std::make_shared<search::IgnoreScope>();
+    sub->dirPath = "/r/sub";
+    sub->rules.parse("!keep.tmp\n");
+    sub->parent = top;
+
+    EXPECT_TRUE(sub->ignores("/r/sub/deep", "x.tmp", false));
+    EXPECT_FALSE(sub->ignores("/r/sub/deep", "keep.tmp", false));
+    EXPECT_TRUE(sub->ignores("/r/sub", "pinned", false));
+    EXPECT_FALSE(sub->ignores("/r/sub/deep", "pinned", false));
+
+    // Rules read above the walk root see paths from where they were read
+    auto above = std::make_shared<search::IgnoreScope>();
+    above->dirPath = "/r";
+    above->prefix = "project/r";
+    above->rules.parse("/project/r/gen\n");
+    EXPECT_TRUE(above->ignores("/r", "gen", true));
+    EXPECT_FALSE(above->ignores("/r/x", "gen", true));
+}
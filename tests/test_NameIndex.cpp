@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "search/NameIndex.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// "a", "a b" and "a/x" exercise the subtree ordering ('/' before ' ').
+class NameIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        base = fs::temp_directory_path() / ("name_index_test_" + std::to_string(::getpid()));
+        fs::remove_all(base);
+        root = base / "tree";
+        fs::create_directories(root / "a" / "x");
+        fs::create_directories(root / "a b");
+        fs::create_directories(root / "src" / "search");
+        std::ofstream(root / "a" / "Readme.md") << "hello";
+        std::ofstream(root / "a" / "x" / "notes.txt") << "12345";
+        std::ofstream(root / "a b" / "readme.txt") << "";
+        std::ofstream(root / "src" / "search" / "NameIndex.cpp") << "//";
+        std::ofstream(root / "top.txt") << "top";
+        indexFile = (base / "tree.idx").string();
+        ASSERT_TRUE(search::NameIndex::build(root.string(), indexFile, 2));
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(base);
+    }
+
+    template<typename Index>
+    static std::set<std::string> query(const Index& index, std::string_view literal, bool caseSensitive = true,
+                                       std::string_view subtree = {})
+    {
+        std::mutex mutex;
+        std::set<std::string> result;
+        search::IndexQuery q;
+        q.literal = literal;
+        q.caseSensitive = caseSensitive;
+        q.subtree = subtree;
+        index.query(q, [&](const search::IndexEntry& e) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.insert(e.dirPath.empty() ? std::string(e.name) : std::string(e.dirPath) + "/" + std::string(e.name));
+            return true;
+        });
+        return result;
+    }
+
+    fs::path base;
+    fs::path root;
+    std::string indexFile;
+};
+
+} // anonymous namespace
+
+TEST_F(NameIndexTest, ListsEveryEntryWithMetadata)
+{
+    auto index = search::NameIndex::open(indexFile);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->root(), root.string());
+    EXPECT_EQ(index->dirCount(), 6u);   // "", a, a/x, "a b", src, src/search
+    EXPECT_EQ(index->entryCount(), 10u);
+
+    EXPECT_EQ(query(*index, ""), (std::set<std::string>{"a", "a b", "src", "top.txt", "a/Readme.md", "a/x",
+                                                         "a/x/notes.txt", "a b/readme.txt", "src/search",
+                                                         "src/search/NameIndex.cpp"}));
+
+    search::IndexQuery q;
+    q.literal = "notes";
+    int hits = 0;
+    index->query(q, [&](const search::IndexEntry& e) {
+        ++hits;
+        EXPECT_EQ(e.type, search::EntryType::File);
+        EXPECT_EQ(e.size, 5u);
+        EXPECT_EQ(e.dirPath, "a/x");
+        return true;
+    });
+    EXPECT_EQ(hits, 1);
+}
+
+TEST_F(NameIndexTest, LiteralAndSubtreeQueries)
+{
+    auto index = search::NameIndex::open(indexFile);
+    ASSERT_TRUE(index);
+
+    EXPECT_EQ(query(*index, "readme"), (std::set<std::string>{"a b/readme.txt"}));
+    EXPECT_EQ(query(*index, "readme", false), (std::set<std::string>{"a/Readme.md", "a b/readme.txt"}));
+    EXPECT_EQ(query(*index, ".txt", true, "a"), (std::set<std::string>{"a/x/notes.txt"}));
+    EXPECT_EQ(query(*index, "", true, "a b"), (std::set<std::string>{"a b/readme.txt"}));
+    EXPECT_TRUE(query(*index, "", true, "missing").empty());
+
+    EXPECT_EQ(index->findDir("a/x") >= 0, true);
+    EXPECT_EQ(index->findDir("a/y"), -1);
+}
+
+TEST_F(NameIndexTest, DetectsChangedDirectories)
+{
+    auto index = search::NameIndex::open(indexFile);
+    ASSERT_TRUE(index);
+    EXPECT_TRUE(index->changedDirectories().empty());
+
+    // Directory mtimes may have coarse granularity; make the change visible.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::ofstream(root / "a" / "x" / "new.txt") << "";
+    fs::remove_all(root / "src" / "search");
+
+    EXPECT_EQ(index->changedDirectories(), (std::vector<std::string>{"a/x", "src", "src/search"}));
+}
+
+TEST_F(NameIndexTest, LiveIndexAppliesRefreshes)
+{
+    auto index = search::NameIndex::open(indexFile);
+    ASSERT_TRUE(index);
+    search::LiveNameIndex live(index);
+
+    fs::create_directories(root / "a" / "x" / "deep" / "er");
+    std::ofstream(root / "a" / "x" / "deep" / "er" / "found.txt") << "";
+    fs::remove(root / "a" / "x" / "notes.txt");
+    fs::remove_all(root / "src" / "search");
+
+    EXPECT_EQ(live.refreshDirectory("a/x").size(), 3u);   // a/x plus the new deep and deep/er
+    live.refreshDirectory("src");
+
+    EXPECT_EQ(query(live, ".txt"),
+              (std::set<std::string>{"a b/readme.txt", "top.txt", "a/x/deep/er/found.txt"}));
+    EXPECT_TRUE(query(live, "NameIndex").empty());
+    EXPECT_EQ(query(live, "", true, "a/x"), (std::set<std::string>{"a/x/deep", "a/x/deep/er", "a/x/deep/er/found.txt"}));
+
+    std::vector<std::string> dirs = live.directories();
+    std::set<std::string> dirSet(dirs.begin(), dirs.end());
+    EXPECT_EQ(dirSet, (std::set<std::string>{"", "a", "a/x", "a b", "src", "a/x/deep", "a/x/deep/er"}));
+    EXPECT_TRUE(live.hasDirectory("a/x/deep"));
+    EXPECT_FALSE(live.hasDirectory("src/search"));
+
+    // The visitor holds no lock: updates made from it do not wait for it
+    search::IndexQuery q;
+    q.threads = 1;
+    bool updated = false;
+    live.query(q, [&](const search::IndexEntry&) {
+        if (!updated) {
+            live.refreshDirectory("a");
+            updated = true;
+        }
+        return true;
+    });
+    EXPECT_TRUE(updated);
+
+    live.reset(index);
+    EXPECT_EQ(live.overrideCount(), 0u);
+}
+
+TEST(NameIndexOpenTest, RejectsMissingAndMalformedFiles)
+{
+    EXPECT_FALSE(search::NameIndex::open("/nonexistent/index/file"));
+
+    const fs::path bogus = fs::temp_directory_path() / ("bogus_index_" + std::to_string(::getpid()));
+    std::ofstream(bogus) << std::string(200, 'x');
+    EXPECT_FALSE(search::NameIndex::open(bogus.string()));
+    fs::remove(bogus);
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "search/ParallelSort.h"
+
+TEST(ParallelSortTest, MatchesStdSort)
+{
+    std::mt19937 rng(11);
+    for (std::size_t count : {0u, 1u, 1000u, 100000u, 333333u}) {
+        std::vector<int> data(count);
+        for (int& v : data)
+            v = static_cast<int>(rng() % 50000);
+        std::vector<int> expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        for (unsigned threads : {1u, 3u, 8u}) {
+            std::vector<int> sorted = data;
+            search::parallelSort(sorted.begin(), sorted.end(), std::less<int>(), threads);
+            EXPECT_EQ(sorted, expected) << "count = " << count << ", threads = " << threads;
+        }
+    }
+}
+
+TEST(ParallelSortTest, UsesTheComparator)
+{
+    std::vector<std::string> data;
+    for (int i = 0; i < 200000; ++i)
+        data.push_back(std::to_string(i * 7919 % 200000));
+    search::parallelSort(data.begin(), data.end(),
+                         [](const std::string& a, const std::string& b) { return a > b; }, 4);
+    EXPECT_TRUE(std::is_sorted(data.begin(), data.end(), std::greater<std::string>()));
+    EXPECT_EQ(data.front(), "99999");
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "search/ParallelWalker.h"
+#include "search/ThreadControl.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Small tree: 20 directories of 10 files each, one nested level, one symlink
+// to a directory (must be reported but not followed).
+class ParallelWalkerTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        root = fs::temp_directory_path() / ("walker_test_" + std::to_string(::getpid()));
+        fs::remove_all(root);
+        fs::create_directories(root);
+        for (int d = 0; d < 20; ++d) {
+            fs::path dir = root / ("dir" + std::to_string(d));
+            fs::create_directories(dir / "nested");
+            expected.insert(dir.string());
+            expected.insert((dir / "nested").string());
+            for (int f = 0; f < 10; ++f) {
+                fs::path file = dir / ("file" + std::to_string(f) + ".txt");
+                std::ofstream(file) << f;
+                expected.insert(file.string());
+            }
+        }
+        fs::create_directory_symlink(root / "dir0", root / "link");
+        expected.insert((root / "link").string());
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(root);
+    }
+
+    fs::path root;
+    std::set<std::string> expected;
+};
+
+} // anonymous namespace
+
+TEST_F(ParallelWalkerTest, ReportsEveryEntryOnce)
+{
+    for (unsigned threads : {1u, 4u}) {
+        std::mutex mutex;
+        std::multiset<std::string> seen;
+
+        search::WalkOptions options;
+        options.threads = threads;
+        search::ParallelWalker walker(options);
+        ASSERT_TRUE(walker.run(root.string(), [&](const search::WalkEntry& e) {
+            std::lock_guard<std::mutex> lock(mutex);
+            seen.insert(e.path());
+            return search::VisitResult::Continue;
+        }));
+
+        EXPECT_EQ(seen.size(), expected.size()) << "threads = " << threads;
+        EXPECT_EQ(std::set<std::string>(seen.begin(), seen.end()), expected) << "threads = " << threads;
+    }
+}
+
+TEST_F(ParallelWalkerTest, ReportsTypesFromDirent)
+{
+    std::mutex mutex;
+    int files = 0, dirs = 0, links = 0;
+
+    search::ParallelWalker walker;
+    walker.run(root.string(), [&](const search::WalkEntry& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        switch (e.type) {
+            case search::EntryType::File: ++files; break;
+            case search::EntryType::Directory: ++dirs; break;
+            case search::EntryType::Symlink: ++links; break;
+            default: break;
+        }
+        return search::VisitResult::Continue;
+    });
+
+    EXPECT_EQ(files, 200);
+    EXPECT_EQ(dirs, 40);
+    EXPECT_EQ(links, 1);
+}
+
+TEST_F(ParallelWalkerTest, SkipDirectoryPrunesSubtree)
+{
+    std::mutex mutex;
+    std::set<std::string> seen;
+
+    search::WalkOptions options;
+    options.threads = 3;
+    search::ParallelWalker walker(options);
+    walker.run(root.string(), [&](const search::WalkEntry& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.insert(e.path());
+        return e.name == "nested" ? search::VisitResult::SkipDirectory : search::VisitResult::Continue;
+    });
+
+    // The "nested" directories themselves are reported, their contents are not
+    // (they are empty anyway); every other entry is still there.
+    EXPECT_EQ(seen, expected);
+}
+
+TEST_F(ParallelWalkerTest, CancelStopsTheWalk)
+{
+    std::atomic<bool> cancel{false};
+    std::atomic<int> visited{0};
+
+    search::WalkOptions options;
+    options.threads = 2;
+    options.cancel = &cancel;
+    search::ParallelWalker walker(options);
+    walker.run(root.string(), [&](const search::WalkEntry&) {
+        if (++visited == 5)
+            cancel = true;
+        return search::VisitResult::Continue;
+    });
+
+    EXPECT_LT(visited.load(), static_cast<int>(expected.size()));
+}
+
+TEST_F(ParallelWalkerTest, IgnoreFilesPruneTheWalk)
+{
+    std::ofstream(root / ".gitignore") << "nested/\n*.log\n";
+    std::ofstream(root / "dir3" / ".ignore") << "file[0-4].txt\n!file0.txt\n";
+    std::ofstream(root / "dir3" / "run.log") << "x";
+    fs::create_directories(root / ".git" / "objects");
+    fs::create_directories(root / "dir5" / "nested" / "below");
+
+    std::mutex mutex;
+    std::set<std::string> seen;
+
+    search::WalkOptions options;
+    options.threads = 2;
+    options.ignoreFiles = true;
+    search::ParallelWalker walker(options);
+    walker.run(root.string(), [&](const search::WalkEntry& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.insert(e.path());
+        return search::VisitResult::Continue;
+    });
+
+    std::set<std::string> wanted;
+    for (const std::string& path : expected) {
+        const fs::path p(path);
+        if (p.filename() == "nested")
+            continue;
+        if (p.parent_path().filename() == "dir3" && p.filename().string() >= "file1.txt" &&
+            p.filename().string() <= "file4.txt")
+            continue;
+        wanted.insert(path);
+    }
+    wanted.insert((root / ".gitignore").string());
+    wanted.insert((root / "dir3" / ".ignore").string());
+    EXPECT_EQ(seen, wanted);
+}
+
+TEST(ParallelWalkerRootTest, MissingRootFails)
+{
+    search::ParallelWalker walker;
+    EXPECT_FALSE(walker.run("/nonexistent/walker/root", [](const search::WalkEntry&) {
+        return search::VisitResult::Continue;
+    }));
+}
+
+TEST_F(ParallelWalkerTest, StatEntryFollowsLinks)
+{
+    std::ofstream(root / "dir1" / "sized.bin") << std::string(1234, 'x');
+    fs::create_symlink(root / "dir1" / "sized.bin", root / "dir1" / "to_file");
+    fs::create_symlink(root / "missing", root / "dir1" / "dangling");
+
+    std::mutex mutex;
+    std::map<std::string, search::EntryStat> stats;
+    std::set<std::string> failed;
+
+    search::ParallelWalker walker;
+    walker.run((root / "dir1").string(), [&](const search::WalkEntry& e) {
+        search::EntryStat st;
+        const bool ok = search::statEntry(e, search::StatType | search::StatSize | search::StatMtime, st);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ok)
+            stats[std::string(e.name)] = st;
+        else
+            failed.insert(std::string(e.name));
+        return search::VisitResult::Continue;
+    });
+
+    EXPECT_EQ(failed, (std::set<std::string>{"dangling"}));
+    ASSERT_EQ(stats.count("to_file"), 1u);
+    EXPECT_EQ(stats["to_file"].type, search::EntryType::File);
+    EXPECT_EQ(stats["to_file"].size, 1234u);
+    EXPECT_EQ(stats["sized.bin"].mtimeNs, stats["to_file"].mtimeNs);
+    EXPECT_GT(stats["sized.bin"].mtimeNs, 0);
+    EXPECT_EQ(stats["nested"].type, search::EntryType::Directory);
+}
+
+TEST_F(ParallelWalkerTest, PausedWalkResumesWhereItStopped)
+{
+    search::PauseGate gate;
+    gate.pause();
+
+    std::atomic<int> seen{0};
+    search::WalkOptions options;
+    options.threads = 4;
+    options.pause = &gate;
+    search::ParallelWalker walker(options);
+    std::thread walk([&]() {
+        walker.run(root.string(), [&](const search::WalkEntry&) {
+            ++seen;
+            return search::VisitResult::Continue;
+        });
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(seen, 0);
+    gate.resume();
+    walk.join();
+    EXPECT_EQ(seen, static_cast<int>(expected.size()));
+}
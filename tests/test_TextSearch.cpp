@@ -0,0 +1,425 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "search/FileScanner.h"
+#include "search/HexPattern.h"
+#include "search/LiteralMatcher.h"
+#include "search/MultiLiteralMatcher.h"
+#include "search/RegexLiterals.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::size_t naiveFind(const std::string& hay, const std::string& needle, bool caseSensitive)
+{
+    for (std::size_t i = 0; i + needle.size() <= hay.size(); ++i) {
+        bool ok = true;
+        for (std::size_t j = 0; j < needle.size() && ok; ++j) {
+            auto a = static_cast<unsigned char>(hay[i + j]);
+            auto b = static_cast<unsigned char>(needle[j]);
+            ok = caseSensitive ? a == b : search::foldAscii(a) == search::foldAscii(b);
+        }
+        if (ok)
+            return i;
+    }
+    return std::string::npos;
+}
+
+std::size_t matcherFind(const search::ByteMatcher& m, const std::string& hay, std::size_t from = 0)
+{
+    search::Match hit;
+    return m.find(hay.data(), hay.size(), from, hit) ? hit.offset : std::string::npos;
+}
+
+bool scanString(const std::string& data, const search::ByteMatcher& m, search::ScanOptions options,
+                std::size_t pieceSize)
+{
+    search::StreamScanner scanner(m, options);
+    for (std::size_t i = 0; i < data.size(); i += pieceSize) {
+        if (scanner.feed(data.data() + i, std::min(pieceSize, data.size() - i)))
+            return true;
+    }
+    return scanner.finish();
+}
+
+fs::path writeTempFile(const std::string& name, const std::string& content)
+{
+    fs::path p = fs::temp_directory_path() / (name + "_" + std::to_string(::getpid()));
+    std::ofstream(p, std::ios::binary) << content;
+    return p;
+}
+
+} // anonymous namespace
+
+TEST(LiteralMatcherTest, FindsCaseSensitive)
+{
+    search::LiteralMatcher m("needle", true);
+    EXPECT_EQ(matcherFind(m, "haystack with a needle in it"), 16u);
+    EXPECT_EQ(matcherFind(m, "haystack with a Needle in it"), std::string::npos);
+    EXPECT_EQ(matcherFind(m, "needle"), 0u);
+    EXPECT_EQ(matcherFind(m, "needl"), std::string::npos);
+    EXPECT_EQ(matcherFind(m, "needle needle", 1), 7u);
+}
+
+TEST(LiteralMatcherTest, FindsCaseInsensitive)
+{
+    search::LiteralMatcher m("NeEdLe", false);
+    EXPECT_EQ(matcherFind(m, "a long haystack with a NEEDLE in it somewhere"), 23u);
+    EXPECT_EQ(matcherFind(m, "needle"), 0u);
+    EXPECT_EQ(matcherFind(m, "nee-dle"), std::string::npos);
+}
+
+TEST(LiteralMatcherTest, SupportsOnlyAsciiFolding)
+{
+    EXPECT_TRUE(search::LiteralMatcher::supports("zażółć", true));
+    EXPECT_FALSE(search::LiteralMatcher::supports("zażółć", false));
+    EXPECT_TRUE(search::LiteralMatcher::supports("plain", false));
+}
+
+TEST(LiteralMatcherTest, AgreesWithNaiveSearchOnRandomData)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> small('a', 'd');
+    std::uniform_int_distribution<int> lenDist(1, 20);
+
+    for (int round = 0; round < 2000; ++round) {
+        std::string hay(static_cast<std::size_t>(rng() % 200), '\0');
+        for (char& c : hay)
+            c = static_cast<char>(rng() % 3 == 0 ? small(rng) - 32 : small(rng));
+        std::string needle(static_cast<std::size_t>(lenDist(rng)), '\0');
+        for (char& c : needle)
+            c = static_cast<char>(small(rng));
+
+        for (bool cs : {true, false}) {
+            search::LiteralMatcher m(needle, cs);
+            ASSERT_EQ(matcherFind(m, hay), naiveFind(hay, needle, cs))
+                    << "needle=" << needle << " hay=" << hay << " cs=" << cs;
+        }
+    }
+}
+
+TEST(MultiLiteralMatcherTest, ReportsWhichTermMatched)
+{
+    search::MultiLiteralMatcher m({"deprecated_api", "SECRET_KEY", "example.com"}, false);
+    search::Match hit;
+    std::string text = "connect to api.EXAMPLE.com with secret_key";
+    ASSERT_TRUE(m.find(text.data(), text.size(), 0, hit));
+    EXPECT_EQ(hit.offset, 15u);
+    EXPECT_EQ(hit.pattern, 2);
+    ASSERT_TRUE(m.find(text.data(), text.size(), hit.offset + 1, hit));
+    EXPECT_EQ(hit.pattern, 1);
+    EXPECT_FALSE(m.find(text.data(), text.size(), hit.offset + 1, hit));
+}
+
+TEST(MultiLiteralMatcherTest, PrefersLeftmostThenLongest)
+{
+    search::MultiLiteralMatcher m({"bcd", "abcdef", "abc", "cd"}, true);
+    search::Match hit;
+    std::string text = "xxabcdxx abcdefx";
+    ASSERT_TRUE(m.find(text.data(), text.size(), 0, hit));
+    EXPECT_EQ(hit.offset, 2u);
+    EXPECT_EQ(hit.length, 3u);
+    ASSERT_TRUE(m.find(text.data(), text.size(), 4, hit));
+    EXPECT_EQ(hit.offset, 4u);   // "cd"
+    ASSERT_TRUE(m.find(text.data(), text.size(), 7, hit));
+    EXPECT_EQ(hit.offset, 9u);
+    EXPECT_EQ(hit.pattern, 1);
+}
+
+TEST(MultiLiteralMatcherTest, AgreesWithNaiveSearchOnRandomData)
+{
+    std::mt19937 rng(7);
+    for (int round = 0; round < 1000; ++round) {
+        std::vector<std::string> terms(1 + rng() % 8);
+        for (std::string& t : terms) {
+            t.resize(1 + rng() % 5);
+            for (char& c : t)
+                c = static_cast<char>('a' + rng() % 3);
+        }
+        std::string hay(static_cast<std::size_t>(rng() % 100), '\0');
+        for (char& c : hay)
+            c = static_cast<char>((rng() % 2 ? 'a' : 'A') + rng() % 4);
+
+        for (bool cs : {true, false}) {
+            // Expected: smallest offset, then longest term at that offset
+            std::size_t bestOffset = std::string::npos, bestLength = 0;
+            for (const std::string& t : terms) {
+                const std::size_t at = naiveFind(hay, t, cs);
+                if (at < bestOffset || (at == bestOffset && at != std::string::npos && t.size() > bestLength)) {
+                    bestOffset = at;
+                    bestLength = t.size();
+                }
+                // A longer term may start at bestOffset even if it also occurs earlier elsewhere
+            }
+            for (const std::string& t : terms) {
+                if (bestOffset != std::string::npos && t.size() > bestLength &&
+                    naiveFind(hay.substr(bestOffset, t.size()), t, cs) == 0)
+                    bestLength = t.size();
+            }
+
+            search::MultiLiteralMatcher m(terms, cs);
+            search::Match hit;
+            const bool found = m.find(hay.data(), hay.size(), 0, hit);
+            ASSERT_EQ(found, bestOffset != std::string::npos) << "hay=" << hay;
+            if (found) {
+                ASSERT_EQ(hit.offset, bestOffset) << "hay=" << hay << " cs=" << cs;
+                ASSERT_EQ(hit.length, bestLength) << "hay=" << hay << " cs=" << cs;
+                ASSERT_EQ(naiveFind(hay.substr(hit.offset, hit.length), terms[hit.pattern], cs), 0u);
+            }
+        }
+    }
+}
+
+TEST(StreamScannerTest, FindsMatchAcrossPieces)
+{
+    std::string data(10000, 'x');
+    data.replace(4095, 6, "needle");
+    search::LiteralMatcher m("needle", true);
+    search::ScanOptions options;
+    options.bufferSize = 64;
+
+    for (std::size_t piece : {1u, 7u, 64u, 100u, 4096u}) {
+        search::StreamScanner scanner(m, options);
+        for (std::size_t i = 0; i < data.size() && !scanner.found(); i += piece)
+            scanner.feed(data.data() + i, std::min(piece, data.size() - i));
+        scanner.finish();
+        ASSERT_TRUE(scanner.found()) << "piece=" << piece;
+        EXPECT_EQ(scanner.match().offset, 4095u) << "piece=" << piece;
+    }
+}
+
+TEST(StreamScannerTest, WholeWordsFollowRegexBoundaries)
+{
+    search::LiteralMatcher m("foo", false);
+    search::ScanOptions options;
+    options.wholeWords = true;
+    options.bufferSize = 4;
+
+    for (std::size_t piece : {1u, 3u, 1000u}) {
+        EXPECT_TRUE(scanString("foo", m, options, piece));
+        EXPECT_TRUE(scanString("a (Foo) b", m, options, piece));
+        EXPECT_FALSE(scanString("foobar", m, options, piece));
+        EXPECT_FALSE(scanString("barfoo", m, options, piece));
+        EXPECT_FALSE(scanString("foo_", m, options, piece));
+        EXPECT_TRUE(scanString("foofoo foo", m, options, piece));
+    }
+
+    // As with \b, a needle starting with a non-word character needs a word
+    // character in front of it.
+    search::LiteralMatcher dash("-x", true);
+    EXPECT_TRUE(scanString("a-x", dash, options, 1));
+    EXPECT_FALSE(scanString(" -x", dash, options, 1));
+}
+
+TEST(FileScannerTest, ScansFiles)
+{
+    std::string content(3 * 1024 * 1024, 'a');
+    content.replace(1024 * 1024 - 2, 5, "MATCH");
+    fs::path p = writeTempFile("scanner_large", content);
+
+    search::LiteralMatcher m("match", false);
+    search::StreamMatch hit;
+    EXPECT_EQ(search::scanFile(p.string(), m, {}, &hit), search::ScanStatus::Found);
+    EXPECT_EQ(hit.offset, 1024u * 1024u - 2);
+
+    search::LiteralMatcher missing("absent", true);
+    EXPECT_EQ(search::scanFile(p.string(), missing, {}), search::ScanStatus::NotFound);
+    fs::remove(p);
+
+    EXPECT_EQ(search::scanFile("/nonexistent/scanner/file", m, {}), search::ScanStatus::Failed);
+}
+
+TEST(FileScannerTest, ReportsWideEncodings)
+{
+    fs::path p = writeTempFile("scanner_utf16", std::string("\xFF\xFEh\0i\0", 6));
+    search::LiteralMatcher m("hi", true);
+    EXPECT_EQ(search::scanFile(p.string(), m, {}), search::ScanStatus::NeedsDecoding);
+    fs::remove(p);
+}
+
+TEST(FileScannerTest, StopsWhenCancelled)
+{
+    fs::path p = writeTempFile("scanner_cancel", "some text with a match");
+    std::atomic<bool> cancel{true};
+    search::ScanOptions options;
+    options.cancel = &cancel;
+    search::LiteralMatcher m("match", true);
+    EXPECT_EQ(search::scanFile(p.string(), m, options), search::ScanStatus::NotFound);
+    fs::remove(p);
+}
+
+TEST(HexPatternTest, ParsesBytesAndWildcards)
+{
+    EXPECT_EQ(search::HexPatternMatcher::parse("7F 45 4c 46"), (std::vector<int>{0x7F, 0x45, 0x4C, 0x46}));
+    EXPECT_EQ(search::HexPatternMatcher::parse("7f??01"), (std::vector<int>{0x7F, -1, 0x01}));
+    EXPECT_FALSE(search::HexPatternMatcher::isValid("7F 4"));     // odd digit count
+    EXPECT_FALSE(search::HexPatternMatcher::isValid("7G"));
+    EXPECT_FALSE(search::HexPatternMatcher::isValid("?? ??"));    // nothing fixed
+    EXPECT_FALSE(search::HexPatternMatcher::isValid(""));
+}
+
+TEST(HexPatternTest, FindsPatternsWithWildcards)
+{
+    std::string data(5000, '\0');
+    data.replace(3000, 6, std::string("\x7F" "ELF\x02\x01", 6));
+    data.replace(100, 4, "\xDE\xAD\xBE\xEF");
+
+    search::HexPatternMatcher elf({"7F 45 4C 46 ?? 01"});
+    EXPECT_EQ(matcherFind(elf, data), 3000u);
+    EXPECT_EQ(matcherFind(elf, data, 3001), std::string::npos);
+
+    // Leading and trailing wildcards, and the leftmost of several patterns
+    search::HexPatternMatcher both({"?? 45 4C ?? ??", "AD BE"});
+    search::Match hit;
+    ASSERT_TRUE(both.find(data.data(), data.size(), 0, hit));
+    EXPECT_EQ(hit.offset, 101u);
+    EXPECT_EQ(hit.pattern, 1);
+    ASSERT_TRUE(both.find(data.data(), data.size(), 102, hit));
+    EXPECT_EQ(hit.offset, 3000u);
+    EXPECT_EQ(hit.length, 5u);
+    EXPECT_EQ(hit.pattern, 0);
+
+    // A wildcard may not run past the end of the data
+    search::HexPatternMatcher tail({"EF ?? ??"});
+    EXPECT_EQ(matcherFind(tail, std::string("\x00\xEF\x00", 3)), std::string::npos);
+
+    // Across stream pieces
+    search::ScanOptions options;
+    options.bufferSize = 16;
+    for (std::size_t piece : {1u, 5u, 4096u})
+        EXPECT_TRUE(scanString(data, elf, options, piece)) << "piece=" << piece;
+}
+
+TEST(HexPatternTest, RawScansIgnoreByteOrderMarks)
+{
+    fs::path p = writeTempFile("scanner_hex_bom", std::string("\xFF\xFEh\0i\0", 6));
+    search::HexPatternMatcher m({"68 00 69"});
+    search::ScanOptions options;
+    options.rawBytes = true;
+    search::StreamMatch hit;
+    EXPECT_EQ(search::scanFile(p.string(), m, options, &hit), search::ScanStatus::Found);
+    EXPECT_EQ(hit.offset, 2u);
+    fs::remove(p);
+}
+
+TEST(ZeroFillTest, AllZeroChecksEveryByte)
+{
+    std::vector<char> buf(1000, 0);
+    EXPECT_TRUE(search::allZero(buf.data(), buf.size()));
+    EXPECT_TRUE(search::allZero(buf.data(), 0));
+    for (std::size_t pos : {0u, 63u, 64u, 500u, 999u}) {
+        buf[pos] = 1;
+        EXPECT_FALSE(search::allZero(buf.data(), buf.size())) << pos;
+        EXPECT_TRUE(search::allZero(buf.data() + pos + 1, buf.size() - pos - 1)) << pos;
+        buf[pos] = 0;
+    }
+}
+
+TEST(ZeroFillTest, DetectsZeroFilledFiles)
+{
+    fs::path zeros = writeTempFile("zero_small", std::string(100000, '\0'));
+    EXPECT_TRUE(search::isZeroFilledFile(zeros.string()));
+    std::atomic<bool> cancel{true};
+    EXPECT_FALSE(search::isZeroFilledFile(zeros.string(), &cancel));
+
+    // Parks while paused
+    search::PauseGate gate;
+    gate.pause();
+    std::atomic<bool> checked{false};
+    std::thread checker([&]() {
+        EXPECT_TRUE(search::isZeroFilledFile(zeros.string(), nullptr, &gate));
+        checked = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(checked);
+    gate.resume();
+    checker.join();
+    EXPECT_TRUE(checked);
+    fs::remove(zeros);
+
+    // Smaller than one sample
+    fs::path tiny = writeTempFile("zero_tiny", std::string(10, '\0'));
+    EXPECT_TRUE(search::isZeroFilledFile(tiny.string()));
+    fs::remove(tiny);
+
+    fs::path empty = writeTempFile("zero_empty", "");
+    EXPECT_FALSE(search::isZeroFilledFile(empty.string()));
+    fs::remove(empty);
+
+    EXPECT_FALSE(search::isZeroFilledFile("/nonexistent/zero/file"));
+
+    // Sparse: 64 MiB of holes around one data block
+    fs::path sparse = writeTempFile("zero_sparse", "");
+    fs::resize_file(sparse, 64 * 1024 * 1024);
+    EXPECT_TRUE(search::isZeroFilledFile(sparse.string()));
+    {
+        std::fstream f(sparse, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(40 * 1024 * 1024 + 12345);
+        f.put('x');
+    }
+    EXPECT_FALSE(search::isZeroFilledFile(sparse.string()));
+    {
+        std::fstream f(sparse, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(40 * 1024 * 1024 + 12345);
+        f.put('\0');
+    }
+    EXPECT_TRUE(search::isZeroFilledFile(sparse.string()));
+    fs::remove(sparse);
+}
+
+TEST(RegexLiteralsTest, ExtractsRequiredFragments)
+{
+    using V = std::vector<std::string>;
+    EXPECT_EQ(search::requiredLiterals("hello"), V{"hello"});
+    EXPECT_EQ(search::requiredLiterals("foo\\d+barbaz"), V{"barbaz"});
+    EXPECT_EQ(search::requiredLiterals("colou?r"), V{"colo"});
+    EXPECT_EQ(search::requiredLiterals("ab+cd"), V{"ab"});
+    EXPECT_EQ(search::requiredLiterals("error|warning"), (V{"error", "warning"}));
+    EXPECT_EQ(search::requiredLiterals("x(?:alpha|beta)y"), (V{"alpha", "beta"}));
+    EXPECT_EQ(search::requiredLiterals("(alpha|beta)?gamma"), V{"gamma"});
+    EXPECT_EQ(search::requiredLiterals("\\Qa.b\\E"), V{"a.b"});
+    EXPECT_EQ(search::requiredLiterals("api\\.example\\.com"), V{"api.example.com"});
+    EXPECT_EQ(search::requiredLiterals("[abc]+key=\\w+"), V{"key="});
+    EXPECT_EQ(search::requiredLiterals("x{2,}yz"), V{"yz"});
+}
+
+TEST(RegexLiteralsTest, GivesUpWhenUnsure)
+{
+    EXPECT_TRUE(search::requiredLiterals("\\d+").empty());
+    EXPECT_TRUE(search::requiredLiterals("foo|\\w+").empty());
+    EXPECT_TRUE(search::requiredLiterals("(?i)foo").empty());
+    EXPECT_TRUE(search::requiredLiterals("(?x) f o o").empty());
+    EXPECT_TRUE(search::requiredLiterals("(unbalanced").empty());
+    EXPECT_TRUE(search::requiredLiterals("a*").empty());
+}
+
+TEST(StreamScannerTest, LineModeVerifiesCandidateLines)
+{
+    search::LiteralMatcher m("key", true);
+    search::ScanOptions options;
+    options.bufferSize = 8;
+    std::vector<std::string> seen;
+    options.verifyLine = [&seen](const char* line, std::size_t len) {
+        seen.emplace_back(line, len);
+        return std::string(line, len).find("key=") != std::string::npos;
+    };
+
+    const std::string text = "no match here\nmonkey business\r\nthe key is set\nkey=value\nkey=other\n";
+    for (std::size_t piece : {1u, 5u, 1000u}) {
+        seen.clear();
+        search::StreamScanner scanner(m, options);
+        for (std::size_t i = 0; i < text.size() && !scanner.found(); i += piece)
+            scanner.feed(text.data() + i, std::min(piece, text.size() - i));
+        scanner.finish();
+        ASSERT_TRUE(scanner.found()) << "piece=" << piece;
+        EXPECT_EQ(scanner.match().offset, text.find("key=value")) << "piece=" << piece;
+        EXPECT_EQ(seen, (std::vector<std::string>{"monkey business", "the key is set", "key=value"}));
+    }
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "search/ThreadControl.h"
+
+TEST(ThreadControlTest, PauseGateParksWaitersUntilResumed)
+{
+    search::PauseGate gate;
+    gate.wait();   // open: returns at once
+
+    gate.pause();
+    std::atomic<bool> passed{false};
+    std::thread waiter([&]() {
+        gate.wait();
+        passed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(passed);
+
+    gate.resume();
+    waiter.join();
+    EXPECT_TRUE(passed);
+    EXPECT_FALSE(gate.isPaused());
+}
+
+TEST(ThreadControlTest, PriorityAppliesToTheCallingThreadOnly)
+{
+    const int before = ::getpriority(PRIO_PROCESS, 0);
+    int inside = 0;
+    bool applied = false;
+    std::thread worker([&]() {
+        search::ThreadPriority priority;
+        priority.ioClass = search::IoClass::Idle;
+        priority.nice = 19;
+        applied = search::applyToCurrentThread(priority);
+        inside = ::getpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)));
+    });
+    worker.join();
+
+    EXPECT_TRUE(applied);
+    EXPECT_EQ(inside, 19);
+    EXPECT_EQ(::getpriority(PRIO_PROCESS, 0), before);
+    EXPECT_TRUE(search::ThreadPriority().isDefault());
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unistd.h>
+
+#include "search/TopKReport.h"
+
+namespace fs = std::filesystem;
+
+TEST(TopKReportTest, BoundedTopKKeepsBest)
+{
+    search::BoundedTopK<int, std::greater<int>> top(3);
+    for (int v : {5, 1, 9, 3, 7, 2, 8})
+        top.offer(v);
+    EXPECT_EQ(top.size(), 3u);
+    EXPECT_FALSE(top.wants(6));
+    EXPECT_TRUE(top.wants(10));
+
+    search::BoundedTopK<int, std::greater<int>> other(3);
+    other.offer(10);
+    other.offer(4);
+    top.merge(other);
+    EXPECT_EQ(top.take(), (std::vector<int>{10, 9, 8}));
+}
+
+TEST(TopKReportTest, ReportsLargestOldestAndDirectories)
+{
+    const fs::path root = fs::temp_directory_path() / ("topk_test_" + std::to_string(::getpid()));
+    fs::remove_all(root);
+    fs::create_directories(root / "big");
+    fs::create_directories(root / "many" / "deeper");
+
+    auto write = [](const fs::path& path, std::size_t size, int ageDays) {
+        std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+        fs::last_write_time(path, fs::file_time_type::clock::now() - std::chrono::hours(24 * ageDays));
+    };
+    write(root / "big" / "huge", 50000, 1);
+    write(root / "big" / "medium", 20000, 2);
+    for (int i = 0; i < 10; ++i)
+        write(root / "many" / ("f" + std::to_string(i)), 3000, 10 + i);   // 30000 together
+    write(root / "many" / "deeper" / "ancient", 10, 1000);
+    write(root / "top", 100, 0);
+
+    search::TopKOptions options;
+    options.count = 2;
+    std::atomic<std::uint64_t> scanned{0};
+    options.scanned = &scanned;
+    const search::TopKReport report = search::findTopK(root.string(), options);
+
+    EXPECT_EQ(report.files, 14u);
+    EXPECT_EQ(scanned.load(), 14u);
+    EXPECT_EQ(report.bytes, 50000u + 20000u + 30000u + 10u + 100u);
+
+    ASSERT_EQ(report.largestFiles.size(), 2u);
+    EXPECT_EQ(report.largestFiles[0].path, (root / "big" / "huge").string());
+    EXPECT_EQ(report.largestFiles[1].path, (root / "big" / "medium").string());
+
+    ASSERT_EQ(report.oldestFiles.size(), 2u);
+    EXPECT_EQ(report.oldestFiles[0].path, (root / "many" / "deeper" / "ancient").string());
+    EXPECT_EQ(report.oldestFiles[1].path, (root / "many" / "f9").string());
+
+    // Only the files directly inside count for a directory
+    ASSERT_EQ(report.largestDirs.size(), 2u);
+    EXPECT_EQ(report.largestDirs[0].path, (root / "big").string());
+    EXPECT_EQ(report.largestDirs[0].size, 70000u);
+    EXPECT_EQ(report.largestDirs[1].path, (root / "many").string());
+    EXPECT_EQ(report.largestDirs[1].size, 30000u);
+
+    fs::remove_all(root);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <sys/stat.h>
+
+#include "search/NameIndex.h"
+#include "search/TrigramIndex.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class TrigramIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        base = fs::temp_directory_path() / ("trigram_index_test_" + std::to_string(::getpid()));
+        fs::remove_all(base);
+        root = base / "tree";
+        fs::create_directories(root / "src");
+        fs::create_directories(root / "logs");
+        write("src/main.cpp", "int main() { return runApplication(); }\n");
+        write("src/util.cpp", "// Helper functions\nstatic int helper() { return 42; }\n");
+        write("logs/today.log", "ERROR: connection refused\nINFO: retrying\n");
+        write("logs/wide.log", std::string("\xFF\xFE", 2) + std::string("E\0R\0R\0", 6));
+        write("short.txt", "ab");
+
+        const std::string namesFile = (base / "names.idx").string();
+        ASSERT_TRUE(search::NameIndex::build(root.string(), namesFile, 2));
+        names = std::make_shared<search::LiveNameIndex>(search::NameIndex::open(namesFile));
+        contentFile = (base / "content.idx").string();
+        ASSERT_TRUE(search::TrigramIndex::build(*names, contentFile, 2));
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(base);
+    }
+
+    void write(const std::string& relPath, const std::string& content)
+    {
+        std::ofstream(root / relPath, std::ios::binary) << content;
+    }
+
+    // Files of the tree the filter does not rule out
+    std::set<std::string> candidates(const search::TrigramFilter& filter) const
+    {
+        std::set<std::string> result;
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            if (!entry.is_regular_file())
+                continue;
+            struct stat st;
+            EXPECT_EQ(::stat(entry.path().c_str(), &st), 0);
+            const std::string rel = fs::relative(entry.path(), root).string();
+            if (filter.mayContain(rel, st))
+                result.insert(rel);
+        }
+        return result;
+    }
+
+    fs::path base;
+    fs::path root;
+    std::shared_ptr<search::LiveNameIndex> names;
+    std::string contentFile;
+};
+
+} // anonymous namespace
+
+TEST_F(TrigramIndexTest, NarrowsCandidatesToFilesWithAllTrigrams)
+{
+    auto index = search::TrigramIndex::open(contentFile);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->root(), root.string());
+    EXPECT_EQ(index->fileCount(), 5u);
+    ASSERT_GE(index->findFile("logs/wide.log"), 0);
+    EXPECT_FALSE(index->fileIndexed(static_cast<std::uint32_t>(index->findFile("logs/wide.log"))));
+    EXPECT_EQ(index->findFile("src"), -1);
+
+    search::LiveTrigramIndex live(index);
+
+    // UTF-16 files are never ruled out: their matches are found decoded
+    auto filter = live.filter({"helper"});
+    ASSERT_TRUE(filter);
+    EXPECT_EQ(candidates(*filter), (std::set<std::string>{"src/util.cpp", "logs/wide.log"}));
+
+    // ASCII case folding: a superset for case-sensitive searches too
+    filter = live.filter({"RunApplication", "connection"});
+    ASSERT_TRUE(filter);
+    EXPECT_EQ(candidates(*filter), (std::set<std::string>{"src/main.cpp", "logs/today.log", "logs/wide.log"}));
+
+    filter = live.filter({"no such text"});
+    ASSERT_TRUE(filter);
+    EXPECT_EQ(candidates(*filter), (std::set<std::string>{"logs/wide.log"}));
+
+    // Too short to narrow anything
+    EXPECT_FALSE(live.filter({"helper", "ab"}));
+    EXPECT_FALSE(live.filter({}));
+}
+
+TEST_F(TrigramIndexTest, ChangedFilesAreCandidatesUntilRefreshed)
+{
+    auto index = search::TrigramIndex::open(contentFile);
+    ASSERT_TRUE(index);
+    search::LiveTrigramIndex live(index);
+    EXPECT_TRUE(live.staleFiles(*names).empty());
+
+    // Timestamps may have coarse granularity; make the change visible.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write("src/main.cpp", "int main() { return 0; }\n");
+    write("src/new.cpp", "void helper2();\n");
+    names->refreshDirectory("src");
+
+    EXPECT_EQ(live.staleFiles(*names), (std::vector<std::string>{"src/main.cpp", "src/new.cpp"}));
+    auto filter = live.filter({"runApplication"});
+    EXPECT_EQ(candidates(*filter), (std::set<std::string>{"src/main.cpp", "src/new.cpp", "logs/wide.log"}));
+
+    live.refreshFiles({"src/main.cpp", "src/new.cpp", "src/gone.cpp"});
+    EXPECT_EQ(live.overrideCount(), 2u);
+    EXPECT_TRUE(live.staleFiles(*names).empty());
+
+    filter = live.filter({"runApplication"});
+    EXPECT_EQ(candidates(*filter), (std::set<std::string>{"logs/wide.log"}));
+    filter = live.filter({"HELPER"});
+    EXPECT_EQ(candidates(*filter), (std::set<std::string>{"src/util.cpp", "src/new.cpp", "logs/wide.log"}));
+
+    live.reset(index);
+    EXPECT_EQ(live.overrideCount(), 0u);
+}
+
+TEST(TrigramIndexOpenTest, RejectsMissingAndMalformedFiles)
+{
+    EXPECT_FALSE(search::TrigramIndex::open("/nonexistent/index/file"));
+
+    const fs::path bogus = fs::temp_directory_path() / ("bogus_trigram_index_" + std::to_string(::getpid()));
+    std::ofstream(bogus) << std::string(200, 'x');
+    EXPECT_FALSE(search::TrigramIndex::open(bogus.string()));
+    fs::remove(bogus);
+}